@@ -0,0 +1,112 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "perf_counters.h"
+
+// 計算結果が使われないことによる最適化での処理の削除を防ぐ
+template <typename T>
+inline void do_not_optimize(const T &value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T *sink;
+    sink = &value;
+#endif
+}
+
+// 1 つの計測項目の結果
+struct BenchmarkResult
+{
+    std::string name;
+    long long iterations;    // 1 回の計測あたりの反復回数
+    double ns_per_op;        // 1 回の処理あたりの時間（計測を繰り返したうちの中央値）
+    double items_per_second; // 1 秒あたりに処理したレイ・サンプルなどの数
+    std::string unit;        // items_per_second の単位（rays など）
+    PerfCounterValues counters_per_item; // レイなど 1 個あたりのハードウェアカウンタの値（使えない場合は 0）
+};
+
+// 外部のライブラリに依存しない簡易的なマイクロベンチマーク
+// 計測時間が min_time 秒以上になるよう反復回数を決めてから repetitions 回計測し，中央値を結果とする
+class BenchmarkHarness
+{
+private:
+    double min_time;
+    int repetitions;
+    std::string filter; // 名前にこの文字列を含む項目のみ計測する（空の場合は全て）
+    std::vector<BenchmarkResult> results;
+    PerfCounters counters;
+
+    template <typename Function>
+    static double measure(Function &function, const long long iterations)
+    {
+        const auto begin = std::chrono::steady_clock::now();
+        for (long long i = 0; i < iterations; i++)
+            function(i);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    }
+
+public:
+    static constexpr double DEFAULT_MIN_TIME{0.2};
+    static constexpr int DEFAULT_REPETITIONS{5};
+
+    // コンストラクタ
+    BenchmarkHarness(const std::string &_filter = "", const double _min_time = DEFAULT_MIN_TIME, const int _repetitions = DEFAULT_REPETITIONS)
+        : min_time(_min_time), repetitions(std::max(_repetitions, 1)), filter(_filter)
+    {
+        if (counters.is_available())
+            std::printf("%-40s %12s %14s %16s %8s %16s %16s %8s\n", "benchmark", "iterations", "ns/op", "throughput", "IPC", "cache-miss/item", "branch-miss/item", "running");
+        else
+        {
+            std::printf("hardware counters : unavailable (%s)\n", counters.get_error().c_str());
+            std::printf("%-40s %12s %14s %16s\n", "benchmark", "iterations", "ns/op", "throughput");
+        }
+    }
+
+    // ゲッター
+    const std::vector<BenchmarkResult> &get_results() const { return results; }
+
+    // function(i) を i = 0, 1, ... と繰り返し呼び出して 1 回あたりの時間を計測する
+    // items_per_op は 1 回の呼び出しで処理するレイなどの数，unit はその単位
+    template <typename Function>
+    void run(const std::string &name, Function &&function, const double items_per_op = 1.0, const std::string &unit = "ops")
+    {
+        if (!filter.empty() && name.find(filter) == std::string::npos)
+            return;
+
+        // 反復回数を倍にしながら，計測時間が min_time の 1 割を超えるまで試す（キャッシュなどのウォームアップを兼ねる）
+        long long iterations = 1;
+        double seconds = measure(function, iterations);
+        while (seconds < min_time / 10 && iterations < (1LL << 40))
+        {
+            iterations *= 2;
+            seconds = measure(function, iterations);
+        }
+        iterations = std::max(1LL, static_cast<long long>(iterations * min_time / std::max(seconds, 1e-9)));
+
+        // ハードウェアカウンタは全ての繰り返しの合計から 1 個あたりの値を求める
+        std::vector<double> ns_per_op;
+        counters.start();
+        for (int r = 0; r < repetitions; r++)
+            ns_per_op.push_back(measure(function, iterations) * 1e9 / iterations);
+        const PerfCounterValues total = counters.stop();
+        std::nth_element(ns_per_op.begin(), ns_per_op.begin() + repetitions / 2, ns_per_op.end());
+        const double median = ns_per_op[repetitions / 2];
+
+        BenchmarkResult result{name, iterations, median, items_per_op * 1e9 / median, unit, total / (items_per_op * iterations * repetitions)};
+        std::printf("%-40s %12lld %14.2f %10.3f M%s/s", result.name.c_str(), result.iterations, result.ns_per_op, result.items_per_second * 1e-6, result.unit.c_str());
+        if (counters.is_available())
+            std::printf(" %8.2f %16.4f %16.4f %7.1f%%", result.counters_per_item.get_ipc(), result.counters_per_item.cache_misses, result.counters_per_item.branch_misses,
+                        result.counters_per_item.get_running_ratio() * 100);
+        std::printf("\n");
+        std::fflush(stdout);
+        results.push_back(result);
+    }
+};
+
+#endif
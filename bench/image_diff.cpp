@@ -0,0 +1,36 @@
+#include <cstdlib>
+#include <iostream>
+#define STB_IMAGE_IMPLEMENTATION
+#include "../header/image.h"
+
+// 2 枚の PNG 画像の差を出力する
+// 倍精度と単精度（-DRAYTRACING_SINGLE_PRECISION）でビルドした各章のプログラムの出力や，変更の前後の出力を比較し，見た目が同等であることを確認するのに用いる
+// PSNR が閾値（既定値 35 dB）を下回る場合は終了コード 1 を返す
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "usage : " << argv[0] << " <reference.png> <target.png> [min_psnr]" << std::endl;
+        return 2;
+    }
+    const double min_psnr = argc > 3 ? std::atof(argv[3]) : 35.0;
+
+    // 保存時の値（[0, 255] を [0, 1] に戻したもの）のまま比較する
+    stbi_ldr_to_hdr_gamma(1.0f);
+    const Image reference(argv[1]);
+    const Image target(argv[2]);
+
+    try
+    {
+        const ImageDifference difference = reference.compare(target);
+        std::cout << "mean absolute error : " << difference.mean_absolute_error << "\n"
+                  << "max absolute error  : " << difference.max_absolute_error << "\n"
+                  << "PSNR                : " << difference.psnr << " [dB]" << std::endl;
+        return difference.psnr >= min_psnr ? 0 : 1;
+    }
+    catch (const Image::size_mismatch_exception &e)
+    {
+        std::cerr << e.get_msg() << std::endl;
+        return 2;
+    }
+}
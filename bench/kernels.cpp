@@ -0,0 +1,145 @@
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../header/aggregate.h"
+#include "../header/camera.h"
+#include "../header/image.h"
+#include "../header/material.h"
+#include "../header/random.h"
+#include "../header/sampler.h"
+#include "../header/sphere.h"
+#include "harness.h"
+
+namespace
+{
+    // 計測に用いるレイ・ベクトルの数（2 のべき乗とし，i & (NUM_INPUTS - 1) で巡回する）
+    constexpr int NUM_INPUTS{1024};
+
+    // 半径 1 の球に対して，中心からの距離 offset を通るよう向けたレイ（原点付近から少しずつ方向をずらす）
+    std::vector<Ray> make_sphere_rays(const double offset, Pcg32 &random)
+    {
+        std::vector<Ray> rays;
+        for (int i = 0; i < NUM_INPUTS; i++)
+        {
+            const double jitter = 1e-4 * (random.next_double() - 0.5);
+            rays.emplace_back(Vec3(0, 0, 5), Vec3(offset + jitter, jitter, -5));
+        }
+        return rays;
+    }
+
+    // 一辺 extent の立方体の中に半径 radius の球を num_spheres 個並べる
+    Aggregate make_world(const int num_spheres, Pcg32 &random)
+    {
+        const double extent = 100.0;
+        const double radius = extent * 0.5 / std::cbrt(static_cast<double>(num_spheres));
+        Aggregate world;
+        for (int i = 0; i < num_spheres; i++)
+        {
+            const Vec3 center(extent * (random.next_double() - 0.5), extent * (random.next_double() - 0.5), extent * (random.next_double() - 0.5));
+            world.add(std::make_shared<Sphere>(center, radius * (0.5 + random.next_double())));
+        }
+        world.build();
+        return world;
+    }
+}
+
+// シーンの構成要素ごとの処理時間（ns/op）と処理量（レイ・サンプル数/s）を計測する
+// ホットパスの性能の退行を検出するのに用いる（./a.out [filter] [min_time]）
+int main(int argc, char **argv)
+{
+    const std::string filter = argc > 1 ? argv[1] : "";
+    const double min_time = argc > 2 ? std::atof(argv[2]) : BenchmarkHarness::DEFAULT_MIN_TIME;
+    BenchmarkHarness harness(filter, min_time);
+    Pcg32 random(1);
+
+    // 球との交差判定（交差・交差しない・接する付近）
+    {
+        const Sphere sphere(Vec3(0), 1.0);
+        const struct
+        {
+            const char *name;
+            double offset;
+        } cases[] = {{"Sphere::intersect/hit", 0.0}, {"Sphere::intersect/miss", 2.0}, {"Sphere::intersect/grazing", 1.0 - 1e-9}};
+        for (const auto &c : cases)
+        {
+            const std::vector<Ray> rays = make_sphere_rays(c.offset, random);
+            harness.run(c.name, [&](const long long i)
+                        { do_not_optimize(sphere.intersect(rays[i & (NUM_INPUTS - 1)])); }, 1.0, "rays");
+        }
+    }
+
+    // 物体の集合との交差判定（BVH を構築した状態）
+    for (int num_spheres : {10, 1000, 100000})
+    {
+        const Aggregate world = make_world(num_spheres, random);
+        std::vector<Ray> rays;
+        for (int i = 0; i < NUM_INPUTS; i++)
+        {
+            const Vec3 target(100 * (random.next_double() - 0.5), 100 * (random.next_double() - 0.5), 100 * (random.next_double() - 0.5));
+            const Vec3 origin(0, 0, 150);
+            rays.emplace_back(origin, target - origin);
+        }
+        harness.run("Aggregate::intersect/" + std::to_string(num_spheres), [&](const long long i)
+                    { do_not_optimize(world.intersect(rays[i & (NUM_INPUTS - 1)])); }, 1.0, "rays");
+    }
+
+    // カメラからのレイの生成
+    {
+        const int width = 640, height = 480;
+        const PinholeCamera pinhole(width, height);
+        const ThinLensCamera thin_lens(width, height, Ray(Vec3(13, 2, 3), Vec3(-13, -2, -3)), 0.2, 10.0, M_PI / 9);
+        SampleStream stream(2);
+        for (const auto &[name, camera] : {std::make_pair("PinholeCamera::get_ray", static_cast<const Camera *>(&pinhole)),
+                                           std::make_pair("ThinLensCamera::get_ray", static_cast<const Camera *>(&thin_lens))})
+        {
+            harness.run(name, [&](const long long i)
+                        { do_not_optimize(camera->get_ray(static_cast<int>(i % width), static_cast<int>(i / width % height), stream)); }, 1.0, "rays");
+        }
+    }
+
+    // マテリアルごとの反射・屈折レイのサンプリング
+    {
+        std::vector<Hit> hits;
+        for (int i = 0; i < NUM_INPUTS; i++)
+        {
+            const Vec3 normal = spherical_to_cartesian(M_PI * random.next_double(), 2 * M_PI * random.next_double());
+            hits.emplace_back(1.0, normal, normal, nullptr, i % 2 == 0);
+        }
+        const Ray incident_ray(Vec3(0, 0, -5), Vec3(0.1, 0.2, 1));
+        const Lambertian lambertian(Color(0.5));
+        const Mirror mirror(Color(0.8));
+        const Glass glass(1.5);
+        SampleStream stream(3);
+        for (const auto &[name, material] : {std::make_pair("Lambertian::sample_ray", static_cast<const Material *>(&lambertian)),
+                                             std::make_pair("Mirror::sample_ray", static_cast<const Material *>(&mirror)),
+                                             std::make_pair("Glass::sample_ray", static_cast<const Material *>(&glass))})
+        {
+            harness.run(name, [&](const long long i)
+                        { do_not_optimize(material->sample_ray(incident_ray, hits[i & (NUM_INPUTS - 1)], stream)); }, 1.0, "rays");
+        }
+    }
+
+    // ベクトルの正規化
+    {
+        std::vector<Vec3> vectors;
+        for (int i = 0; i < NUM_INPUTS; i++)
+            vectors.emplace_back(random.next_double() - 0.5, random.next_double() - 0.5, random.next_double() + 0.1);
+        harness.run("Vec3::normalize", [&](const long long i)
+                    { do_not_optimize(vectors[i & (NUM_INPUTS - 1)].normalize()); }, 1.0, "vectors");
+    }
+
+    // PNG 画像の書き出し
+    {
+        const int width = 256, height = 256;
+        Image image(width, height);
+        for (int y = 0; y < height; y++)
+            for (int x = 0; x < width; x++)
+                image.set_pixel(x, y, Color(random.next_double(), double(x) / width, double(y) / height));
+        const char *output_filepath = "kernels_bench.png";
+        harness.run("Image::save_png/256x256", [&](const long long)
+                    { image.save_png(output_filepath); }, width * height, "pixels");
+        std::remove(output_filepath);
+    }
+}
@@ -0,0 +1,70 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "../header/material.h"
+#include "../header/material_variant.h"
+#include "../header/random.h"
+#include "../header/sphere.h"
+#include "../header/util.h"
+
+// 1 バウンスあたりのマテリアル処理（レイのサンプリングと BRDF の取得）にかかる時間を，
+// 仮想関数による呼び出しと MaterialVariant による呼び出しとで比較する
+int main()
+{
+    const int num_spheres = 1024;
+    const int num_bounces = 10000000;
+
+    // 3 種類のマテリアルを持つ球をランダムに並べる
+    Pcg32 scene_random(1);
+    std::vector<std::shared_ptr<Sphere>> spheres;
+    for (int i = 0; i < num_spheres; i++)
+    {
+        std::shared_ptr<Material> material;
+        double choose_mat = scene_random.next_double();
+        if (choose_mat < 0.6)
+            material = std::make_shared<Lambertian>(Color(scene_random.next_double()));
+        else if (choose_mat < 0.8)
+            material = std::make_shared<Mirror>(Color(scene_random.next_double()));
+        else
+            material = std::make_shared<Glass>(1.5);
+        spheres.push_back(std::make_shared<MaterializedSphere>(Vec3(0), 1.0, material));
+    }
+
+    std::vector<Hit> hits;
+    for (int i = 0; i < num_spheres; i++)
+    {
+        Vec3 normal = spherical_to_cartesian(generate_random_in_range(scene_random, 0.0, M_PI), generate_random_in_range(scene_random, 0.0, 2 * M_PI));
+        hits.emplace_back(1.0, normal, normal, spheres[i].get(), scene_random.next_double() < 0.5);
+    }
+    const Ray incident_ray(Vec3(0, 0, -5), Vec3(0.1, 0.2, 1));
+
+    auto measure = [&](const char *name, auto &&bounce)
+    {
+        SampleStream random(2);
+        Color sum(0);
+        const auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < num_bounces; i++)
+        {
+            sum += bounce(hits[i % num_spheres], random);
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        const double ns_per_bounce = seconds * 1e9 / num_bounces;
+        std::cout << name << " : " << ns_per_bounce << " [ns/bounce] (checksum : " << sum << ")" << std::endl;
+        return ns_per_bounce;
+    };
+
+    const double virtual_ns = measure("virtual", [&](const Hit &hit, SampleStream &random)
+                                      {
+                                          const Sphere *sphere = hit.get_sphere();
+                                          Ray ray = sphere->get_material()->sample_ray(incident_ray, hit, random);
+                                          return sphere->get_material()->get_brdf() * ray.get_direction().y; });
+
+    const double variant_ns = measure("variant", [&](const Hit &hit, SampleStream &random)
+                                      {
+                                          const MaterialVariant &material = *hit.get_sphere()->get_material_variant();
+                                          Ray ray = sample_ray(material, incident_ray, hit, random);
+                                          return get_brdf(material) * ray.get_direction().y; });
+
+    std::cout << "speedup : " << virtual_ns / variant_ns << "x" << std::endl;
+}
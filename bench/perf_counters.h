@@ -0,0 +1,322 @@
+#ifndef BENCH_PERF_COUNTERS_H
+#define BENCH_PERF_COUNTERS_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include "../header/stats.h"
+
+// 計測区間内のハードウェアカウンタの値
+struct PerfCounterValues
+{
+    double cycles{0};
+    double instructions{0};
+    double cache_misses{0};  // 最終レベルキャッシュのミス（PERF_COUNT_HW_CACHE_MISSES）
+    double branch_misses{0}; // 分岐予測のミス
+    double time_enabled{0};  // カウンタが有効だった時間 [s]
+    double time_running{0};  // カウンタが実際に数えていた時間 [s]（他のイベントと時分割された場合は time_enabled より短い）
+
+    // 1 サイクルあたりの命令数（IPC）
+    double get_ipc() const { return cycles > 0 ? instructions / cycles : .0; }
+
+    // 有効だった時間のうち実際に数えていた割合（1 未満の場合，各値は時間の比で補正した推定値）
+    double get_running_ratio() const { return time_enabled > 0 ? time_running / time_enabled : .0; }
+
+    // 全ての値を divisor で割る（反復回数・レイの本数あたりの値を求める）
+    PerfCounterValues operator/(const double divisor) const
+    {
+        return PerfCounterValues{cycles / divisor, instructions / divisor, cache_misses / divisor, branch_misses / divisor, time_enabled / divisor, time_running / divisor};
+    }
+};
+
+// 1 つのグループとして開くカウンタの数（サイクル数・命令数・キャッシュミス・分岐予測ミスの順）
+constexpr int NUM_PERF_EVENTS{4};
+
+// グループから読んだ補正前の値（差や合計を求めてから補正する）
+struct PerfCounterReading
+{
+    uint64_t time_enabled{0}; // [ns]
+    uint64_t time_running{0}; // [ns]
+    uint64_t counts[NUM_PERF_EVENTS]{};
+
+    PerfCounterReading operator-(const PerfCounterReading &other) const
+    {
+        PerfCounterReading d;
+        d.time_enabled = time_enabled - other.time_enabled;
+        d.time_running = time_running - other.time_running;
+        for (int i = 0; i < NUM_PERF_EVENTS; i++)
+            d.counts[i] = counts[i] - other.counts[i];
+        return d;
+    }
+
+    PerfCounterReading &operator+=(const PerfCounterReading &other)
+    {
+        time_enabled += other.time_enabled;
+        time_running += other.time_running;
+        for (int i = 0; i < NUM_PERF_EVENTS; i++)
+            counts[i] += other.counts[i];
+        return *this;
+    }
+
+    // 時分割で数えていない時間があった場合は，有効だった時間と実際に数えた時間の比で補正した値を返す
+    PerfCounterValues get_values() const
+    {
+        PerfCounterValues values;
+        values.time_enabled = time_enabled * 1e-9;
+        values.time_running = time_running * 1e-9;
+        if (time_running == 0)
+            return values;
+        const double scale = static_cast<double>(time_enabled) / time_running;
+        values.cycles = counts[0] * scale;
+        values.instructions = counts[1] * scale;
+        values.cache_misses = counts[2] * scale;
+        values.branch_misses = counts[3] * scale;
+        return values;
+    }
+};
+
+inline void close_perf_counter_group(int (&fds)[NUM_PERF_EVENTS])
+{
+#if defined(__linux__)
+    for (int &fd : fds)
+    {
+        if (fd >= 0)
+            close(fd);
+        fd = -1;
+    }
+#endif
+}
+
+// サイクル数を先頭（リーダー）とするグループを，呼び出したスレッドについて開く
+// disabled が true の場合は停止した状態で開き，inherit が true の場合は開いた後に生成したスレッドの分も数える
+// 開けない場合は全て閉じて false を返し，理由を error に格納する
+inline bool open_perf_counter_group(int (&fds)[NUM_PERF_EVENTS], const bool disabled, const bool inherit, std::string &error)
+{
+#if defined(__linux__)
+    const uint64_t configs[NUM_PERF_EVENTS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    for (int i = 0; i < NUM_PERF_EVENTS; i++)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[i];
+        // リーダーのみの有効・無効を指定し，メンバーはリーダーに合わせて有効・無効が切り替わる
+        attr.disabled = i == 0 && disabled ? 1 : 0;
+        attr.inherit = inherit ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fds[0], 0));
+        if (fds[i] < 0)
+        {
+            error = std::string("perf_event_open failed (") + std::strerror(errno) + ")";
+            close_perf_counter_group(fds);
+            return false;
+        }
+    }
+    return true;
+#else
+    error = "perf_event_open is only available on Linux";
+    return false;
+#endif
+}
+
+// グループの全てのカウンタの値を 1 回の read でまとめて読む
+inline bool read_perf_counter_group(const int leader, PerfCounterReading &reading)
+{
+#if defined(__linux__)
+    // イベント数・有効だった時間・実際に数えた時間・各イベントの値（グループ内の順）
+    uint64_t data[3 + NUM_PERF_EVENTS];
+    if (read(leader, data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[0] != NUM_PERF_EVENTS)
+        return false;
+    reading.time_enabled = data[1];
+    reading.time_running = data[2];
+    for (int i = 0; i < NUM_PERF_EVENTS; i++)
+        reading.counts[i] = data[3 + i];
+    return true;
+#else
+    (void)leader;
+    (void)reading;
+    return false;
+#endif
+}
+
+// Linux の perf_event_open によるハードウェアカウンタ（サイクル数・命令数・キャッシュミス・分岐予測ミス）の計測
+// 外部のツールに依存せず，ユーザ空間で実行した分のみを数える
+// 4 つのカウンタはサイクル数を先頭（リーダー）とする 1 つのグループとして開き，同時に有効・無効を切り替えて 1 回の read でまとめて読む
+// グループは常に同時にスケジュールされるため，時分割されても IPC などの比は同じ区間の値から求まる
+// 仮想マシン・コンテナの中や perf_event_paranoid の設定などで使えない場合は is_available() が false となり，計測値は 0 となる
+// inherit を有効にしているため，start の後に生成したスレッド（Renderer のワーカー）の分も終了時に合計される
+// （inherit と PERF_FORMAT_GROUP の組み合わせに対応していない古いカーネルでは開けずに使えない扱いとなる）
+class PerfCounters
+{
+private:
+    int fds[NUM_PERF_EVENTS]{-1, -1, -1, -1}; // fds[0] がグループのリーダー
+    std::string error;                        // 使えない理由
+
+    void close_all() { close_perf_counter_group(fds); }
+
+public:
+    // コンストラクタ（カウンタを停止した状態で開く）
+    PerfCounters() { open_perf_counter_group(fds, true, true, error); }
+
+    ~PerfCounters() { close_all(); }
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    // ゲッター
+    bool is_available() const { return fds[0] >= 0; }
+    const std::string &get_error() const { return error; }
+
+    // 0 に戻してから計測を開始する
+    void start()
+    {
+#if defined(__linux__)
+        if (!is_available())
+            return;
+        ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    // 計測を停止し，start からの値を返す（使えない場合は全て 0）
+    // 時分割で数えていない時間があった場合は，有効だった時間と実際に数えた時間の比で補正する
+    PerfCounterValues stop()
+    {
+        PerfCounterValues values;
+#if defined(__linux__)
+        if (!is_available())
+            return values;
+        ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        PerfCounterReading reading;
+        if (read_perf_counter_group(fds[0], reading))
+            values = reading.get_values();
+#endif
+        return values;
+    }
+};
+
+// 交差判定（Aggregate::intersect）とシェーディングの区間ごとのハードウェアカウンタの計測
+// -DRAYTRACING_STATS_PHASES を付けてビルドした描画の区間の開始・終了の通知を受け取り，区間内で数えた値をスレッドごとに合計する
+// 各スレッドは初めて区間に入った時に，そのスレッドのみを数えるグループを開く（inherit を用いないため，区間ごとに読める）
+// 区間の開始時と終了時に read を呼び出すため描画は遅くなる．カーネル内の分は数えないため各区間の値への影響は小さいが，
+// 経過時間を計測する描画とは別の描画で用いる
+class PhasePerfCounters
+{
+private:
+    // スレッドごとのグループと区間ごとの合計
+    struct ThreadCounters
+    {
+        int fds[NUM_PERF_EVENTS]{-1, -1, -1, -1};
+        PerfCounterReading begin;
+        PerfCounterReading totals[NUM_STATS_PHASES];
+
+        ThreadCounters()
+        {
+            std::string error;
+            open_perf_counter_group(fds, false, false, error);
+            PhasePerfCounters::get().add(this);
+        }
+        ~ThreadCounters()
+        {
+            PhasePerfCounters::get().remove(this);
+            close_perf_counter_group(fds);
+        }
+    };
+
+    std::mutex mutex;
+    std::vector<ThreadCounters *> live;
+    PerfCounterReading retired[NUM_STATS_PHASES]; // 終了したスレッドの合計
+
+    PhasePerfCounters() {}
+
+    void add(ThreadCounters *counters)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        live.push_back(counters);
+    }
+
+    void remove(ThreadCounters *counters)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int phase = 0; phase < NUM_STATS_PHASES; phase++)
+            retired[phase] += counters->totals[phase];
+        live.erase(std::find(live.begin(), live.end(), counters));
+    }
+
+    static ThreadCounters &get_thread_counters()
+    {
+        thread_local ThreadCounters counters;
+        return counters;
+    }
+
+    static void begin_phase(const StatsPhase)
+    {
+        ThreadCounters &counters = get_thread_counters();
+        if (counters.fds[0] >= 0)
+            read_perf_counter_group(counters.fds[0], counters.begin);
+    }
+
+    static void end_phase(const StatsPhase phase)
+    {
+        ThreadCounters &counters = get_thread_counters();
+        PerfCounterReading end;
+        if (counters.fds[0] >= 0 && read_perf_counter_group(counters.fds[0], end))
+            counters.totals[static_cast<int>(phase)] += end - counters.begin;
+    }
+
+public:
+    static PhasePerfCounters &get()
+    {
+        static PhasePerfCounters instance;
+        return instance;
+    }
+
+    PhasePerfCounters(const PhasePerfCounters &) = delete;
+    PhasePerfCounters &operator=(const PhasePerfCounters &) = delete;
+
+    // 0 に戻してから区間の通知を受け取り始める（描画を開始する前に呼び出す）
+    void start()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (int phase = 0; phase < NUM_STATS_PHASES; phase++)
+            {
+                retired[phase] = PerfCounterReading();
+                for (ThreadCounters *counters : live)
+                    counters->totals[phase] = PerfCounterReading();
+            }
+        }
+        get_stats_phase_listener() = StatsPhaseListener{begin_phase, end_phase};
+    }
+
+    // 通知の受け取りを止め，start からの区間ごとの値（StatsPhase の順）を返す（描画が終了した後に呼び出す）
+    std::vector<PerfCounterValues> stop()
+    {
+        get_stats_phase_listener() = StatsPhaseListener();
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<PerfCounterValues> values;
+        for (int phase = 0; phase < NUM_STATS_PHASES; phase++)
+        {
+            PerfCounterReading total = retired[phase];
+            for (ThreadCounters *counters : live)
+                total += counters->totals[phase];
+            values.push_back(total.get_values());
+        }
+        return values;
+    }
+};
+
+#endif
@@ -0,0 +1,64 @@
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include "../header/accumulation_buffer.h"
+#include "../header/aggregate.h"
+#include "../header/camera.h"
+#include "../header/integrator.h"
+#include "../header/material.h"
+#include "../header/progressive.h"
+#include "../header/random.h"
+#include "../header/renderer.h"
+#include "../header/sphere.h"
+
+// 10_last_seen と同じ配置のシーンをプログレッシブに描画し，パスごとの経過時間・サンプル数・相対誤差を出力する
+// 最初のプレビューが得られるまでの時間を確認するのに用いる（./a.out [time_budget] [noise_target] [max_samples]）
+int main(int argc, char **argv)
+{
+    const double time_budget = argc > 1 ? std::atof(argv[1]) : 10.0;
+    const double noise_target = argc > 2 ? std::atof(argv[2]) : 0.0;
+    const int max_samples = argc > 3 ? std::atoi(argv[3]) : 100;
+
+    const int image_width = 640;
+    const int image_height = 480;
+    const Vec3 look_from(13, 2, 3);
+    ThinLensCamera camera(image_width, image_height, Ray(look_from, Vec3(0) - look_from), 0.2, 10.0, M_PI / 9);
+
+    Pcg32 random(1);
+    Aggregate world;
+    world.add(std::make_shared<MaterializedSphere>(Vec3(0, -1000, 0), 1000, std::make_shared<Lambertian>(Color(0.5))));
+    world.add(std::make_shared<MaterializedSphere>(Vec3(0, 1, 0), 1.0, std::make_shared<Glass>(1.5)));
+    world.add(std::make_shared<MaterializedSphere>(Vec3(-4, 1, 0), 1.0, std::make_shared<Lambertian>(Color(0.4, 0.2, 0.1))));
+    world.add(std::make_shared<MaterializedSphere>(Vec3(4, 1, 0), 1.0, std::make_shared<Mirror>(Color(0.7, 0.6, 0.5))));
+    for (int i = -11; i < 11; i++)
+    {
+        for (int j = -11; j < 11; j++)
+        {
+            double choose_mat = random.next_double();
+            Vec3 center(i + 0.9 * random.next_double(), 0.2, j + 0.9 * random.next_double());
+            if ((center - Vec3(4, 0.2, 0)).norm() <= 0.9)
+                continue;
+            std::shared_ptr<Material> material;
+            if (choose_mat < 0.8)
+                material = std::make_shared<Lambertian>(Color(random.next_double(), random.next_double(), random.next_double()));
+            else if (choose_mat < 0.95)
+                material = std::make_shared<Mirror>(Color(0.5 + 0.5 * random.next_double()));
+            else
+                material = std::make_shared<Glass>(1.5);
+            world.add(std::make_shared<MaterializedSphere>(center, 0.2, material));
+        }
+    }
+    world.build();
+
+    PathIntegrator integrator;
+    Renderer renderer;
+    AccumulationBuffer accumulation(image_width, image_height);
+    ProgressiveRenderer progressive(max_samples, time_budget, noise_target);
+    progressive.render(renderer, camera, accumulation, [&](const Ray &r, SampleStream &random)
+                       { return integrator.trace(r, world, random); },
+                       [](const ProgressivePass &pass)
+                       {
+                           std::cout << "pass " << pass.pass << " : " << pass.elapsed_seconds << " [s], "
+                                     << pass.samples_per_pixel << " [spp], relative error " << pass.relative_error << std::endl;
+                       });
+}
@@ -0,0 +1,133 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "../header/aggregate.h"
+#include "../header/camera.h"
+#include "../header/material.h"
+#include "../header/random.h"
+#include "../header/ray_packet.h"
+#include "../header/sphere.h"
+#include "../header/util.h"
+
+// 10_last_seen と同じ配置のシーンで，カメラからのレイと鏡面で 1 回反射したレイの交差判定の速度を，
+// 1 本ずつ判定する場合と 4 / 8 / 16 本のパケットで判定する場合とで比較する
+namespace
+{
+    Aggregate make_scene()
+    {
+        Pcg32 random(1);
+        Aggregate world;
+        world.add(std::make_shared<MaterializedSphere>(Vec3(0, -1000, 0), 1000, std::make_shared<Lambertian>(Color(0.5))));
+        world.add(std::make_shared<MaterializedSphere>(Vec3(0, 1, 0), 1.0, std::make_shared<Glass>(1.5)));
+        world.add(std::make_shared<MaterializedSphere>(Vec3(-4, 1, 0), 1.0, std::make_shared<Lambertian>(Color(0.4, 0.2, 0.1))));
+        world.add(std::make_shared<MaterializedSphere>(Vec3(4, 1, 0), 1.0, std::make_shared<Mirror>(Color(0.7, 0.6, 0.5))));
+        for (int i = -11; i < 11; i++)
+        {
+            for (int j = -11; j < 11; j++)
+            {
+                double choose_mat = random.next_double();
+                Vec3 center(i + 0.9 * random.next_double(), 0.2, j + 0.9 * random.next_double());
+                if ((center - Vec3(4, 0.2, 0)).norm() <= 0.9)
+                    continue;
+                std::shared_ptr<Material> material;
+                if (choose_mat < 0.8)
+                    material = std::make_shared<Lambertian>(Color(random.next_double(), random.next_double(), random.next_double()));
+                else if (choose_mat < 0.95)
+                    material = std::make_shared<Mirror>(Color(0.5 + 0.5 * random.next_double()));
+                else
+                    material = std::make_shared<Glass>(1.5);
+                world.add(std::make_shared<MaterializedSphere>(center, 0.2, material));
+            }
+        }
+        world.build();
+        return world;
+    }
+
+    template <int N>
+    int count_hits_with_packets(const Aggregate &world, const std::vector<Ray> &rays)
+    {
+        RayPacket<N> packet;
+        std::optional<Hit> hits[N];
+        int hit_count = 0;
+        for (size_t i = 0; i < rays.size(); i += N)
+        {
+            packet.clear();
+            for (size_t k = i; k < rays.size() && k < i + N; k++)
+                packet.add(rays[k]);
+            world.intersect(packet, hits);
+            for (int k = 0; k < packet.size; k++)
+                hit_count += hits[k] ? 1 : 0;
+        }
+        return hit_count;
+    }
+}
+
+int main()
+{
+    const int image_width = 640;
+    const int image_height = 480;
+    const int repeat = 5;
+    const int block_size = 4;
+
+    const Aggregate world = make_scene();
+    const Vec3 look_from(13, 2, 3);
+    PinholeCamera camera(image_width, image_height, Ray(look_from, Vec3(0) - look_from), M_PI / 9);
+
+    // 隣接するピクセルのレイがパケットにまとまるよう，4x4 ピクセルのブロックごとに並べる
+    std::vector<Ray> primary_rays;
+    for (int by = 0; by < image_height; by += block_size)
+        for (int bx = 0; bx < image_width; bx += block_size)
+            for (int y = by; y < by + block_size; y++)
+                for (int x = bx; x < bx + block_size; x++)
+                {
+                    SampleStream random = make_sample_stream(x, y, 0);
+                    primary_rays.push_back(camera.get_ray(x, y, random));
+                }
+
+    // 鏡面で反射したレイ
+    std::vector<Ray> mirror_rays;
+    for (const Ray &ray : primary_rays)
+    {
+        std::optional<Hit> hit = world.intersect(ray);
+        if (!hit)
+            continue;
+        const Material *material = hit->get_sphere()->get_material();
+        if (dynamic_cast<const Mirror *>(material))
+        {
+            SampleStream random;
+            mirror_rays.push_back(material->sample_ray(ray, *hit, random));
+        }
+    }
+
+    auto measure = [&](const char *name, const std::vector<Ray> &rays, auto &&count_hits)
+    {
+        int hit_count = 0;
+        const auto begin = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeat; r++)
+            hit_count = count_hits(rays);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        const double mrays_per_second = rays.size() * repeat / seconds * 1e-6;
+        std::cout << "  " << name << " : " << mrays_per_second << " [Mrays/s] (hits : " << hit_count << ")" << std::endl;
+        return mrays_per_second;
+    };
+
+    for (const auto &[label, rays] : {std::make_pair("primary", &primary_rays), std::make_pair("mirror", &mirror_rays)})
+    {
+        std::cout << label << " rays (" << rays->size() << ")" << std::endl;
+        const double single = measure("single   ", *rays, [&](const std::vector<Ray> &rs)
+                                      {
+                                          int hit_count = 0;
+                                          for (const Ray &ray : rs)
+                                              hit_count += world.intersect(ray) ? 1 : 0;
+                                          return hit_count; });
+        const double packet4 = measure("packet  4", *rays, [&](const std::vector<Ray> &rs)
+                                       { return count_hits_with_packets<4>(world, rs); });
+        const double packet8 = measure("packet  8", *rays, [&](const std::vector<Ray> &rs)
+                                       { return count_hits_with_packets<8>(world, rs); });
+        const double packet16 = measure("packet 16", *rays, [&](const std::vector<Ray> &rs)
+                                        { return count_hits_with_packets<16>(world, rs); });
+        std::cout << "  speedup : " << packet4 / single << "x / " << packet8 / single << "x / " << packet16 / single << "x" << std::endl;
+    }
+}
@@ -0,0 +1,481 @@
+// 交差判定とシェーディングの区間ごとにハードウェアカウンタを数えるため，区間の開始・終了の通知を有効にする
+// （通知を受け取る関数を登録していない間は，関数ポインタの確認のみを行う）
+#define RAYTRACING_STATS_PHASES
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <sys/resource.h>
+#include "../header/accumulation_buffer.h"
+#include "../header/adaptive_sampler.h"
+#include "../header/integrator.h"
+#include "../header/renderer.h"
+#include "../header/wavefront.h"
+#include "perf_counters.h"
+#include "scenes.h"
+
+namespace
+{
+    // 描画に用いる浮動小数点型（-DRAYTRACING_SINGLE_PRECISION の有無）
+    constexpr const char *PRECISION_NAME = std::is_same_v<Real, float> ? "float" : "double";
+
+    // コマンドライン引数で変更できる設定
+    struct Options
+    {
+        int width{320};
+        int height{240};
+        int samples_per_pixel{16};
+        uint64_t seed{LAST_SEEN_SEED}; // 10_last_seen の小さな球の配置の乱数のシード（既定は src/10_last_seen.cpp と同じ）
+        int num_threads{0}; // 0 の場合はハードウェアの並列数
+        int repeat{3};      // 計測の回数（中央値を結果とする）
+        std::vector<std::string> scenes{get_benchmark_scene_names()};
+        std::string output{"render_bench.json"};
+        std::string baseline; // 空の場合は比較しない
+        double tolerance{0.1}; // 基準より wall_seconds がこの割合を超えて遅い場合を退行とみなす
+        bool wavefront{false}; // 一定数のサンプルを追跡するシーンを WavefrontIntegrator で描画するか
+        int packet_size{PathIntegrator::DEFAULT_PACKET_SIZE}; // カメラからのレイと鏡面で 1 回反射したレイのパケットの本数（0 の場合は用いない）
+        bool sort_rays{false}; // WavefrontIntegrator で 2 回目以降の交差判定の前にレイを並べ替えるか
+    };
+
+    // 1 つのシーンの計測結果
+    struct SceneResult
+    {
+        std::string name;
+        double build_seconds{.0};
+        double wall_seconds{.0};
+        long long rays{0};
+        long long samples{0};
+        double peak_rss_mb{.0};
+        uint64_t checksum{0};
+        PerfCounterValues counters; // 描画 1 回あたりのハードウェアカウンタの値（使えない場合は 0）
+        PerfCounterValues intersect_counters; // 描画 1 回のうち Aggregate::intersect の区間の値
+        PerfCounterValues shade_counters;     // 描画 1 回のうちシェーディングの区間の値
+    };
+
+    // ピーク時の常駐メモリ量（VmHWM）をリセットする（Linux 4.0 以降で可能．失敗した場合はプロセス開始からのピークとなる）
+    void reset_peak_rss()
+    {
+        std::ofstream clear_refs("/proc/self/clear_refs");
+        if (clear_refs)
+            clear_refs << "5";
+    }
+
+    // ピーク時の常駐メモリ量 [MB]
+    double get_peak_rss_mb()
+    {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line))
+        {
+            if (line.compare(0, 6, "VmHWM:") == 0)
+                return std::atof(line.c_str() + 6) / 1024.0;
+        }
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss / 1024.0;
+    }
+
+    // 画素値のビット列の FNV-1a ハッシュ（同じ設定で描画した画像が一致するかの確認に用いる）
+    uint64_t image_checksum(const Image &image)
+    {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (int y = 0; y < image.get_height(); y++)
+        {
+            for (int x = 0; x < image.get_width(); x++)
+            {
+                const Color c = image.get_pixel(x, y);
+                const Real values[3] = {c.r, c.g, c.b};
+                unsigned char bytes[sizeof(values)];
+                std::memcpy(bytes, values, sizeof(values));
+                for (unsigned char b : bytes)
+                {
+                    hash ^= b;
+                    hash *= 0x100000001b3ull;
+                }
+            }
+        }
+        return hash;
+    }
+
+    // 03 の法線による色
+    Color normal_color(const Ray &r, const Aggregate &world)
+    {
+        std::optional<Hit> result = world.intersect(r);
+        RAYTRACING_STATS_PHASE(Shade);
+        if (result)
+        {
+            const Vec3 n = result->get_hit_normal();
+            return 0.5 * Color(n.x + 1, n.y + 1, n.z + 1);
+        }
+        return PathIntegrator::background(r);
+    }
+
+    // 各章のプログラムと同じ方法でシーンを描画し，サンプル数を返す
+    // num_rays を与えた場合は，追跡したレイの本数を加える
+    // 一定数のサンプルを追跡するシーンは PathIntegrator::render で描画し，カメラからのレイを packet_size 本ずつのパケットで交差判定する
+    // wavefront を与えた場合は，そのシーンを wavefront で描画する（PathIntegrator と同じ画像・レイの本数となる）
+    long long render_scene(BenchmarkScene &scene, Renderer &renderer, const int samples_per_pixel, const int packet_size,
+                           const WavefrontIntegrator *wavefront, std::atomic<long long> *num_rays)
+    {
+        Camera &camera = *scene.camera;
+        const Aggregate &world = scene.world;
+        const long long num_pixels = static_cast<long long>(camera.get_image().get_width()) * camera.get_image().get_height();
+        const PathIntegrator integrator(PathIntegrator::DEFAULT_MAX_DEPTH, PathIntegrator::DEFAULT_RUSSIAN_ROULETTE_DEPTH, MaterialDispatch::Variant, packet_size);
+        auto path_color = [&](const Ray &r, SampleStream &random)
+        {
+            if (!num_rays)
+                return integrator.trace(r, world, random);
+            int n;
+            const Color color = integrator.trace(r, world, random, n);
+            num_rays->fetch_add(n, std::memory_order_relaxed);
+            return color;
+        };
+
+        switch (scene.shading)
+        {
+        case BenchmarkScene::Shading::Normal:
+            renderer.render(camera, samples_per_pixel, [&](const Ray &r, SampleStream &)
+                            {
+                                if (num_rays)
+                                    num_rays->fetch_add(1, std::memory_order_relaxed);
+                                return normal_color(r, world); });
+            return num_pixels * samples_per_pixel;
+        case BenchmarkScene::Shading::Adaptive:
+        {
+            // 05-03 と同じく，最大サンプル数の 1/4 から信頼区間の半幅が平均の 5% 未満となるまで追跡する
+            const AdaptiveSampler sampler(std::max(1, samples_per_pixel / 4), samples_per_pixel, 0.05);
+            AccumulationBuffer accumulation(camera.get_image().get_width(), camera.get_image().get_height());
+            renderer.render(camera, sampler, accumulation, path_color);
+            return accumulation.get_total_samples();
+        }
+        case BenchmarkScene::Shading::Path:
+        default:
+        {
+            const long long n = wavefront ? wavefront->render(renderer, camera, samples_per_pixel, world)
+                                          : integrator.render(renderer, camera, samples_per_pixel, world);
+            if (num_rays)
+                num_rays->fetch_add(n, std::memory_order_relaxed);
+            return num_pixels * samples_per_pixel;
+        }
+        }
+    }
+
+    SceneResult benchmark_scene(const std::string &name, const Options &options, PerfCounters &counters)
+    {
+        SceneResult result;
+        result.name = name;
+        reset_peak_rss();
+
+        auto begin = std::chrono::steady_clock::now();
+        BenchmarkScene scene = make_benchmark_scene(name, options.width, options.height, options.seed);
+        result.build_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        // 予備の描画でレイの本数を数える（キャッシュなどのウォームアップを兼ねる）
+        Renderer renderer(options.num_threads);
+        const WavefrontIntegrator wavefront_integrator(PathIntegrator::DEFAULT_MAX_DEPTH, PathIntegrator::DEFAULT_RUSSIAN_ROULETTE_DEPTH,
+                                                       WavefrontIntegrator::DEFAULT_MAX_PATHS, options.packet_size, options.sort_rays);
+        const WavefrontIntegrator *wavefront = options.wavefront ? &wavefront_integrator : nullptr;
+        std::atomic<long long> num_rays(0);
+        render_scene(scene, renderer, options.samples_per_pixel, options.packet_size, wavefront, &num_rays);
+        result.rays = num_rays.load();
+
+        // ハードウェアカウンタは計測した全ての描画（ワーカーのスレッドを含む）の合計から 1 回あたりの値を求める
+        std::vector<double> seconds;
+        counters.start();
+        for (int r = 0; r < std::max(1, options.repeat); r++)
+        {
+            begin = std::chrono::steady_clock::now();
+            result.samples = render_scene(scene, renderer, options.samples_per_pixel, options.packet_size, wavefront, nullptr);
+            seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+        }
+        result.counters = counters.stop() / static_cast<double>(seconds.size());
+
+        // 区間ごとの値は，区間ごとにカウンタを読むことで遅くなるため経過時間の計測とは別の描画で求める
+        if (counters.is_available())
+        {
+            PhasePerfCounters &phase_counters = PhasePerfCounters::get();
+            phase_counters.start();
+            render_scene(scene, renderer, options.samples_per_pixel, options.packet_size, wavefront, nullptr);
+            const std::vector<PerfCounterValues> phases = phase_counters.stop();
+            result.intersect_counters = phases[static_cast<int>(StatsPhase::Intersect)];
+            result.shade_counters = phases[static_cast<int>(StatsPhase::Shade)];
+        }
+        std::nth_element(seconds.begin(), seconds.begin() + seconds.size() / 2, seconds.end());
+        result.wall_seconds = seconds[seconds.size() / 2];
+        result.checksum = image_checksum(scene.camera->get_image());
+        result.peak_rss_mb = get_peak_rss_mb();
+        return result;
+    }
+
+    std::string to_hex(const uint64_t x)
+    {
+        char buffer[19];
+        std::snprintf(buffer, sizeof(buffer), "0x%016llx", static_cast<unsigned long long>(x));
+        return buffer;
+    }
+
+    // has_counters が true の場合は，ハードウェアカウンタから求めた IPC とレイ 1 本あたりのミスの回数，カウンタが有効だった時間と実際に数えた時間も出力する
+    // 交差判定（intersect_*）とシェーディング（shade_*）の区間ごとのサイクル数・命令数・IPC・レイ 1 本あたりのミスの回数も出力する
+    void write_json(std::ostream &stream, const Options &options, const int num_threads, const std::vector<SceneResult> &results, const bool has_counters)
+    {
+        stream << "{\n"
+               << "  \"width\": " << options.width << ",\n"
+               << "  \"height\": " << options.height << ",\n"
+               << "  \"samples_per_pixel\": " << options.samples_per_pixel << ",\n"
+               << "  \"seed\": " << options.seed << ",\n"
+               << "  \"threads\": " << num_threads << ",\n"
+               << "  \"precision\": \"" << PRECISION_NAME << "\",\n"
+               << "  \"integrator\": \"" << (options.wavefront ? "wavefront" : "path") << "\",\n"
+               << "  \"packet_size\": " << options.packet_size << ",\n"
+               << "  \"sort_rays\": " << (options.wavefront && options.sort_rays ? "true" : "false") << ",\n"
+               << "  \"scenes\": [\n";
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const SceneResult &r = results[i];
+            stream << "    {\"name\": \"" << r.name << "\""
+                   << ", \"build_seconds\": " << r.build_seconds
+                   << ", \"wall_seconds\": " << r.wall_seconds
+                   << ", \"rays\": " << r.rays
+                   << ", \"samples\": " << r.samples
+                   << ", \"mrays_per_second\": " << r.rays / r.wall_seconds * 1e-6
+                   << ", \"samples_per_second\": " << r.samples / r.wall_seconds
+                   << ", \"peak_rss_mb\": " << r.peak_rss_mb;
+            if (has_counters)
+            {
+                const PerfCounterValues per_ray = r.counters / static_cast<double>(std::max(1LL, r.rays));
+                stream << ", \"cycles\": " << r.counters.cycles
+                       << ", \"instructions\": " << r.counters.instructions
+                       << ", \"ipc\": " << r.counters.get_ipc()
+                       << ", \"cache_misses_per_ray\": " << per_ray.cache_misses
+                       << ", \"branch_misses_per_ray\": " << per_ray.branch_misses
+                       << ", \"counter_time_enabled\": " << r.counters.time_enabled
+                       << ", \"counter_time_running\": " << r.counters.time_running;
+                const auto write_phase = [&](const char *prefix, const PerfCounterValues &phase)
+                {
+                    const PerfCounterValues phase_per_ray = phase / static_cast<double>(std::max(1LL, r.rays));
+                    stream << ", \"" << prefix << "_cycles\": " << phase.cycles
+                           << ", \"" << prefix << "_instructions\": " << phase.instructions
+                           << ", \"" << prefix << "_ipc\": " << phase.get_ipc()
+                           << ", \"" << prefix << "_cache_misses_per_ray\": " << phase_per_ray.cache_misses
+                           << ", \"" << prefix << "_branch_misses_per_ray\": " << phase_per_ray.branch_misses;
+                };
+                write_phase("intersect", r.intersect_counters);
+                write_phase("shade", r.shade_counters);
+            }
+            stream << ", \"checksum\": \"" << to_hex(r.checksum) << "\"}"
+                   << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        stream << "  ]\n}\n";
+    }
+
+    // key に続く値（数値または文字列）を text の position 以降から探す
+    std::string find_value(const std::string &text, const std::string &key, const size_t position, const size_t end)
+    {
+        const size_t k = text.find("\"" + key + "\":", position);
+        if (k == std::string::npos || k >= end)
+            return "";
+        const size_t v = text.find_first_not_of(" ", k + key.size() + 3);
+        if (v == std::string::npos || v >= end)
+            return "";
+        if (text[v] == '"')
+            return text.substr(v + 1, text.find('"', v + 1) - v - 1);
+        return text.substr(v, text.find_first_of(",}\n", v) - v);
+    }
+
+    // write_json で書き出した基準の結果を読み込む（シーン名 → 結果）
+    std::map<std::string, SceneResult> read_baseline(const std::string &path, int &num_threads)
+    {
+        std::ifstream file(path);
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        const std::string text = buffer.str();
+
+        std::map<std::string, SceneResult> baseline;
+        num_threads = std::atoi(find_value(text, "threads", 0, text.size()).c_str());
+        for (size_t p = text.find("{\"name\""); p != std::string::npos; p = text.find("{\"name\"", p + 1))
+        {
+            const size_t end = text.find('}', p);
+            SceneResult r;
+            r.name = find_value(text, "name", p, end);
+            r.wall_seconds = std::atof(find_value(text, "wall_seconds", p, end).c_str());
+            r.rays = std::atoll(find_value(text, "rays", p, end).c_str());
+            r.checksum = std::strtoull(find_value(text, "checksum", p, end).c_str(), nullptr, 16);
+            baseline[r.name] = r;
+        }
+        return baseline;
+    }
+
+    // 基準より tolerance を超えて遅いシーン，または画像・レイの本数が基準と異なるシーンがある場合は false を返す
+    bool compare_with_baseline(const std::vector<SceneResult> &results, const Options &options, const int num_threads)
+    {
+        int baseline_threads = 0;
+        const std::map<std::string, SceneResult> baseline = read_baseline(options.baseline, baseline_threads);
+        if (baseline.empty())
+        {
+            std::cerr << "\x1b[31mError : Failed to read the baseline " << options.baseline << ".\x1b[39m" << std::endl;
+            return false;
+        }
+        if (baseline_threads != num_threads)
+            std::cout << "warning : the baseline was measured with " << baseline_threads << " threads (now " << num_threads << ")" << std::endl;
+
+        bool passed = true;
+        std::printf("\n%-28s %12s %12s %9s\n", "scene", "baseline [s]", "current [s]", "ratio");
+        for (const SceneResult &r : results)
+        {
+            const auto it = baseline.find(r.name);
+            if (it == baseline.end() || it->second.wall_seconds <= 0)
+            {
+                std::printf("%-28s %12s %12.4f %9s\n", r.name.c_str(), "-", r.wall_seconds, "-");
+                continue;
+            }
+            // 画像やレイの本数が変わった場合は同じ処理量での比較にならないため，時間は比較せずに失敗とする
+            if (it->second.checksum != r.checksum || it->second.rays != r.rays)
+            {
+                passed = false;
+                std::printf("%-28s %12.4f %12.4f %9s  \x1b[31mMISMATCH (image or ray count differs from the baseline)\x1b[39m\n", r.name.c_str(),
+                            it->second.wall_seconds, r.wall_seconds, "-");
+                continue;
+            }
+            const double ratio = r.wall_seconds / it->second.wall_seconds;
+            const bool regressed = ratio > 1.0 + options.tolerance;
+            passed = passed && !regressed;
+            std::printf("%-28s %12.4f %12.4f %8.3fx%s\n", r.name.c_str(), it->second.wall_seconds, r.wall_seconds, ratio,
+                        regressed ? "  \x1b[31mREGRESSION\x1b[39m" : "");
+        }
+        return passed;
+    }
+
+    std::vector<std::string> split(const std::string &text, const char delimiter)
+    {
+        std::vector<std::string> tokens;
+        std::stringstream stream(text);
+        std::string token;
+        while (std::getline(stream, token, delimiter))
+            if (!token.empty())
+                tokens.push_back(token);
+        return tokens;
+    }
+}
+
+// src/ 以下の各章のシーンを固定の解像度・サンプル数・シードで描画し，経過時間・Mrays/s・samples/s・ピーク時のメモリ量を JSON で出力する
+// --baseline を与えた場合は基準の結果と比較し，遅くなったシーンがあれば終了コード 1 で終了する
+// 一定数のサンプルを追跡するシーン（03・05-03 以外）は，カメラからのレイと鏡面で 1 回反射したレイを --packet-size 本ずつのパケットで交差判定する（既定は 8）
+// --integrator wavefront を与えた場合は，それらのシーンを PathIntegrator の代わりに WavefrontIntegrator で描画する
+// --sort-rays 1 を与えると，2 回目以降の交差判定の前にレイを方向と始点の位置で並べ替える
+// ./a.out [--width W] [--height H] [--spp N] [--seed S] [--threads T] [--repeat R] [--scenes a,b,...]
+//         [--output results.json] [--baseline render_baseline.json] [--tolerance 0.1] [--integrator path|wavefront] [--packet-size 0|4|8|16]
+//         [--sort-rays 0|1]
+int main(int argc, char **argv)
+{
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const std::string key = argv[i];
+        const char *value = argv[i + 1];
+        if (key == "--width")
+            options.width = std::atoi(value);
+        else if (key == "--height")
+            options.height = std::atoi(value);
+        else if (key == "--spp")
+            options.samples_per_pixel = std::atoi(value);
+        else if (key == "--seed")
+            options.seed = std::strtoull(value, nullptr, 10);
+        else if (key == "--threads")
+            options.num_threads = std::atoi(value);
+        else if (key == "--repeat")
+            options.repeat = std::atoi(value);
+        else if (key == "--scenes")
+            options.scenes = split(value, ',');
+        else if (key == "--output")
+            options.output = value;
+        else if (key == "--baseline")
+            options.baseline = value;
+        else if (key == "--tolerance")
+            options.tolerance = std::atof(value);
+        else if (key == "--integrator")
+        {
+            if (std::strcmp(value, "path") != 0 && std::strcmp(value, "wavefront") != 0)
+            {
+                std::cerr << "\x1b[31mError : Unknown integrator " << value << ".\x1b[39m" << std::endl;
+                return 2;
+            }
+            options.wavefront = std::strcmp(value, "wavefront") == 0;
+        }
+        else if (key == "--sort-rays")
+            options.sort_rays = std::atoi(value) != 0;
+        else if (key == "--packet-size")
+        {
+            options.packet_size = std::atoi(value);
+            if (options.packet_size != 0 && options.packet_size != 4 && options.packet_size != 8 && options.packet_size != 16)
+            {
+                std::cerr << PathIntegrator::packet_size_exception().get_msg() << std::endl;
+                return 2;
+            }
+        }
+        else
+        {
+            std::cerr << "\x1b[31mError : Unknown option " << key << ".\x1b[39m" << std::endl;
+            return 2;
+        }
+    }
+    for (const std::string &name : options.scenes)
+    {
+        const std::vector<std::string> &names = get_benchmark_scene_names();
+        if (std::find(names.begin(), names.end(), name) == names.end())
+        {
+            std::cerr << "\x1b[31mError : Unknown scene " << name << ".\x1b[39m" << std::endl;
+            return 2;
+        }
+    }
+
+    const int num_threads = Renderer(options.num_threads).get_num_threads();
+    std::printf("%d x %d, %d spp, seed %llu, %d threads, %s, %s integrator", options.width, options.height, options.samples_per_pixel,
+                static_cast<unsigned long long>(options.seed), num_threads, PRECISION_NAME, options.wavefront ? "wavefront" : "path");
+    std::printf(" (packet size %d", options.packet_size);
+    if (options.wavefront)
+        std::printf(", ray sorting %s", options.sort_rays ? "on" : "off");
+    std::printf(")");
+    std::printf("\n");
+    PerfCounters counters;
+    if (!counters.is_available())
+        std::printf("hardware counters : unavailable (%s)\n", counters.get_error().c_str());
+    std::printf("%-28s %10s %10s %12s %10s", "scene", "wall [s]", "Mrays/s", "samples/s", "RSS [MB]");
+    if (counters.is_available())
+        std::printf(" %8s %15s %16s %8s %10s %10s %16s %16s", "IPC", "cache-miss/ray", "branch-miss/ray", "running",
+                    "isect IPC", "shade IPC", "isect miss/ray", "shade miss/ray");
+    std::printf("\n");
+    std::vector<SceneResult> results;
+    for (const std::string &name : options.scenes)
+    {
+        const SceneResult r = benchmark_scene(name, options, counters);
+        std::printf("%-28s %10.4f %10.3f %12.0f %10.1f", r.name.c_str(), r.wall_seconds, r.rays / r.wall_seconds * 1e-6,
+                    r.samples / r.wall_seconds, r.peak_rss_mb);
+        if (counters.is_available())
+        {
+            const PerfCounterValues per_ray = r.counters / static_cast<double>(std::max(1LL, r.rays));
+            std::printf(" %8.2f %15.4f %16.4f %7.1f%%", r.counters.get_ipc(), per_ray.cache_misses, per_ray.branch_misses, r.counters.get_running_ratio() * 100);
+            const double rays = static_cast<double>(std::max(1LL, r.rays));
+            std::printf(" %10.2f %10.2f %16.4f %16.4f", r.intersect_counters.get_ipc(), r.shade_counters.get_ipc(),
+                        r.intersect_counters.cache_misses / rays, r.shade_counters.cache_misses / rays);
+        }
+        std::printf("\n");
+        std::fflush(stdout);
+        results.push_back(r);
+    }
+
+    std::ofstream output(options.output);
+    write_json(output, options, num_threads, results, counters.is_available());
+    std::cout << "results : " << options.output << std::endl;
+
+    if (!options.baseline.empty() && !compare_with_baseline(results, options, num_threads))
+        return 1;
+}
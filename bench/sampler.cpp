@@ -0,0 +1,86 @@
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "../header/aggregate.h"
+#include "../header/camera.h"
+#include "../header/integrator.h"
+#include "../header/material.h"
+#include "../header/renderer.h"
+#include "../header/sampler.h"
+#include "../header/sphere.h"
+
+namespace
+{
+    // 2 枚の画像の画素値の二乗平均誤差
+    double rmse(const Image &image, const Image &reference)
+    {
+        double squared_error = 0;
+        for (int y = 0; y < image.get_height(); y++)
+        {
+            for (int x = 0; x < image.get_width(); x++)
+            {
+                const Color d = image.get_pixel(x, y) - reference.get_pixel(x, y);
+                squared_error += (d.r * d.r + d.g * d.g + d.b * d.b) / 3;
+            }
+        }
+        return std::sqrt(squared_error / (image.get_width() * image.get_height()));
+    }
+}
+
+// 05-03 と同じ配置のシーンを，標本列ごとに 1 ピクセルあたりのサンプル数を変えて描画し，参照画像との二乗平均誤差を出力する
+// 同じ誤差に達するまでのサンプル数を標本列どうしで比較するのに用いる（./a.out [reference_samples]）
+int main(int argc, char **argv)
+{
+    const int reference_samples = argc > 1 ? std::atoi(argv[1]) : 4096;
+
+    const int image_width = 160;
+    const int image_height = 120;
+    const Vec3 look_from(3, 3, 2);
+    const Vec3 look_at(0, 0, -1);
+    ThinLensCamera camera(image_width, image_height, Ray(look_from, look_at - look_from), 0.5, (look_at - look_from).norm(), M_PI / 9);
+
+    Aggregate world;
+    world.add(std::make_shared<MaterializedSphere>(Vec3(0, 0, -1), 0.5, std::make_shared<Lambertian>(Color(0.1, 0.2, 0.5))));
+    world.add(std::make_shared<MaterializedSphere>(Vec3(0, -100.5, -1), 100, std::make_shared<Lambertian>(Color(0.8, 0.8, 0.0))));
+    world.add(std::make_shared<MaterializedSphere>(Vec3(1, 0, -1), 0.5, std::make_shared<Mirror>(Color(0.8, 0.6, 0.2))));
+    world.add(std::make_shared<MaterializedSphere>(Vec3(-1, 0, -1), 0.5, std::make_shared<Glass>(1.5)));
+    world.build();
+
+    PathIntegrator integrator;
+    auto ray_color = [&](const Ray &r, SampleStream &random)
+    { return integrator.trace(r, world, random); };
+
+    Renderer renderer;
+    renderer.set_sampler(std::make_shared<SobolSampler>(0xfeed));
+    renderer.render(camera, reference_samples, ray_color);
+    const Image reference = camera.get_image();
+
+    const struct
+    {
+        const char *name;
+        std::shared_ptr<const Sampler> sampler;
+    } samplers[] = {
+        {"independent", nullptr},
+        {"sobol", std::make_shared<SobolSampler>()},
+        {"halton", std::make_shared<HaltonSampler>()},
+        {"blue_noise", std::make_shared<BlueNoiseSampler>()}};
+
+    std::cout << std::setw(12) << "spp";
+    for (const auto &s : samplers)
+        std::cout << std::setw(14) << s.name;
+    std::cout << std::endl;
+    for (int samples_per_pixel = 1; samples_per_pixel <= 64; samples_per_pixel *= 4)
+    {
+        std::cout << std::setw(12) << samples_per_pixel;
+        for (const auto &s : samplers)
+        {
+            renderer.set_sampler(s.sampler);
+            renderer.render(camera, samples_per_pixel, ray_color);
+            std::cout << std::setw(14) << rmse(camera.get_image(), reference);
+        }
+        std::cout << std::endl;
+    }
+}
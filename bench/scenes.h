@@ -0,0 +1,98 @@
+#ifndef BENCH_SCENES_H
+#define BENCH_SCENES_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "../header/aggregate.h"
+#include "../header/camera.h"
+#include "../header/random.h"
+#include "../header/scenes.h"
+
+// src/ 以下の各章のプログラムと同じ配置のシーン（配置は header/scenes.h を共有し，解像度と物体の配置の乱数のシードは引数で与える）
+struct BenchmarkScene
+{
+    // 各章のプログラムの描画方法
+    enum class Shading
+    {
+        Normal,    // 法線を色とする（03）
+        Path,      // PathIntegrator で 1 ピクセルあたり一定数のサンプルを追跡する（04-01 ~ 05-02，10）
+        Adaptive   // AdaptiveSampler でピクセルごとのサンプル数を決める（05-03）
+    };
+
+    std::string name;
+    std::unique_ptr<Camera> camera;
+    Aggregate world;
+    Shading shading;
+};
+
+// ベンチマークで描画するシーンの名前（src/ 以下のファイル名と同じ）
+inline const std::vector<std::string> &get_benchmark_scene_names()
+{
+    static const std::vector<std::string> names = {
+        "03_anti_aliasing", "04-01_material_rendering", "04-02_material_rendering",
+        "05-01_fov_control", "05-02_camera_control", "05-03_depth_contrast", "10_last_seen"};
+    return names;
+}
+
+// name のシーンを width x height の解像度で構築する（該当するシーンがない場合は camera を nullptr とする）
+inline BenchmarkScene make_benchmark_scene(const std::string &name, const int width, const int height, const uint64_t seed)
+{
+    BenchmarkScene scene;
+    scene.name = name;
+    if (name == "03_anti_aliasing")
+    {
+        scene.camera = std::make_unique<PinholeCamera>(width, height);
+        add_sphere_on_ground(scene.world);
+        scene.shading = BenchmarkScene::Shading::Normal;
+    }
+    else if (name == "04-01_material_rendering")
+    {
+        scene.camera = std::make_unique<PinholeCamera>(width, height);
+        add_material_spheres(scene.world);
+        scene.shading = BenchmarkScene::Shading::Path;
+    }
+    else if (name == "04-02_material_rendering")
+    {
+        scene.camera = std::make_unique<PinholeCamera>(width, height);
+        add_three_spheres(scene.world);
+        scene.shading = BenchmarkScene::Shading::Path;
+    }
+    else if (name == "05-01_fov_control")
+    {
+        scene.camera = std::make_unique<PinholeCamera>(width, height, Ray(Vec3(), Vec3(0, 0, -1)), M_PI / 2);
+        add_fov_spheres(scene.world);
+        scene.shading = BenchmarkScene::Shading::Path;
+    }
+    else if (name == "05-02_camera_control")
+    {
+        const Vec3 look_from(-2, 2, 1), look_at(0, 0, -1);
+        scene.camera = std::make_unique<PinholeCamera>(width, height, Ray(look_from, look_at - look_from), M_PI / 4);
+        add_three_spheres(scene.world);
+        scene.shading = BenchmarkScene::Shading::Path;
+    }
+    else if (name == "05-03_depth_contrast")
+    {
+        const Vec3 look_from(3, 3, 2), look_at(0, 0, -1);
+        scene.camera = std::make_unique<ThinLensCamera>(width, height, Ray(look_from, look_at - look_from), 2.0, (look_at - look_from).norm(), M_PI / 9);
+        add_three_spheres(scene.world);
+        scene.shading = BenchmarkScene::Shading::Adaptive;
+    }
+    else if (name == "10_last_seen")
+    {
+        const Vec3 look_from(13, 2, 3), look_at(0);
+        scene.camera = std::make_unique<ThinLensCamera>(width, height, Ray(look_from, look_at - look_from), 0.2, 10.0, M_PI / 9);
+        // 小さな球の配置は seed で初期化した乱数で決め，実行ごとに同じシーンとする
+        Pcg32 random(seed);
+        add_last_seen_spheres(scene.world, random);
+        scene.shading = BenchmarkScene::Shading::Path;
+    }
+    else
+    {
+        return scene;
+    }
+    scene.world.build();
+    return scene;
+}
+
+#endif
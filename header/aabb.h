@@ -0,0 +1,93 @@
+#ifndef AABB_H
+#define AABB_H
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include "vec3.h"
+
+// 軸に平行な直方体（Axis-Aligned Bounding Box）
+class AABB
+{
+public:
+    Vec3 lower; // 各軸の最小値
+    Vec3 upper; // 各軸の最大値
+
+    // コンストラクタ
+    // 引数なしの場合は，何も含まない（expand で最初に与えた点・直方体に一致する）空の直方体とする
+    AABB() : lower(std::numeric_limits<Real>::infinity()), upper(-std::numeric_limits<Real>::infinity()) {}
+    AABB(const Vec3 &_lower, const Vec3 &_upper) : lower(_lower), upper(_upper) {}
+
+    // 点を含むように拡張
+    void expand(const Vec3 &p)
+    {
+        lower = Vec3(std::min(lower.x, p.x), std::min(lower.y, p.y), std::min(lower.z, p.z));
+        upper = Vec3(std::max(upper.x, p.x), std::max(upper.y, p.y), std::max(upper.z, p.z));
+    }
+
+    // 直方体を含むように拡張
+    void expand(const AABB &box)
+    {
+        expand(box.lower);
+        expand(box.upper);
+    }
+
+    bool is_empty() const
+    {
+        return lower.x > upper.x || lower.y > upper.y || lower.z > upper.z;
+    }
+
+    Vec3 get_center() const
+    {
+        return 0.5 * (lower + upper);
+    }
+
+    // 表面積（SAH のコスト計算に用いる）
+    double get_surface_area() const
+    {
+        if (is_empty())
+            return .0;
+        Vec3 d = upper - lower;
+        return 2.0 * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+
+    // 最も長い辺の軸番号（0: x, 1: y, 2: z）
+    int get_longest_axis() const
+    {
+        Vec3 d = upper - lower;
+        if (d.x >= d.y && d.x >= d.z)
+            return 0;
+        return d.y >= d.z ? 1 : 2;
+    }
+
+    // スラブ法によるレイとの交差判定
+    // inverse_direction はレイの方向ベクトルの各成分の逆数で，[t_min, t_max] の範囲で交差すれば進入距離を t_entry に格納する
+    bool intersect(const Vec3 &origin, const Vec3 &inverse_direction, const Real t_min, const Real t_max, Real &t_entry) const
+    {
+        Real t0 = t_min;
+        Real t1 = t_max;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            Real t_near = (lower[axis] - origin[axis]) * inverse_direction[axis];
+            Real t_far = (upper[axis] - origin[axis]) * inverse_direction[axis];
+            if (t_near > t_far)
+                std::swap(t_near, t_far);
+            // NaN（0 * inf）の場合は比較が偽となり，範囲を狭めない
+            t0 = t_near > t0 ? t_near : t0;
+            t1 = t_far < t1 ? t_far : t1;
+            if (t0 > t1)
+                return false;
+        }
+        t_entry = t0;
+        return true;
+    }
+
+    // コンソール出力
+    inline friend std::ostream &operator<<(std::ostream &stream, const AABB &b)
+    {
+        stream << "lower : " << b.lower << "\nupper : " << b.upper;
+        return stream;
+    }
+};
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef ACCUMULATION_BUFFER_H
+#define ACCUMULATION_BUFFER_H
+
+#include <algorithm>
+#include <cmath>
+#include "aligned_allocator.h"
+#include "color.h"
+#include "framebuffer.h"
+#include "image.h"
+
+// 1 ピクセルに加えたサンプルの統計量
+// 色は合計を，分散は輝度について Welford の方法で逐次更新した平均と偏差平方和を保持する
+struct PixelStatistics
+{
+    int count{0};
+    Color sum;
+    double mean_luminance{.0};
+    double squared_deviation_sum{.0}; // 輝度の偏差平方和
+
+    static double luminance(const Color &c)
+    {
+        return 0.2126 * c.r + 0.7152 * c.g + 0.0722 * c.b;
+    }
+
+    void add(const Color &c)
+    {
+        count++;
+        sum += c;
+        const double y = luminance(c);
+        const double delta = y - mean_luminance;
+        mean_luminance += delta / count;
+        squared_deviation_sum += delta * (y - mean_luminance);
+    }
+
+    // サンプルの平均（サンプルがない場合は黒）
+    Color get_mean() const
+    {
+        return count > 0 ? sum / Real(count) : Color(0);
+    }
+
+    // 輝度の不偏分散（サンプルが 2 つ未満の場合は 0）
+    double get_variance() const
+    {
+        return count > 1 ? squared_deviation_sum / (count - 1) : .0;
+    }
+
+    // 輝度の平均の標準誤差
+    double get_standard_error() const
+    {
+        return count > 0 ? std::sqrt(get_variance() / count) : .0;
+    }
+};
+
+// ピクセルごとのサンプルの統計量を保持するバッファ
+// 各ピクセルは 1 つのワーカーだけが更新するため，タイル単位で複数スレッドから同時に書き込める
+class AccumulationBuffer
+{
+private:
+    int width;
+    int height;
+    AlignedVector<PixelStatistics> pixels;
+
+    size_t index(const int x, const int y) const
+    {
+        return static_cast<size_t>(y) * width + x;
+    }
+
+public:
+    // コンストラクタ
+    AccumulationBuffer(const int _width, const int _height) : width(_width), height(_height), pixels(static_cast<size_t>(_width) * _height) {}
+
+    // ゲッター
+    int get_width() const { return width; }
+    int get_height() const { return height; }
+    const PixelStatistics &get_pixel(const int x, const int y) const { return pixels[index(x, y)]; }
+    PixelStatistics &get_pixel(const int x, const int y) { return pixels[index(x, y)]; }
+
+    // 全ピクセルのサンプル数の合計
+    long long get_total_samples() const
+    {
+        long long total = 0;
+        for (const PixelStatistics &p : pixels)
+        {
+            total += p.count;
+        }
+        return total;
+    }
+
+    // 画像全体のノイズの目安として，各ピクセルの輝度の相対標準誤差 stderr / max(平均, min_luminance) の平均を求める
+    double get_mean_relative_error(const double min_luminance = 0.01) const
+    {
+        if (pixels.empty())
+            return .0;
+        double sum = .0;
+        for (const PixelStatistics &p : pixels)
+        {
+            sum += p.get_standard_error() / std::max(p.mean_luminance, min_luminance);
+        }
+        return sum / pixels.size();
+    }
+
+    void add_sample(const int x, const int y, const Color &c)
+    {
+        pixels[index(x, y)].add(c);
+    }
+
+    // 全ピクセルの統計量を初期化する
+    void clear()
+    {
+        std::fill(pixels.begin(), pixels.end(), PixelStatistics());
+    }
+
+    // 各ピクセルのサンプルの平均を framebuffer に書き込む
+    void resolve(const FrameBufferView &framebuffer) const
+    {
+        if (framebuffer.get_width() != width || framebuffer.get_height() != height)
+        {
+            throw size_mismatch_exception();
+        }
+        for (int y = 0; y < height; y++)
+        {
+            Color *row = framebuffer.get_row(y);
+            for (int x = 0; x < width; x++)
+            {
+                row[x] = pixels[index(x, y)].get_mean();
+            }
+        }
+    }
+
+    // ピクセルごとのサンプル数を max_samples を上限として青（少ない）→ 緑 → 赤（多い）の色で表した画像
+    Image make_sample_heatmap(const int max_samples) const
+    {
+        Image heatmap(width, height);
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                const double t = clamp(static_cast<double>(pixels[index(x, y)].count) / std::max(1, max_samples), .0, 1.0);
+                const Color color = t < 0.5 ? Color(0, Real(2 * t), Real(1 - 2 * t)) : Color(Real(2 * t - 1), Real(2 - 2 * t), 0);
+                heatmap.set_pixel(x, y, color);
+            }
+        }
+        return heatmap;
+    }
+
+    class size_mismatch_exception
+    {
+    private:
+        const char *msg = "\x1b[31mError : The size of the framebuffer does not match the accumulation buffer.\x1b[39m";
+
+    public:
+        size_mismatch_exception() {}
+        const char *get_msg() const { return msg; }
+    };
+};
+
+#endif
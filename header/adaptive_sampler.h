@@ -0,0 +1,86 @@
+#ifndef ADAPTIVE_SAMPLER_H
+#define ADAPTIVE_SAMPLER_H
+
+#include <algorithm>
+#include "accumulation_buffer.h"
+
+// ピクセルごとのサンプル数を分散に応じて決める方針
+// 最低 min_samples 本を追跡した後，batch_size 本ごとに輝度の平均の 95% 信頼区間を調べ，
+// その半幅が threshold * max(平均輝度, MIN_LUMINANCE) 未満となるか max_samples 本に達するまでサンプルを追加する
+class AdaptiveSampler
+{
+private:
+    int min_samples;
+    int max_samples;
+    double threshold; // 信頼区間の半幅の，平均輝度に対する許容割合（0 の場合は常に max_samples 本を追跡する）
+    int batch_size;
+
+public:
+    static constexpr double CONFIDENCE_Z{1.96}; // 95% 信頼区間に対応する標準正規分布の分位点
+    static constexpr double MIN_LUMINANCE{0.01}; // 暗いピクセルで許容誤差が 0 に近づかないようにするための下限
+    static constexpr int DEFAULT_BATCH_SIZE{4};
+
+    // コンストラクタ
+    AdaptiveSampler(const int _min_samples, const int _max_samples, const double _threshold, const int _batch_size = DEFAULT_BATCH_SIZE)
+        : min_samples(_min_samples), max_samples(_max_samples), threshold(_threshold), batch_size(_batch_size)
+    {
+        if (_min_samples < 1 || _max_samples < _min_samples || _batch_size < 1)
+        {
+            throw sample_count_exception();
+        }
+        if (!(_threshold >= 0))
+        {
+            throw threshold_exception();
+        }
+    }
+
+    // ゲッター
+    int get_min_samples() const { return min_samples; }
+    int get_max_samples() const { return max_samples; }
+    double get_threshold() const { return threshold; }
+    int get_batch_size() const { return batch_size; }
+
+    // ピクセルの推定値が収束したか
+    bool is_converged(const PixelStatistics &pixel) const
+    {
+        if (pixel.count < min_samples)
+            return false;
+        const double half_width = CONFIDENCE_Z * pixel.get_standard_error();
+        return half_width < threshold * std::max(pixel.mean_luminance, MIN_LUMINANCE);
+    }
+
+    // 次に追加するサンプル数（0 の場合はサンプリングを終える）
+    // 収束の判定は min_samples 本に達した後 batch_size 本ごとに行う
+    int get_next_batch(const PixelStatistics &pixel) const
+    {
+        if (pixel.count >= max_samples)
+            return 0;
+        if (pixel.count < min_samples)
+            return min_samples - pixel.count;
+        if (is_converged(pixel))
+            return 0;
+        return std::min(batch_size, max_samples - pixel.count);
+    }
+
+    class sample_count_exception
+    {
+    private:
+        const char *msg = "\x1b[31mError : The sample counts of the adaptive sampler must satisfy 1 <= min <= max and batch size >= 1.\x1b[39m";
+
+    public:
+        sample_count_exception() {}
+        const char *get_msg() const { return msg; }
+    };
+
+    class threshold_exception
+    {
+    private:
+        const char *msg = "\x1b[31mError : The threshold of the adaptive sampler is set less than 0.\x1b[39m";
+
+    public:
+        threshold_exception() {}
+        const char *get_msg() const { return msg; }
+    };
+};
+
+#endif
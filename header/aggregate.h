@@ -2,12 +2,17 @@
 #define AGGREGATE_H
 #include <vector>
 #include <memory>
+#include "bvh.h"
+#include "ray_packet.h"
 #include "sphere.h"
+#include "stats.h"
+#include "trace.h"
 
 class Aggregate
 {
 private:
     std::vector<std::shared_ptr<Sphere>> spheres;
+    BVH bvh; // build() で構築する加速構造（物体の追加・削除で破棄される）
 
 public:
     Aggregate() {}
@@ -21,20 +26,47 @@ public:
     void clear()
     {
         spheres.clear();
+        bvh.clear();
     }
 
     // 物体の追加
     void add(const std::shared_ptr<Sphere> &s)
     {
         spheres.push_back(s);
+        bvh.clear();
+    }
+
+    // 全ての物体を追加した後に呼び出し，BVH を構築する
+    void build()
+    {
+        TraceScope trace("build_bvh", "scene");
+        trace.add_arg("spheres", static_cast<long long>(spheres.size()));
+        bvh.build(spheres);
+    }
+
+    bool is_built() const
+    {
+        return !bvh.is_empty();
     }
 
     // 与えられたレイと全ての物体との間で衝突計算を行い，最も手前に存在する物体との衝突情報を返す
+    // BVH を構築済みの場合は BVH を辿り，未構築の場合は全ての物体と総当たりで判定する
     std::optional<Hit> intersect(const Ray &ray) const
     {
+        RAYTRACING_STATS_TIMER(intersect_timer);
+        RAYTRACING_STATS_PHASE(Intersect);
+        RAYTRACING_STATS_ADD(rays, 1);
+        if (is_built())
+        {
+            std::optional<Hit> hit = bvh.intersect(ray);
+            RAYTRACING_STATS_ADD(hits, hit ? 1 : 0);
+            return hit;
+        }
+
+        RAYTRACING_STATS_ADD(sphere_tests, static_cast<long long>(spheres.size()));
         std::optional<Hit> closest_hit = std::nullopt;
 
-        for (std::shared_ptr<Sphere> sphere : spheres)
+        for (const std::shared_ptr<Sphere> &sphere : spheres)
         {
             // 各球体の交差を取得
             std::optional<Hit> hit_candidate = sphere->intersect(ray);
@@ -50,8 +82,32 @@ public:
             }
         }
 
+        RAYTRACING_STATS_ADD(hits, closest_hit ? 1 : 0);
         return closest_hit;
     }
+
+    // パケット内の全てのレイについて衝突計算を行い，結果を hits[0, packet.size) に格納する
+    // BVH を構築済みの場合はパケット単位で BVH を辿り，未構築の場合は 1 本ずつ判定する
+    template <int N>
+    void intersect(RayPacket<N> &packet, std::optional<Hit> *hits) const
+    {
+        if (is_built())
+        {
+            RAYTRACING_STATS_TIMER(intersect_timer);
+            RAYTRACING_STATS_PHASE(Intersect);
+            bvh.intersect(packet, hits);
+#if defined(RAYTRACING_STATS)
+            RAYTRACING_STATS_ADD(rays, packet.size);
+            for (int i = 0; i < packet.size; i++)
+                RAYTRACING_STATS_ADD(hits, hits[i] ? 1 : 0);
+#endif
+            return;
+        }
+        for (int i = 0; i < packet.size; i++)
+        {
+            hits[i] = intersect(packet.get_ray(i));
+        }
+    }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,340 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <algorithm>
+#include <bitset>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "aabb.h"
+#include "hit.h"
+#include "packed_spheres.h"
+#include "ray.h"
+#include "ray_packet.h"
+#include "sphere.h"
+#include "stats.h"
+
+// BVH のノード
+// 深さ優先順に配列へ格納し，左の子は常に直後のノードとすることで，右の子のインデックスのみを保持する
+struct alignas(64) BVHNode
+{
+    AABB bounds;
+    int offset; // 葉ノード : 最初の物体のインデックス，内部ノード : 右の子のインデックス
+    int count;  // 葉ノード : 物体数，内部ノード : 0
+    int axis;   // 内部ノードの分割軸
+};
+
+// 表面積ヒューリスティック（SAH）で構築する Bounding Volume Hierarchy
+class BVH
+{
+private:
+    // 構築時に用いる物体ごとの情報
+    struct BuildPrimitive
+    {
+        AABB bounds;
+        Vec3 centroid;
+        const Sphere *sphere;
+    };
+
+    std::vector<BVHNode> nodes;
+    PackedSpheres primitives; // 葉ノードの順に並べ替えた物体（葉ノード内は SIMD でまとめて判定する）
+
+    static constexpr int BIN_COUNT{16};
+    static constexpr int MAX_LEAF_SIZE{4};
+    static constexpr int MAX_DEPTH{64};
+    static constexpr double TRAVERSAL_COST{1.0};
+    static constexpr double INTERSECTION_COST{1.0};
+
+    // build_primitives[begin, end) を子とするノードを再帰的に構築し，そのノードのインデックスを返す
+    int build_recursive(std::vector<BuildPrimitive> &build_primitives, const int begin, const int end, const int depth)
+    {
+        const int node_index = static_cast<int>(nodes.size());
+        nodes.push_back(BVHNode());
+
+        AABB bounds, centroid_bounds;
+        for (int i = begin; i < end; i++)
+        {
+            bounds.expand(build_primitives[i].bounds);
+            centroid_bounds.expand(build_primitives[i].centroid);
+        }
+        nodes[node_index].bounds = bounds;
+
+        const int count = end - begin;
+        const int axis = centroid_bounds.get_longest_axis();
+        const double axis_lower = centroid_bounds.lower[axis];
+        const double axis_extent = centroid_bounds.upper[axis] - axis_lower;
+
+        int middle = begin + count / 2;
+        if (count <= 1 || depth >= MAX_DEPTH - 2)
+        {
+            return make_leaf(build_primitives, node_index, begin, end);
+        }
+        else if (axis_extent <= .0)
+        {
+            // 全ての物体の中心が一致する場合は，物体数で二等分する
+            if (count <= MAX_LEAF_SIZE)
+                return make_leaf(build_primitives, node_index, begin, end);
+        }
+        else
+        {
+            // 中心座標をビンに分類し，各分割位置での SAH コストを求める
+            AABB bin_bounds[BIN_COUNT];
+            int bin_counts[BIN_COUNT] = {};
+            auto bin_index = [&](const BuildPrimitive &p)
+            {
+                int b = static_cast<int>(BIN_COUNT * (p.centroid[axis] - axis_lower) / axis_extent);
+                return std::min(std::max(b, 0), BIN_COUNT - 1);
+            };
+            for (int i = begin; i < end; i++)
+            {
+                int b = bin_index(build_primitives[i]);
+                bin_counts[b]++;
+                bin_bounds[b].expand(build_primitives[i].bounds);
+            }
+
+            // 右側から累積した表面積と物体数
+            double right_areas[BIN_COUNT];
+            int right_counts[BIN_COUNT];
+            AABB right_bounds;
+            int right_count = 0;
+            for (int b = BIN_COUNT - 1; b > 0; b--)
+            {
+                right_bounds.expand(bin_bounds[b]);
+                right_count += bin_counts[b];
+                right_areas[b] = right_bounds.get_surface_area();
+                right_counts[b] = right_count;
+            }
+
+            double best_cost = std::numeric_limits<double>::infinity();
+            int best_split = -1;
+            AABB left_bounds;
+            int left_count = 0;
+            for (int b = 1; b < BIN_COUNT; b++)
+            {
+                left_bounds.expand(bin_bounds[b - 1]);
+                left_count += bin_counts[b - 1];
+                if (left_count == 0 || right_counts[b] == 0)
+                    continue;
+                double cost = left_bounds.get_surface_area() * left_count + right_areas[b] * right_counts[b];
+                if (cost < best_cost)
+                {
+                    best_cost = cost;
+                    best_split = b;
+                }
+            }
+
+            const double leaf_cost = INTERSECTION_COST * count;
+            const double split_cost = TRAVERSAL_COST + INTERSECTION_COST * best_cost / bounds.get_surface_area();
+            if (count <= MAX_LEAF_SIZE && leaf_cost <= split_cost)
+            {
+                return make_leaf(build_primitives, node_index, begin, end);
+            }
+
+            if (best_split > 0)
+            {
+                auto it = std::partition(build_primitives.begin() + begin, build_primitives.begin() + end,
+                                         [&](const BuildPrimitive &p)
+                                         { return bin_index(p) < best_split; });
+                middle = static_cast<int>(it - build_primitives.begin());
+            }
+        }
+
+        nodes[node_index].axis = axis;
+        nodes[node_index].count = 0;
+        build_recursive(build_primitives, begin, middle, depth + 1);
+        const int right_child = build_recursive(build_primitives, middle, end, depth + 1);
+        nodes[node_index].offset = right_child;
+        return node_index;
+    }
+
+    int make_leaf(const std::vector<BuildPrimitive> &build_primitives, const int node_index, const int begin, const int end)
+    {
+        nodes[node_index].offset = static_cast<int>(primitives.size());
+        nodes[node_index].count = end - begin;
+        nodes[node_index].axis = 0;
+        for (int i = begin; i < end; i++)
+        {
+            primitives.add(build_primitives[i].sphere);
+        }
+        return node_index;
+    }
+
+public:
+    BVH() {}
+    BVH(const std::vector<std::shared_ptr<Sphere>> &spheres)
+    {
+        build(spheres);
+    }
+
+    // 物体の集合から BVH を構築
+    void build(const std::vector<std::shared_ptr<Sphere>> &spheres)
+    {
+        clear();
+        if (spheres.empty())
+            return;
+
+        std::vector<BuildPrimitive> build_primitives;
+        build_primitives.reserve(spheres.size());
+        for (const std::shared_ptr<Sphere> &sphere : spheres)
+        {
+            AABB bounds = sphere->get_bounding_box();
+            build_primitives.push_back(BuildPrimitive{bounds, bounds.get_center(), sphere.get()});
+        }
+
+        nodes.reserve(2 * spheres.size());
+        build_recursive(build_primitives, 0, static_cast<int>(build_primitives.size()), 0);
+        nodes.shrink_to_fit();
+    }
+
+    void clear()
+    {
+        nodes.clear();
+        primitives.clear();
+    }
+
+    // ゲッター
+    const std::vector<BVHNode> &get_nodes() const { return nodes; }
+    const PackedSpheres &get_primitives() const { return primitives; }
+    size_t get_num_primitives() const { return primitives.size(); }
+    bool is_empty() const { return nodes.empty(); }
+
+    // BVH 内の球のうち，レイと交差する最も近い球を探す（除外の規則は PackedSpheres::find_closest と同じ）
+    // 近い側の子から探索し，既に見つかった衝突より遠いノードは枝刈りする
+    bool find_closest(const Ray &ray, const Real after_distance, const int after_index, int &closest_index, Real &closest_distance) const
+    {
+        if (nodes.empty())
+            return false;
+
+        const Vec3 origin = ray.get_origin();
+        const Vec3 direction = ray.get_direction();
+        const Vec3 inverse_direction(Real(1) / direction.x, Real(1) / direction.y, Real(1) / direction.z);
+        const bool direction_is_negative[3] = {direction.x < 0, direction.y < 0, direction.z < 0};
+        closest_distance = Hit::MAX_DISTANCE;
+        closest_index = -1;
+
+        int stack[MAX_DEPTH];
+        int stack_size = 0;
+        int node_index = 0;
+        while (true)
+        {
+            const BVHNode &node = nodes[node_index];
+            Real t_entry;
+            if (node.bounds.intersect(origin, inverse_direction, Real(0), closest_distance, t_entry))
+            {
+                if (node.count > 0)
+                {
+                    RAYTRACING_STATS_ADD(sphere_tests, node.count);
+                    primitives.find_closest(ray, node.offset, node.offset + node.count, closest_distance, closest_index, closest_distance, after_distance, after_index);
+                }
+                else
+                {
+                    // レイの進行方向に近い側の子を先に探索する
+                    if (direction_is_negative[node.axis])
+                    {
+                        stack[stack_size++] = node_index + 1;
+                        node_index = node.offset;
+                    }
+                    else
+                    {
+                        stack[stack_size++] = node.offset;
+                        node_index = node_index + 1;
+                    }
+                    continue;
+                }
+            }
+            if (stack_size == 0)
+                break;
+            node_index = stack[--stack_size];
+        }
+
+        return closest_index >= 0;
+    }
+
+    // 与えられたレイと BVH 内の物体との間で衝突計算を行い，最も手前に存在する物体との衝突情報を返す
+    // 衝突情報は最も近い球についてのみ Sphere::intersect で生成し，
+    // 棄却された場合（単精度でカーネルのみがかすめる球と交差と判定した場合）はその次に近い球を探し直す
+    std::optional<Hit> intersect(const Ray &ray) const
+    {
+        if (nodes.empty())
+            return std::nullopt;
+
+        Real after_distance = -std::numeric_limits<Real>::infinity();
+        int after_index = -1;
+        while (true)
+        {
+            int closest_index;
+            Real closest_distance;
+            if (!find_closest(ray, after_distance, after_index, closest_index, closest_distance))
+                return std::nullopt;
+            if (std::optional<Hit> hit = primitives.get_sphere(closest_index)->intersect(ray))
+                return hit;
+            after_distance = closest_distance;
+            after_index = closest_index;
+        }
+    }
+
+    // パケット内の全てのレイについて BVH を同時に辿り，最も手前の物体との衝突情報を hits[0, packet.size) に格納する
+    // いずれかのレイと交差するノードを探索し，交差しないレイはマスクで除外する
+    // 子の探索順は，ノードと交差した最初のレイの進行方向で決める
+    template <int N>
+    void intersect(RayPacket<N> &packet, std::optional<Hit> *hits) const
+    {
+        if (!nodes.empty())
+        {
+            int stack[MAX_DEPTH];
+            int stack_size = 0;
+            int node_index = 0;
+            while (true)
+            {
+                const BVHNode &node = nodes[node_index];
+                const int ray_mask = packet.intersect(node.bounds);
+                if (ray_mask != 0)
+                {
+                    if (node.count > 0)
+                    {
+                        RAYTRACING_STATS_ADD(sphere_tests, static_cast<long long>(node.count) * std::bitset<32>(ray_mask).count());
+                        primitives.find_closest(packet, node.offset, node.offset + node.count, ray_mask);
+                    }
+                    else
+                    {
+                        int first_ray = 0;
+                        while (((ray_mask >> first_ray) & 1) == 0)
+                            first_ray++;
+                        if (packet.direction[node.axis][first_ray] < 0)
+                        {
+                            stack[stack_size++] = node_index + 1;
+                            node_index = node.offset;
+                        }
+                        else
+                        {
+                            stack[stack_size++] = node.offset;
+                            node_index = node_index + 1;
+                        }
+                        continue;
+                    }
+                }
+                if (stack_size == 0)
+                    break;
+                node_index = stack[--stack_size];
+            }
+        }
+
+        for (int i = 0; i < packet.size; i++)
+        {
+            const int closest_index = packet.get_closest_index(i);
+            if (closest_index < 0)
+            {
+                hits[i] = std::nullopt;
+                continue;
+            }
+            const Ray ray = packet.get_ray(i);
+            hits[i] = primitives.get_sphere(closest_index)->intersect(ray);
+            // Sphere::intersect に棄却された場合は 1 本のレイとして探し直す
+            if (!hits[i])
+                hits[i] = intersect(ray);
+        }
+    }
+};
+
+#endif
@@ -2,13 +2,15 @@
 #define CAMERA_H
 #include "vec3.h"
 #include "ray.h"
+#include "framebuffer.h"
 #include "image.h"
+#include "sampler.h"
 #include "util.h"
 
 class Camera
 {
 protected:
-    const Image image;
+    Image image;
     const Ray view_direction;
     const double vertical_field_of_view; // 垂直方向の視野角（弧度法）
     Vec3 u, v, w; // カメラの向きを表す正規直交規定(u, v, w)
@@ -26,17 +28,35 @@ public:
           view_direction(_view_direction),
           vertical_field_of_view(_vertical_fov) {}
 
-    Image get_image() const
+    // カメラが所有する画像への参照（ガンマ補正などの画像全体に対する処理に用いる）
+    Image &get_image()
     {
         return image;
     }
 
+    const Image &get_image() const
+    {
+        return image;
+    }
+
+    // カメラが所有する画像に直接書き込むためのビュー（レンダラがタイル単位で書き込むのに用いる）
+    FrameBufferView get_framebuffer()
+    {
+        return FrameBufferView(image);
+    }
+
     void save_photo(const char *output_filepath) const
     {
         image.save_png(output_filepath);
     }
 
-    virtual Ray get_ray(const int pixel_x, const int pixel_y) const = 0;
+    // ピクセル (pixel_x, pixel_y) を通るレイを，random から次元の順に取り出した値を用いてサンプリングする
+    virtual Ray get_ray(const int pixel_x, const int pixel_y, SampleStream &random) const = 0;
+
+    Ray get_ray(const int pixel_x, const int pixel_y) const
+    {
+        return get_ray(pixel_x, pixel_y, thread_local_sample_stream());
+    }
 };
 
 class PinholeCamera : public Camera
@@ -64,11 +84,13 @@ public:
         left_lower_corner = view_direction.get_origin() - horizon / 2 - vertical / 2 - w;
     }
 
-    Ray get_ray(const int pixel_x, const int pixel_y) const override
+    using Camera::get_ray;
+
+    Ray get_ray(const int pixel_x, const int pixel_y, SampleStream &random) const override
     {
         // アンチエイリアシングを行うために、ピクセル内のランダムな地点を通るサンプルの生成
-        double s = (double(pixel_x) + generate_random_in_range(.0, 1.0)) / double(image.get_width());
-        double t = 1.0 - (double(pixel_y) + generate_random_in_range(.0, 1.0)) / double(image.get_height());
+        double s = (double(pixel_x) + generate_random_in_range(random, .0, 1.0)) / double(image.get_width());
+        double t = 1.0 - (double(pixel_y) + generate_random_in_range(random, .0, 1.0)) / double(image.get_height());
         return Ray(view_direction.get_origin(), left_lower_corner + s * horizon + t * vertical - view_direction.get_origin());
     }
 };
@@ -105,16 +127,18 @@ public:
         left_lower_corner = view_direction.get_origin() - horizon / 2 - vertical / 2 - _focus_distance * w;
     }
 
-    Ray get_ray(const int pixel_x, const int pixel_y) const override
+    using Camera::get_ray;
+
+    Ray get_ray(const int pixel_x, const int pixel_y, SampleStream &random) const override
     {
         // レンズから放たれるレイ
-        double theta = generate_random_in_range(.0, 2 * M_PI);
-        Vec3 lens_sample = generate_random_in_range(.0, lens_radius) * Vec3(cos(theta), sin(theta), 0);
+        double theta = generate_random_in_range(random, .0, 2 * M_PI);
+        Vec3 lens_sample = generate_random_in_range(random, .0, lens_radius) * Vec3(cos(theta), sin(theta), 0);
         Vec3 offset = lens_sample.x * u + lens_sample.y * v;
 
         // アンチエイリアシングを行うために、ピクセル内のランダムな地点を通るサンプルの生成
-        double s = (double(pixel_x) + generate_random_in_range(.0, 1.0)) / double(image.get_width());
-        double t = 1.0 - (double(pixel_y) + generate_random_in_range(.0, 1.0)) / double(image.get_height());
+        double s = (double(pixel_x) + generate_random_in_range(random, .0, 1.0)) / double(image.get_width());
+        double t = 1.0 - (double(pixel_y) + generate_random_in_range(random, .0, 1.0)) / double(image.get_height());
         return Ray(
             view_direction.get_origin() + offset,
             left_lower_corner + s * horizon + t * vertical - view_direction.get_origin() - offset);
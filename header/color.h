@@ -2,132 +2,138 @@
 #define COLOR_H
 
 #include <iostream>
+#include "real.h"
 
-class Color
+// 成分の型を T（float または double）とする色
+template <typename T>
+class ColorT
 {
 public:
-    double r, g, b;
+    T r, g, b;
 
     // コンストラクタ
-    Color() : r(.0), g(.0), b(.0) {}
-    Color(double _g) : r(_g), g(_g), b(_g) {}
-    Color(double _r, double _g, double _b) : r(_r), g(_g), b(_b) {}
+    ColorT() : r(.0), g(.0), b(.0) {}
+    ColorT(T _g) : r(_g), g(_g), b(_g) {}
+    ColorT(T _r, T _g, T _b) : r(_r), g(_g), b(_b) {}
+    // 精度の異なる色からの変換
+    template <typename U>
+    explicit ColorT(const ColorT<U> &c) : r(static_cast<T>(c.r)), g(static_cast<T>(c.g)), b(static_cast<T>(c.b)) {}
 
     // デストラクタ
-    ~Color() {}
+    ~ColorT() {}
 
     // ベクトル同士の演算
-    inline Color operator+(const Color &c) const
+    inline ColorT operator+(const ColorT &c) const
     {
-        return Color(r + c.r, g + c.g, b + c.b);
+        return ColorT(r + c.r, g + c.g, b + c.b);
     }
 
-    inline Color operator+=(const Color &c)
+    inline ColorT operator+=(const ColorT &c)
     {
         r += c.r, g += c.g, b += c.b;
         return *this;
     }
 
-    inline Color operator-(const Color &c) const
+    inline ColorT operator-(const ColorT &c) const
     {
-        return Color(r - c.r, g - c.g, b - c.b);
+        return ColorT(r - c.r, g - c.g, b - c.b);
     }
 
-    inline Color operator-=(const Color &c)
+    inline ColorT operator-=(const ColorT &c)
     {
         r -= c.r, g -= c.g, b -= c.b;
         return *this;
     }
 
-    inline Color operator*(const Color &c) const
+    inline ColorT operator*(const ColorT &c) const
     {
-        return Color(r * c.r, g * c.g, b * c.b);
+        return ColorT(r * c.r, g * c.g, b * c.b);
     }
 
-    inline Color operator*=(const Color &c)
+    inline ColorT operator*=(const ColorT &c)
     {
         r *= c.r, g *= c.g, b *= c.b;
         return *this;
     }
 
-    inline Color operator/(const Color &c) const
+    inline ColorT operator/(const ColorT &c) const
     {
-        return Color(r / c.r, g / c.g, b / c.b);
+        return ColorT(r / c.r, g / c.g, b / c.b);
     }
 
-    inline Color operator/=(const Color &c)
+    inline ColorT operator/=(const ColorT &c)
     {
         r /= c.r, g /= c.g, b /= c.b;
         return *this;
     }
 
     // ベクトルとスカラーの演算
-    inline Color operator+(const double s) const
+    inline ColorT operator+(const T s) const
     {
-        return Color(r + s, g + s, b + s);
+        return ColorT(r + s, g + s, b + s);
     }
 
-    inline friend Color operator+(const double s, const Color &c)
+    inline friend ColorT operator+(const T s, const ColorT &c)
     {
-        return Color(s + c.r, s + c.g, s + c.b);
+        return ColorT(s + c.r, s + c.g, s + c.b);
     }
 
-    inline Color operator+=(const double s)
+    inline ColorT operator+=(const T s)
     {
         r += s, g += s, b += s;
         return *this;
     }
 
-    inline Color operator-(const double s) const
+    inline ColorT operator-(const T s) const
     {
-        return Color(r - s, g - s, b - s);
+        return ColorT(r - s, g - s, b - s);
     }
 
-    inline friend Color operator-(const double s, const Color &c)
+    inline friend ColorT operator-(const T s, const ColorT &c)
     {
-        return Color(s - c.r, s - c.g, s - c.b);
+        return ColorT(s - c.r, s - c.g, s - c.b);
     }
 
-    inline Color operator-=(const double s)
+    inline ColorT operator-=(const T s)
     {
         r -= s, g -= s, b -= s;
         return *this;
     }
 
-    inline Color operator*(const double s) const
+    inline ColorT operator*(const T s) const
     {
-        return Color(r * s, g * s, b * s);
+        return ColorT(r * s, g * s, b * s);
     }
 
-    inline friend Color operator*(const double s, const Color &c)
+    inline friend ColorT operator*(const T s, const ColorT &c)
     {
-        return Color(s * c.r, s * c.g, s * c.b);
+        return ColorT(s * c.r, s * c.g, s * c.b);
     }
 
-    inline Color operator*=(const double s)
+    inline ColorT operator*=(const T s)
     {
         r *= s, g *= s, b *= s;
         return *this;
     }
 
-    inline Color operator/(const double s) const
+    inline ColorT operator/(const T s) const
     {
-        return Color(r / s, g / s, b / s);
+        return ColorT(r / s, g / s, b / s);
     }
 
-    inline friend Color operator/(const double s, const Color &c)
+    inline friend ColorT operator/(const T s, const ColorT &c)
     {
-        return Color(s / c.r, s / c.g, s / c.b);
+        return ColorT(s / c.r, s / c.g, s / c.b);
     }
 
-    inline Color operator/=(const double s)
+    inline ColorT operator/=(const T s)
     {
         r /= s, g /= s, b /= s;
         return *this;
     }
 
     // イコール演算子
-    inline bool operator==(const Color &c) const
+    inline bool operator==(const ColorT &c) const
     {
         if (r == c.r && g == c.g && b == c.b)
             return true;
@@ -136,11 +142,18 @@ public:
     }
 
     // コンソール出力
-    inline friend std::ostream &operator<<(std::ostream &stream, const Color &c)
+    inline friend std::ostream &operator<<(std::ostream &stream, const ColorT &c)
     {
         stream << "(" << c.r << ", " << c.g << ", " << c.b << ")";
         return stream;
     }
 };
 
+// SIMD レジスタで演算する特殊化（RAYTRACING_SIMD_VEC3 を定義した場合のみ）
+#if defined(RAYTRACING_SIMD_VEC3)
+#include "color_simd.h"
+#endif
+
+using Color = ColorT<Real>;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,96 @@
+#ifndef COLOR_SIMD_H
+#define COLOR_SIMD_H
+
+// color.h から RAYTRACING_SIMD_VEC3 が定義されている場合にのみ読み込まれる
+// ColorT と同じ演算子を，成分（r, g, b とパディング）を SIMD レジスタ 1 本に読み込んで実装する
+// 演算結果はスカラー版と同じとなる
+#include <iostream>
+#include "simd3.h"
+
+template <typename T>
+class SimdColorT
+{
+    using Simd = Simd3<T>;
+    using Register = typename Simd::Register;
+
+public:
+    // 成分はレジスタ幅の境界に揃えた 4 要素として持ち，演算の際に load / store でレジスタとやり取りする
+    alignas(sizeof(Register)) T r;
+    T g, b;
+    T padding;
+
+    // コンストラクタ
+    SimdColorT() : r(0), g(0), b(0), padding(0) {}
+    SimdColorT(T _g) : r(_g), g(_g), b(_g), padding(0) {}
+    SimdColorT(T _r, T _g, T _b) : r(_r), g(_g), b(_b), padding(0) {}
+    explicit SimdColorT(const Register _v) { Simd::store(&r, _v); }
+    // 精度の異なる色からの変換
+    template <typename U>
+    explicit SimdColorT(const ColorT<U> &c) : r(static_cast<T>(c.r)), g(static_cast<T>(c.g)), b(static_cast<T>(c.b)), padding(0) {}
+
+    // 3 成分とパディングを 1 本のレジスタとして読み込む
+    Register get_register() const { return Simd::load(&r); }
+
+    // ベクトル同士の演算
+    inline ColorT<T> operator+(const ColorT<T> &c) const { return ColorT<T>(Simd::add(get_register(), c.get_register())); }
+    inline ColorT<T> operator+=(const ColorT<T> &c) { return assign(Simd::add(get_register(), c.get_register())); }
+    inline ColorT<T> operator-(const ColorT<T> &c) const { return ColorT<T>(Simd::sub(get_register(), c.get_register())); }
+    inline ColorT<T> operator-=(const ColorT<T> &c) { return assign(Simd::sub(get_register(), c.get_register())); }
+    inline ColorT<T> operator*(const ColorT<T> &c) const { return ColorT<T>(Simd::mul(get_register(), c.get_register())); }
+    inline ColorT<T> operator*=(const ColorT<T> &c) { return assign(Simd::mul(get_register(), c.get_register())); }
+    inline ColorT<T> operator/(const ColorT<T> &c) const { return ColorT<T>(Simd::div(get_register(), c.get_register())); }
+    inline ColorT<T> operator/=(const ColorT<T> &c) { return assign(Simd::div(get_register(), c.get_register())); }
+
+    // ベクトルとスカラーの演算
+    inline ColorT<T> operator+(const T s) const { return ColorT<T>(Simd::add(get_register(), Simd::set1(s))); }
+    inline friend ColorT<T> operator+(const T s, const ColorT<T> &c) { return ColorT<T>(Simd::add(Simd::set1(s), c.get_register())); }
+    inline ColorT<T> operator+=(const T s) { return assign(Simd::add(get_register(), Simd::set1(s))); }
+    inline ColorT<T> operator-(const T s) const { return ColorT<T>(Simd::sub(get_register(), Simd::set1(s))); }
+    inline friend ColorT<T> operator-(const T s, const ColorT<T> &c) { return ColorT<T>(Simd::sub(Simd::set1(s), c.get_register())); }
+    inline ColorT<T> operator-=(const T s) { return assign(Simd::sub(get_register(), Simd::set1(s))); }
+    inline ColorT<T> operator*(const T s) const { return ColorT<T>(Simd::mul(get_register(), Simd::set1(s))); }
+    inline friend ColorT<T> operator*(const T s, const ColorT<T> &c) { return ColorT<T>(Simd::mul(Simd::set1(s), c.get_register())); }
+    inline ColorT<T> operator*=(const T s) { return assign(Simd::mul(get_register(), Simd::set1(s))); }
+    inline ColorT<T> operator/(const T s) const { return ColorT<T>(Simd::div(get_register(), Simd::set1(s))); }
+    inline friend ColorT<T> operator/(const T s, const ColorT<T> &c) { return ColorT<T>(Simd::div(Simd::set1(s), c.get_register())); }
+    inline ColorT<T> operator/=(const T s) { return assign(Simd::div(get_register(), Simd::set1(s))); }
+
+    // イコール演算子（パディングは比較しない）
+    inline bool operator==(const ColorT<T> &c) const { return Simd::equal(get_register(), c.get_register()); }
+
+    // コンソール出力
+    inline friend std::ostream &operator<<(std::ostream &stream, const ColorT<T> &c)
+    {
+        stream << "(" << c.r << ", " << c.g << ", " << c.b << ")";
+        return stream;
+    }
+
+private:
+    ColorT<T> assign(const Register result)
+    {
+        Simd::store(&r, result);
+        return static_cast<const ColorT<T> &>(*this);
+    }
+};
+
+#if defined(__AVX2__)
+template <>
+class ColorT<double> : public SimdColorT<double>
+{
+public:
+    using SimdColorT<double>::SimdColorT;
+};
+static_assert(sizeof(SimdColorT<double>) == 4 * sizeof(double), "SimdColorT<double> must be exactly one register wide");
+#endif
+
+#if defined(__SSE__)
+template <>
+class ColorT<float> : public SimdColorT<float>
+{
+public:
+    using SimdColorT<float>::SimdColorT;
+};
+static_assert(sizeof(SimdColorT<float>) == 4 * sizeof(float), "SimdColorT<float> must be exactly one register wide");
+#endif
+
+#endif
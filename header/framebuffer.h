@@ -0,0 +1,38 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include "color.h"
+#include "image.h"
+
+// Image の画素領域を直接参照する，所有権を持たないビュー
+// 画素領域の所有者（Image）より長く使ってはならない
+// 値渡ししても画素はコピーされないため，各スレッドが担当領域に直接書き込める
+class FrameBufferView
+{
+private:
+    Color *data;
+    int width;
+    int height;
+
+public:
+    // コンストラクタ
+    FrameBufferView(Color *_data, const int _width, const int _height) : data(_data), width(_width), height(_height) {}
+    FrameBufferView(Image &image) : data(image.get_data()), width(image.get_width()), height(image.get_height()) {}
+
+    // ゲッター
+    int get_width() const { return width; }
+    int get_height() const { return height; }
+    Color *get_data() const { return data; }
+    Color get_pixel(const int x, const int y) const { return data[static_cast<size_t>(y) * width + x]; }
+
+    // y 行目の先頭画素へのポインタ
+    Color *get_row(const int y) const { return data + static_cast<size_t>(y) * width; }
+
+    // セッター
+    void set_pixel(const int x, const int y, const Color &c) const
+    {
+        data[static_cast<size_t>(y) * width + x] = c;
+    }
+};
+
+#endif
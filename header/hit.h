@@ -1,25 +1,31 @@
 #ifndef HIT_H
 #define HIT_H
+#include <type_traits>
 #include "vec3.h"
 
-class Sphere;
+template <typename T>
+class SphereT;
 
-class Hit
+template <typename T>
+class HitT
 {
 private:
-    double distance;
-    Vec3 hit_position;
-    Vec3 hit_normal; // 法線は必ず物体の"外側"を向く仕様とする
-    const Sphere *hit_sphere;
+    T distance;
+    Vec3T<T> hit_position;
+    Vec3T<T> hit_normal; // 法線は必ず物体の"外側"を向く仕様とする
+    const SphereT<T> *hit_sphere;
     bool is_ray_outside_sphere;
 
 public:
-    static constexpr double MAX_DISTANCE{10000.0};
-    static constexpr double MIN_DISTANCE{1e-6};
+    static constexpr T MAX_DISTANCE{10000.0};
+    // 交差とみなす最小の距離（衝突点から出たレイが同じ面と再び交差しないよう，単精度では丸め誤差に合わせて大きくとる）
+    static constexpr T MIN_DISTANCE{std::is_same<T, float>::value ? T(1e-4) : T(1e-6)};
 
-    Hit(double _distance, const Vec3 &_hit_position, const Vec3 &_hit_normal, const Sphere *_hit_sphere, const bool _is_ray_outside_sphere) : distance(_distance), hit_position(_hit_position), hit_normal(_hit_normal.normalize()), hit_sphere(_hit_sphere), is_ray_outside_sphere(_is_ray_outside_sphere) {}
+    HitT(T _distance, const Vec3T<T> &_hit_position, const Vec3T<T> &_hit_normal, const SphereT<T> *_hit_sphere, const bool _is_ray_outside_sphere) : distance(_distance), hit_position(_hit_position), hit_normal(_hit_normal.normalize()), hit_sphere(_hit_sphere), is_ray_outside_sphere(_is_ray_outside_sphere) {}
 
-    Hit operator=(const Hit &h)
+    HitT(const HitT &) = default;
+
+    HitT operator=(const HitT &h)
     {
         distance = h.get_distance();
         hit_position = h.get_hit_position();
@@ -29,22 +35,22 @@ public:
         return *this;
     }
 
-    const double get_distance() const
+    const T get_distance() const
     {
         return distance;
     }
 
-    const Vec3 get_hit_position() const
+    const Vec3T<T> get_hit_position() const
     {
         return hit_position;
     }
 
-    const Vec3 get_hit_normal() const
+    const Vec3T<T> get_hit_normal() const
     {
         return hit_normal;
     }
 
-    const Sphere *get_sphere() const
+    const SphereT<T> *get_sphere() const
     {
         return hit_sphere;
     }
@@ -55,4 +61,6 @@ public:
     }
 };
 
+using Hit = HitT<Real>;
+
 #endif
\ No newline at end of file
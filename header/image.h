@@ -1,118 +1,277 @@
 #ifndef IMAGE_H
 #define IMAGE_H
 
-#include <iostream>
+#include <algorithm>
 #include <climits>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <vector>
+#include "aligned_allocator.h"
 #include "util.h"
 #include "color.h"
+#include "stats.h"
+#include "trace.h"
 #define STB_IMAGE_WRITE_STATIC
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb/stb_image.h"
 #include "stb/stb_image_write.h"
 
+// 2 枚の画像の差（各チャンネルを保存時と同じく [0, 1] に切り詰めた値で比較する）
+struct ImageDifference
+{
+    double mean_absolute_error;
+    double max_absolute_error;
+    double psnr; // ピーク信号対雑音比 [dB]（完全に一致する場合は無限大）
+};
+
 class Image
 {
 private:
     int width;
     int height;
     int channels{3};
-    Color **data;
+    // 画素値を行優先（row-major）で格納する連続領域
+    // 1 回の確保で済み，キャッシュライン境界に揃えて確保する
+    AlignedVector<Color> data;
 
-public:
-    // コンストラクタ
-    Image(int _width, int _height) : width(_width), height(_height)
+    size_t index(int x, int y) const
     {
-        data = new Color *[width];
+        return static_cast<size_t>(y) * width + x;
+    }
+
+    // y 行目の画素を [0~1] から [0~255] に変換して row_pixels に書き込む
+    void quantize_row(const int y, unsigned char *row_pixels) const
+    {
+        const Color *row = data.data() + index(0, y);
         for (int x = 0; x < width; x++)
         {
-            data[x] = new Color[height];
+            unsigned char *pixel = row_pixels + x * channels;
+            pixel[0] = static_cast<unsigned char>(UCHAR_MAX * clamp(row[x].r, Real(0), Real(1)));
+            pixel[1] = static_cast<unsigned char>(UCHAR_MAX * clamp(row[x].g, Real(0), Real(1)));
+            pixel[2] = static_cast<unsigned char>(UCHAR_MAX * clamp(row[x].b, Real(0), Real(1)));
+            // アルファチャンネルを持つ画像は不透明とする
+            for (int channel = 3; channel < channels; channel++)
+            {
+                pixel[channel] = UCHAR_MAX;
+            }
         }
     }
 
-    Image(const char *_filename)
+    // 1 スレッドが担当する最小の行数（これより少ない行を別スレッドに分けてもスレッドの起動に見合わない）
+    static constexpr int PNG_MIN_ROWS_PER_THREAD = 16;
+
+    // [begin, end) 行を 8bit に量子化し，PNG のフィルタをかけて filtered に書き込む
+    // 各行の先頭 1 byte はフィルタの種類であり，フィルタの選び方は stbi_write_png_to_mem と同じ
+    void filter_png_rows(const int begin, const int end, unsigned char *filtered) const
     {
-        float *image;
-        image = stbi_loadf(_filename, &width, &height, &channels, 0);
+        const int row_bytes = width * channels;
+        // 直前の行と現在の行を連続して置く（フィルタは 1 行前の同じ位置の画素を参照する）
+        std::vector<unsigned char> rows(2 * static_cast<size_t>(row_bytes));
+        std::vector<signed char> line_buffer(row_bytes);
+        unsigned char *previous = rows.data();
+        unsigned char *current = rows.data() + row_bytes;
+        if (begin > 0)
+            quantize_row(begin - 1, previous);
 
-        data = new Color *[width];
-        for (int x = 0; x < width; x++)
+        for (int y = begin; y < end; y++)
         {
-            data[x] = new Color[height];
+            quantize_row(y, current);
+            // 先頭の行は直前の行を参照しないフィルタに置き換えられる
+            unsigned char *pixels = y == 0 ? current : previous;
+            const int row_in_pixels = y == 0 ? 0 : 1;
+            int filter_type = stbi_write_force_png_filter;
+            if (filter_type >= 0 && filter_type < 5)
+            {
+                stbiw__encode_png_line(pixels, row_bytes, width, 2, row_in_pixels, channels, filter_type, line_buffer.data());
+            }
+            else
+            {
+                // 各フィルタをかけた行の絶対値の和が最も小さいものを選ぶ
+                int best_estimate = std::numeric_limits<int>::max();
+                for (int candidate = 0; candidate < 5; candidate++)
+                {
+                    stbiw__encode_png_line(pixels, row_bytes, width, 2, row_in_pixels, channels, candidate, line_buffer.data());
+                    int estimate = 0;
+                    for (int i = 0; i < row_bytes; i++)
+                        estimate += std::abs(line_buffer[i]);
+                    if (estimate < best_estimate)
+                    {
+                        best_estimate = estimate;
+                        filter_type = candidate;
+                    }
+                }
+                // 最後に試したフィルタが最良でなければかけ直す
+                if (filter_type != 4)
+                    stbiw__encode_png_line(pixels, row_bytes, width, 2, row_in_pixels, channels, filter_type, line_buffer.data());
+            }
+
+            unsigned char *filtered_row = filtered + static_cast<size_t>(y) * (row_bytes + 1);
+            filtered_row[0] = static_cast<unsigned char>(filter_type);
+            std::copy(line_buffer.begin(), line_buffer.end(), reinterpret_cast<signed char *>(filtered_row + 1));
+            std::copy(current, current + row_bytes, previous);
         }
+    }
+
+    // zlib で圧縮した画素データから PNG ファイルを書き出す（チャンクの構成は stbi_write_png_to_mem と同じ）
+    void write_png_file(const char *output_filepath, const unsigned char *compressed, const int compressed_length) const
+    {
+        static const unsigned char signature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+        static const int color_types[5] = {-1, 0, 4, 2, 6};
+        std::vector<unsigned char> png(8 + 12 + 13 + 12 + compressed_length + 12);
+        unsigned char *o = png.data();
+        std::copy(signature, signature + 8, o);
+        o += 8;
+        stbiw__wp32(o, 13);
+        stbiw__wptag(o, "IHDR");
+        stbiw__wp32(o, width);
+        stbiw__wp32(o, height);
+        *o++ = 8;
+        *o++ = STBIW_UCHAR(color_types[channels]);
+        *o++ = 0;
+        *o++ = 0;
+        *o++ = 0;
+        stbiw__wpcrc(&o, 13);
+
+        stbiw__wp32(o, compressed_length);
+        stbiw__wptag(o, "IDAT");
+        o = std::copy(compressed, compressed + compressed_length, o);
+        stbiw__wpcrc(&o, compressed_length);
+
+        stbiw__wp32(o, 0);
+        stbiw__wptag(o, "IEND");
+        stbiw__wpcrc(&o, 0);
+
+        FILE *file = stbiw__fopen(output_filepath, "wb");
+        if (!file)
+            return;
+        fwrite(png.data(), 1, png.size(), file);
+        fclose(file);
+    }
+
+public:
+    // コンストラクタ
+    Image(int _width, int _height) : width(_width), height(_height), data(static_cast<size_t>(_width) * _height) {}
+
+    Image(const char *_filename)
+    {
+        float *image;
+        image = stbi_loadf(_filename, &width, &height, &channels, 0);
 
-        int index;
-        for (int y = 0; y < height; y++)
+        data.resize(static_cast<size_t>(width) * height);
+        for (size_t i = 0; i < data.size(); i++)
         {
-            for (int x = 0; x < width; x++)
-            {
-                index = channels * x + channels * width * y;
-                data[x][y] = Color(image[index], image[index + 1], image[index + 2]);
-            }
+            data[i] = Color(image[channels * i], image[channels * i + 1], image[channels * i + 2]);
         }
         // 画像読み込み後に解放
         stbi_image_free(image);
     }
 
+    // コピーは画素値を複製し，ムーブは画素領域の所有権を移す
+    Image(const Image &) = default;
+    Image(Image &&) noexcept = default;
+    Image &operator=(const Image &) = default;
+    Image &operator=(Image &&) noexcept = default;
+
     // デストラクタ
     ~Image() {}
 
     // セッタ―
     void set_pixel(int x, int y, const Color &c)
     {
-        data[x][y] = c;
+        data[index(x, y)] = c;
     }
 
     void set_pixel(int x, int y, const double g)
     {
-        data[x][y] = Color(g);
+        data[index(x, y)] = Color(g);
     }
 
     // ゲッター
     int get_width() const { return width; }
     int get_height() const { return height; }
-    Color get_pixel(int x, int y) const { return data[x][y]; }
+    Color get_pixel(int x, int y) const { return data[index(x, y)]; }
+
+    // 画素領域への直接アクセス（行優先で width * height 個の Color が並ぶ）
+    Color *get_data() { return data.data(); }
+    const Color *get_data() const { return data.data(); }
+    size_t get_size() const { return data.size(); }
+
+    // y 行目の先頭画素へのポインタ
+    Color *get_row(int y) { return data.data() + index(0, y); }
+    const Color *get_row(int y) const { return data.data() + index(0, y); }
 
     // ガンマ補正
     void gamma_correction()
     {
-        for (int x = 0; x < width; x++)
+        for (Color &c : data)
         {
-            for (int y = 0; y < height; y++)
-            {
-                Color c = data[x][y];
-                data[x][y] = Color(
-                    std::pow(c.r, 1 / 2.2),
-                    std::pow(c.g, 1 / 2.2),
-                    std::pow(c.b, 1 / 2.2));
-            }
+            c = Color(
+                std::pow(c.r, 1 / 2.2),
+                std::pow(c.g, 1 / 2.2),
+                std::pow(c.b, 1 / 2.2));
         }
     }
 
-    // 画像保存
-    void save_png(const char *output_filepath) const
+    // 同じ大きさの画像 other との差を求める
+    ImageDifference compare(const Image &other) const
     {
-        unsigned char pixels[width * height * channels];
-        // [0~1] を [0~255] に変換
-        for (int x = 0; x < width; x++)
+        if (width != other.width || height != other.height)
+        {
+            throw size_mismatch_exception();
+        }
+
+        double sum_absolute = .0, sum_squared = .0, max_absolute = .0;
+        for (size_t i = 0; i < data.size(); i++)
         {
-            for (int y = 0; y < height; y++)
+            const Color &a = data[i];
+            const Color &b = other.data[i];
+            for (const double d : {clamp(a.r, Real(0), Real(1)) - clamp(b.r, Real(0), Real(1)),
+                                   clamp(a.g, Real(0), Real(1)) - clamp(b.g, Real(0), Real(1)),
+                                   clamp(a.b, Real(0), Real(1)) - clamp(b.b, Real(0), Real(1))})
             {
-                Color c = data[x][y];
-                auto r = clamp(c.r, 0.0, 1.0);
-                auto g = clamp(c.g, 0.0, 1.0);
-                auto b = clamp(c.b, 0.0, 1.0);
-
-                unsigned char ir = static_cast<unsigned char>(UCHAR_MAX * r);
-                unsigned char ig = static_cast<unsigned char>(UCHAR_MAX * g);
-                unsigned char ib = static_cast<unsigned char>(UCHAR_MAX * b);
-
-                pixels[y * (width * channels) + x * (channels) + 0] = ir;
-                pixels[y * (width * channels) + x * (channels) + 1] = ig;
-                pixels[y * (width * channels) + x * (channels) + 2] = ib;
+                sum_absolute += std::abs(d);
+                sum_squared += d * d;
+                max_absolute = std::max(max_absolute, std::abs(d));
             }
         }
-        stbi_write_png(output_filepath, width, height, channels, pixels, width * channels);
+        const double count = 3.0 * data.size();
+        const double mean_squared_error = sum_squared / count;
+        const double psnr = mean_squared_error > 0 ? 10.0 * std::log10(1.0 / mean_squared_error) : std::numeric_limits<double>::infinity();
+        return ImageDifference{sum_absolute / count, max_absolute, psnr};
     }
+
+    // 画像保存
+    // 8bit に量子化した画像全体は確保せず，スレッドごとに直前の行と現在の行だけを量子化し，PNG のフィルタをかけた行を書き込む
+    // フィルタ済みの行は stbi_write_png でも zlib 圧縮の入力として確保される領域であり，出力は stbi_write_png と同じになる
+    void save_png(const char *output_filepath) const
+    {
+        RAYTRACING_STATS_TIMER(save_png_timer);
+        TraceScope trace("save_png", "io");
+        trace.add_arg("path", output_filepath);
+        const size_t filtered_row_bytes = static_cast<size_t>(width) * channels + 1;
+        std::vector<unsigned char> filtered(filtered_row_bytes * height);
+        parallel_for(0, height, PNG_MIN_ROWS_PER_THREAD, [&](const int begin, const int end) {
+            filter_png_rows(begin, end, filtered.data());
+        });
+
+        int compressed_length;
+        unsigned char *compressed = stbi_zlib_compress(filtered.data(), static_cast<int>(filtered.size()), &compressed_length, stbi_write_png_compression_level);
+        if (!compressed)
+            return;
+        write_png_file(output_filepath, compressed, compressed_length);
+        STBIW_FREE(compressed);
+    }
+
+    class size_mismatch_exception
+    {
+    private:
+        const char *msg = "\x1b[31mError : The images to compare have different sizes.\x1b[39m";
+
+    public:
+        size_mismatch_exception() {}
+        const char *get_msg() const { return msg; }
+    };
 };
 
 #endif
\ No newline at end of file
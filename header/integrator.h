@@ -0,0 +1,303 @@
+#ifndef INTEGRATOR_H
+#define INTEGRATOR_H
+
+#include <algorithm>
+#include <optional>
+#include <variant>
+#include <vector>
+#include "aggregate.h"
+#include "camera.h"
+#include "color.h"
+#include "framebuffer.h"
+#include "hit.h"
+#include "material.h"
+#include "material_variant.h"
+#include "ray.h"
+#include "ray_packet.h"
+#include "renderer.h"
+#include "sampler.h"
+#include "sphere.h"
+#include "stats.h"
+
+// マテリアルの関数を呼び出す方法
+enum class MaterialDispatch
+{
+    Virtual, // Material の仮想関数を呼び出す
+    Variant  // MaterialVariant を介して呼び出す（閉じた集合に含まれないマテリアルは仮想関数で呼び出す）
+};
+
+// カメラからのレイを反復的に追跡し，経路の寄与（スループット）を掛け合わせて色を求めるパストレーサ
+// render で描画する場合，カメラからのレイと鏡面で 1 回反射したレイは packet_size 本ずつのパケットで交差判定を行う
+class PathIntegrator
+{
+private:
+    int max_depth;              // 最大バウンス数（これを超えて衝突し続ける経路は黒とする）
+    int russian_roulette_depth; // ロシアンルーレットを開始するバウンス数（負の場合は行わない）
+    MaterialDispatch material_dispatch;
+    int packet_size; // render でのパケットのレイの本数（0 の場合は常に 1 本ずつ交差判定を行う）
+
+    // 衝突した物体のマテリアルで次のレイをサンプリングし，BRDF を返す
+    Color scatter(const Ray &ray, const Hit &hit, SampleStream &random, Ray &next_ray) const
+    {
+        RAYTRACING_STATS_TIMER(sample_ray_timer);
+        const Sphere *sphere = hit.get_sphere();
+        if (material_dispatch == MaterialDispatch::Variant)
+        {
+            if (const MaterialVariant *material = sphere->get_material_variant())
+            {
+                next_ray = sample_ray(*material, ray, hit, random);
+                return get_brdf(*material);
+            }
+        }
+        const Material *material = sphere->get_material();
+        next_ray = material->sample_ray(ray, hit, random);
+        return material->get_brdf();
+    }
+
+    // depth 回目の交差判定の結果 result から経路を 1 段進め，ray と throughput を次のレイのものに更新する
+    // 経路が終了した場合は，その寄与を radiance に格納して false を返す
+    bool advance(Ray &ray, Color &throughput, const std::optional<Hit> &result, const int depth, SampleStream &random, Color &radiance) const
+    {
+        RAYTRACING_STATS_PHASE(Shade);
+        if (!result)
+        {
+            RAYTRACING_STATS_PATHS(depth, 1);
+            radiance = throughput * background(ray);
+            return false;
+        }
+
+        Ray next_ray = ray;
+        throughput *= scatter(ray, *result, random, next_ray);
+        ray = next_ray;
+
+        // 打ち切られなかった経路の寄与を生存確率で割ることで，期待値を変えずに平均経路長を短くする
+        if (russian_roulette_depth >= 0 && depth + 1 >= russian_roulette_depth)
+        {
+            const double p = survival_probability(throughput);
+            if (random.next_double() >= p)
+            {
+                RAYTRACING_STATS_ADD(russian_roulette_terminations, 1);
+                RAYTRACING_STATS_PATHS(depth + 1, 1);
+                radiance = Color(0);
+                return false;
+            }
+            throughput /= p;
+        }
+        return true;
+    }
+
+    // ray を depth 回目の交差判定から追跡し，追跡したレイの本数を num_rays に加える
+    Color trace_from(Ray ray, Color throughput, int depth, const Aggregate &world, SampleStream &random, int &num_rays) const
+    {
+        for (; depth <= max_depth; depth++)
+        {
+            num_rays++;
+            Color radiance;
+            if (!advance(ray, throughput, world.intersect(ray), depth, random, radiance))
+                return radiance;
+        }
+        RAYTRACING_STATS_ADD(depth_limit_terminations, 1);
+        RAYTRACING_STATS_PATHS(max_depth + 1, 1);
+        return Color(0);
+    }
+
+    static bool is_mirror(const Hit &hit)
+    {
+        const MaterialVariant *material = hit.get_sphere()->get_material_variant();
+        return material != nullptr && std::holds_alternative<Mirror>(*material);
+    }
+
+    // ピクセル [x_begin, x_end) x {y} の全サンプルの経路を 1 本ずつ追跡し，radiance[(x - x_begin) * samples_per_pixel + s] に格納する
+    int trace_row(const Renderer &renderer, const Camera &camera, const Aggregate &world, const int y, const int x_begin, const int x_end,
+                  const int samples_per_pixel, Color *radiance) const
+    {
+        int num_rays = 0;
+        const int path_count = (x_end - x_begin) * samples_per_pixel;
+        for (int path = 0; path < path_count; path++)
+        {
+            const int x = x_begin + path / samples_per_pixel;
+            SampleStream random = renderer.make_sample_stream(x, y, path % samples_per_pixel);
+            const Ray ray = camera.get_ray(x, y, random);
+            radiance[path] = trace_from(ray, Color(1), 0, world, random, num_rays);
+        }
+        return num_rays;
+    }
+
+    // trace_row と同じ経路を (ピクセル, サンプル) の順に N 本ずつまとめ，カメラからのレイをパケットで交差判定する
+    // 鏡面で反射したレイは向きが揃っているため，もう 1 段パケットで交差判定し，それ以降は 1 本ずつ追跡する
+    // 経路ごとの SampleStream と演算の順序は trace と同じであり，同じ値となる
+    template <int N>
+    int trace_row_packets(const Renderer &renderer, const Camera &camera, const Aggregate &world, const int y, const int x_begin, const int x_end,
+                          const int samples_per_pixel, Color *radiance) const
+    {
+        RayPacket<N> packet, mirror_packet;
+        std::optional<Hit> hits[N], mirror_hits[N];
+        SampleStream randoms[N];
+        Color mirror_throughputs[N];
+        int mirror_paths[N];
+
+        int num_rays = 0;
+        const int path_count = (x_end - x_begin) * samples_per_pixel;
+        for (int begin = 0; begin < path_count; begin += N)
+        {
+            const int count = std::min(N, path_count - begin);
+            packet.clear();
+            for (int k = 0; k < count; k++)
+            {
+                const int x = x_begin + (begin + k) / samples_per_pixel;
+                randoms[k] = renderer.make_sample_stream(x, y, (begin + k) % samples_per_pixel);
+                packet.add(camera.get_ray(x, y, randoms[k]));
+            }
+            world.intersect(packet, hits);
+            num_rays += count;
+
+            mirror_packet.clear();
+            for (int k = 0; k < count; k++)
+            {
+                Ray ray = packet.get_ray(k);
+                Color throughput(1);
+                if (!advance(ray, throughput, hits[k], 0, randoms[k], radiance[begin + k]))
+                    continue;
+                if (max_depth >= 1 && is_mirror(*hits[k]))
+                {
+                    mirror_paths[mirror_packet.size] = k;
+                    mirror_throughputs[mirror_packet.size] = throughput;
+                    mirror_packet.add(ray);
+                }
+                else
+                {
+                    radiance[begin + k] = trace_from(ray, throughput, 1, world, randoms[k], num_rays);
+                }
+            }
+            if (mirror_packet.size == 0)
+                continue;
+
+            world.intersect(mirror_packet, mirror_hits);
+            num_rays += mirror_packet.size;
+            for (int m = 0; m < mirror_packet.size; m++)
+            {
+                const int k = mirror_paths[m];
+                Ray ray = mirror_packet.get_ray(m);
+                if (advance(ray, mirror_throughputs[m], mirror_hits[m], 1, randoms[k], radiance[begin + k]))
+                    radiance[begin + k] = trace_from(ray, mirror_throughputs[m], 2, world, randoms[k], num_rays);
+            }
+        }
+        return num_rays;
+    }
+
+    int trace_row_dispatch(const Renderer &renderer, const Camera &camera, const Aggregate &world, const int y, const int x_begin, const int x_end,
+                           const int samples_per_pixel, Color *radiance) const
+    {
+        // BVH を構築していない場合はパケットでも 1 本ずつ判定するため，パケットを用いない
+        switch (world.is_built() && max_depth >= 0 ? packet_size : 0)
+        {
+        case 4:
+            return trace_row_packets<4>(renderer, camera, world, y, x_begin, x_end, samples_per_pixel, radiance);
+        case 8:
+            return trace_row_packets<8>(renderer, camera, world, y, x_begin, x_end, samples_per_pixel, radiance);
+        case 16:
+            return trace_row_packets<16>(renderer, camera, world, y, x_begin, x_end, samples_per_pixel, radiance);
+        default:
+            return trace_row(renderer, camera, world, y, x_begin, x_end, samples_per_pixel, radiance);
+        }
+    }
+
+public:
+    static constexpr int DEFAULT_MAX_DEPTH{10};
+    static constexpr int DEFAULT_RUSSIAN_ROULETTE_DEPTH{3};
+    // パケットの本数は SIMD のレーン数によらず 8 とする（RayPacket はレーン数の倍数または約数であればよく，8 は 1 ~ 8 レーンの全てで使える）
+    static constexpr int DEFAULT_PACKET_SIZE{8};
+
+    // コンストラクタ
+    // packet_size には 0（パケットを用いない），4，8，16 のいずれかを指定する
+    PathIntegrator(
+        const int _max_depth = DEFAULT_MAX_DEPTH,
+        const int _russian_roulette_depth = DEFAULT_RUSSIAN_ROULETTE_DEPTH,
+        const MaterialDispatch _material_dispatch = MaterialDispatch::Variant,
+        const int _packet_size = DEFAULT_PACKET_SIZE)
+        : max_depth(_max_depth),
+          russian_roulette_depth(_russian_roulette_depth),
+          material_dispatch(_material_dispatch),
+          packet_size(_packet_size)
+    {
+        if (_packet_size != 0 && _packet_size != 4 && _packet_size != 8 && _packet_size != 16)
+        {
+            throw packet_size_exception();
+        }
+    }
+
+    // ゲッター
+    int get_max_depth() const { return max_depth; }
+    int get_russian_roulette_depth() const { return russian_roulette_depth; }
+    MaterialDispatch get_material_dispatch() const { return material_dispatch; }
+    int get_packet_size() const { return packet_size; }
+
+    // どの物体とも衝突しなかったレイの色（空の色）
+    static Color background(const Ray &r)
+    {
+        auto t = 0.5 * (r.get_direction().y + 1.0);
+        return (1.0 - t) * Color(1) + t * Color(0.5, 0.7, 1.0);
+    }
+
+    // ロシアンルーレットで経路を継続する確率
+    // スループットが小さい（暗い）経路ほど早く打ち切る
+    static double survival_probability(const Color &throughput)
+    {
+        return std::min<double>(1.0, std::max(throughput.r, std::max(throughput.g, throughput.b)));
+    }
+
+    // camera_ray の方向から届く光の色を求める
+    Color trace(const Ray &camera_ray, const Aggregate &world, SampleStream &random) const
+    {
+        int num_rays;
+        return trace(camera_ray, world, random, num_rays);
+    }
+
+    // 追跡したレイの本数（交差判定の回数）を num_rays に返す
+    Color trace(const Ray &camera_ray, const Aggregate &world, SampleStream &random, int &num_rays) const
+    {
+        num_rays = 0;
+        return trace_from(camera_ray, Color(1), 0, world, random, num_rays);
+    }
+
+    // カメラから 1 ピクセルあたり samples_per_pixel 本の経路を追跡し，平均をカメラの画像に書き込む
+    // Renderer::render に trace を渡した場合と同じ画像となり，追跡したレイの本数（trace が num_rays に返す値の全サンプルの和）を返す
+    // タイルの各行の経路を packet_size 本ずつまとめ，カメラからのレイと鏡面で 1 回反射したレイをパケットで交差判定する
+    long long render(Renderer &renderer, Camera &camera, const int samples_per_pixel, const Aggregate &world) const
+    {
+        std::vector<long long> worker_rays(renderer.get_num_threads(), 0);
+        const FrameBufferView framebuffer = camera.get_framebuffer();
+        renderer.render_tiles(framebuffer, [&](const Tile &tile, const int worker_id)
+                              {
+                                  std::vector<Color> radiance(static_cast<size_t>(tile.x_end - tile.x_begin) * samples_per_pixel);
+                                  for (int y = tile.y_begin; y < tile.y_end; y++)
+                                  {
+                                      worker_rays[worker_id] += trace_row_dispatch(renderer, camera, world, y, tile.x_begin, tile.x_end, samples_per_pixel, radiance.data());
+                                      Color *row = framebuffer.get_row(y);
+                                      for (int x = tile.x_begin; x < tile.x_end; x++)
+                                      {
+                                          const Color *samples = &radiance[static_cast<size_t>(x - tile.x_begin) * samples_per_pixel];
+                                          Color pixel_color(0);
+                                          for (int s = 0; s < samples_per_pixel; s++)
+                                              pixel_color += samples[s];
+                                          row[x] = pixel_color / samples_per_pixel;
+                                      }
+                                  } });
+        long long num_rays = 0;
+        for (const long long n : worker_rays)
+            num_rays += n;
+        return num_rays;
+    }
+
+    class packet_size_exception
+    {
+    private:
+        const char *msg = "\x1b[31mError : The packet size of the integrator must be 0, 4, 8 or 16.\x1b[39m";
+
+    public:
+        packet_size_exception() {}
+        const char *get_msg() const { return msg; }
+    };
+};
+
+#endif
@@ -6,12 +6,19 @@
 #include "color.h"
 #include "ray.h"
 #include "hit.h"
+#include "sampler.h"
 #include "util.h"
 
 class Material
 {
 public:
-    virtual Ray sample_ray(const Ray &incident_ray, const Hit &hit) const = 0;
+    // 入射レイ incident_ray が hit で衝突した際の反射・屈折レイを，random から次元の順に取り出した値を用いてサンプリングする
+    virtual Ray sample_ray(const Ray &incident_ray, const Hit &hit, SampleStream &random) const = 0;
+
+    Ray sample_ray(const Ray &incident_ray, const Hit &hit) const
+    {
+        return sample_ray(incident_ray, hit, thread_local_sample_stream());
+    }
 
     virtual Color get_brdf() const = 0;
 };
@@ -24,19 +31,20 @@ private:
 public:
     Lambertian(const Color &_albedo) : albedo(_albedo) {}
 
-    Ray sample_ray(const Ray &incident_ray, const Hit &hit) const override
+    using Material::sample_ray;
+
+    Ray sample_ray(const Ray &incident_ray, const Hit &hit, SampleStream &random) const override
     {
-        Vec3 random_vector_on_sphere = spherical_to_cartesian(generate_random_in_range(0.0, M_PI), generate_random_in_range(0.0, 2 * M_PI));
-        if (dot(hit.get_hit_normal(), random_vector_on_sphere) > 0)
-        {
-            // random_vector_on_sphere が normal と同じ半球（反射ベクトル）である場合
-            return Ray(hit.get_hit_position(), random_vector_on_sphere);
-        }
-        else
-        {
-            // random_vector_on_sphere が normal と異なる半球（屈折ベクトル）である場合
-            return Ray(hit.get_hit_position(), -random_vector_on_sphere);
-        }
+        // 法線を軸とする半球上で cos(theta) に比例する密度の方向をサンプリングする（Malley の方法）
+        // 単位円板上の一様な点を半球に持ち上げる．密度が cos(theta) / π であるため，レイの重みはアルベドのみとなる
+        const double radius_squared = random.next_double();
+        const double phi = 2 * M_PI * random.next_double();
+        const double radius = sqrt(radius_squared);
+        const Vec3 normal = hit.get_hit_normal();
+        Vec3 tangent, bitangent;
+        make_orthonormal_basis(normal, tangent, bitangent);
+        const Vec3 direction = Real(radius * cos(phi)) * tangent + Real(radius * sin(phi)) * bitangent + Real(sqrt(1.0 - radius_squared)) * normal;
+        return Ray::from_normalized(hit.get_hit_position(), direction);
     }
 
     Color get_brdf() const override
@@ -59,7 +67,9 @@ private:
 public:
     Mirror(const Color &_albedo) : albedo(_albedo) {}
 
-    Ray sample_ray(const Ray &incident_ray, const Hit &hit) const override
+    using Material::sample_ray;
+
+    Ray sample_ray(const Ray &incident_ray, const Hit &hit, SampleStream &) const override
     {
         return Ray(hit.get_hit_position(), mirror_reflect(incident_ray.get_direction(), hit.get_hit_normal()));
     }
@@ -92,7 +102,9 @@ private:
 public:
     Glass(const double _refractive_index) : refractive_index(_refractive_index) {}
 
-    Ray sample_ray(const Ray &incident_ray, const Hit &hit) const override
+    using Material::sample_ray;
+
+    Ray sample_ray(const Ray &incident_ray, const Hit &hit, SampleStream &) const override
     {
         double cos_theta = dot(-incident_ray.get_direction(), hit.get_hit_normal());
         double sin_theta = sqrt(1 - cos_theta * cos_theta);
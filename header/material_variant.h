@@ -0,0 +1,54 @@
+#ifndef MATERIAL_VARIANT_H
+#define MATERIAL_VARIANT_H
+
+#include <optional>
+#include <type_traits>
+#include <typeinfo>
+#include <variant>
+#include "color.h"
+#include "hit.h"
+#include "material.h"
+#include "ray.h"
+#include "sampler.h"
+
+// 閉じたマテリアル集合を値として保持する型
+// std::visit による分岐で具象クラスの関数を修飾名で直接呼び出すため，仮想関数呼び出しを介さずにインライン展開できる
+using MaterialVariant = std::variant<Lambertian, Mirror, Glass>;
+
+// 入射レイ incident_ray が hit で衝突した際の反射・屈折レイをサンプリングする
+inline Ray sample_ray(const MaterialVariant &material, const Ray &incident_ray, const Hit &hit, SampleStream &random)
+{
+    return std::visit([&](const auto &m)
+                      {
+                          using Concrete = std::decay_t<decltype(m)>;
+                          return m.Concrete::sample_ray(incident_ray, hit, random); },
+                      material);
+}
+
+inline Color get_brdf(const MaterialVariant &material)
+{
+    return std::visit([](const auto &m)
+                      {
+                          using Concrete = std::decay_t<decltype(m)>;
+                          return m.Concrete::get_brdf(); },
+                      material);
+}
+
+// Material 階層のオブジェクトを MaterialVariant に変換する
+// 動的な型が集合内の型と一致する場合のみ変換し，それ以外（利用者が独自に派生させたクラスや，
+// Lambertian などをさらに派生させたクラス）の場合は nullopt を返す
+inline std::optional<MaterialVariant> to_material_variant(const Material *material)
+{
+    if (material == nullptr)
+        return std::nullopt;
+    const std::type_info &type = typeid(*material);
+    if (type == typeid(Lambertian))
+        return MaterialVariant(static_cast<const Lambertian &>(*material));
+    if (type == typeid(Mirror))
+        return MaterialVariant(static_cast<const Mirror &>(*material));
+    if (type == typeid(Glass))
+        return MaterialVariant(static_cast<const Glass &>(*material));
+    return std::nullopt;
+}
+
+#endif
@@ -0,0 +1,296 @@
+#ifndef PACKED_SPHERES_H
+#define PACKED_SPHERES_H
+
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "aligned_allocator.h"
+#include "hit.h"
+#include "material.h"
+#include "ray.h"
+#include "ray_packet.h"
+#include "simd.h"
+#include "sphere.h"
+
+// 球の形状とマテリアル番号を成分ごとの配列（Structure of Arrays）として保持する
+// 1 本のレイと SimdReal::LANES 個の球との交差判定を 1 命令でまとめて行う
+// 球の番号は Real の値としてレーンに格納するため，単精度では 2^24 個未満とする
+class PackedSpheres
+{
+private:
+    // 単精度では，球から遠い始点（半径 1000 の地面の中心など）について |oc|^2 - r^2 を計算すると桁落ちし，
+    // 球面上から出たレイが自身と交差したと誤判定する
+    // そのため，中心と半径の代わりに原点に最も近い球面上の点 p（基準点），p から見た中心 a = p - center，
+    // |a|^2 - r^2 を保持し，c = |o - p|^2 + 2 (o - p)・a + |a|^2 - r^2 として始点の近くで計算する
+    static constexpr bool USE_REFERENCE_POINT{std::is_same_v<Real, float>};
+    // 倍精度 : 中心の x, y, z 成分と半径
+    // 単精度 : 基準点の x, y, z 成分，a の x, y, z 成分，|a|^2 - r^2
+    static constexpr int NUM_FIELDS{USE_REFERENCE_POINT ? 7 : 4};
+
+    AlignedVector<Real> fields[NUM_FIELDS];
+    AlignedVector<int> material_index;
+    std::vector<const Sphere *> spheres;
+    std::vector<const Material *> materials; // material_index が指すマテリアルの一覧
+    std::unordered_map<const Material *, int> material_ids; // マテリアルから materials での番号を引く表
+
+    // SimdReal::LANES 個の球の形状
+    struct SphereLanes
+    {
+        SimdReal v[NUM_FIELDS];
+    };
+
+    // 末尾のレーンを読み込んでも配列外を参照しないよう，常に LANES 個分の余白を確保する
+    void update_padding()
+    {
+        const size_t padded_size = spheres.size() + SimdReal::LANES;
+        for (AlignedVector<Real> &field : fields)
+            field.resize(padded_size, Real(0));
+    }
+
+    // index 番目から LANES 個の球を読み込む
+    SphereLanes load(const int index) const
+    {
+        SphereLanes lanes;
+        for (int f = 0; f < NUM_FIELDS; f++)
+            lanes.v[f] = SimdReal::load(&fields[f][index]);
+        return lanes;
+    }
+
+    // index 番目の球を全レーンに複製する
+    SphereLanes broadcast(const int index) const
+    {
+        SphereLanes lanes;
+        for (int f = 0; f < NUM_FIELDS; f++)
+            lanes.v[f] = SimdReal(fields[f][index]);
+        return lanes;
+    }
+
+    // 始点 o・方向 d の各レーンのレイと各レーンの球との交差判定
+    // 距離の判定は Sphere::intersect と同じ規則（MIN_DISTANCE, MAX_DISTANCE, 接する場合の扱い）に従い，交差したレーンのマスクを返す
+    static SimdReal intersect_lanes(const SimdReal o[3], const SimdReal d[3], const SphereLanes &sphere, SimdReal &distance)
+    {
+        const SimdReal min_distance(Hit::MIN_DISTANCE), neg_min_distance(-Hit::MIN_DISTANCE), max_hit_distance(Hit::MAX_DISTANCE);
+        const SimdReal zero(Real(0));
+
+        SimdReal b, D, neg_b, d1, d2;
+        if constexpr (USE_REFERENCE_POINT)
+        {
+            const SimdReal ex = o[0] - sphere.v[0];
+            const SimdReal ey = o[1] - sphere.v[1];
+            const SimdReal ez = o[2] - sphere.v[2];
+            const SimdReal &ax = sphere.v[3], &ay = sphere.v[4], &az = sphere.v[5];
+
+            b = d[0] * ex + d[1] * ey + d[2] * ez + (d[0] * ax + d[1] * ay + d[2] * az);
+            const SimdReal e_dot_a = ex * ax + ey * ay + ez * az;
+            const SimdReal c = ex * ex + ey * ey + ez * ez + (e_dot_a + e_dot_a) + sphere.v[6];
+            D = b * b - c;
+            const SimdReal sqrt_D = sqrt(max(D, zero));
+            neg_b = zero - b;
+            // 絶対値の小さい方の解は，桁落ちを避けて c / q（q は絶対値の大きい方の解）から求める
+            const SimdReal q = select(b < zero, neg_b + sqrt_D, neg_b - sqrt_D);
+            const SimdReal other = c / q;
+            d1 = min(q, other);
+            d2 = max(q, other);
+        }
+        else
+        {
+            const SimdReal ocx = o[0] - sphere.v[0];
+            const SimdReal ocy = o[1] - sphere.v[1];
+            const SimdReal ocz = o[2] - sphere.v[2];
+            const SimdReal &r = sphere.v[3];
+
+            b = d[0] * ocx + d[1] * ocy + d[2] * ocz;
+            const SimdReal c = ocx * ocx + ocy * ocy + ocz * ocz - r * r;
+            D = b * b - c;
+            const SimdReal sqrt_D = sqrt(max(D, zero));
+            neg_b = zero - b;
+            d1 = neg_b - sqrt_D;
+            d2 = neg_b + sqrt_D;
+        }
+
+        // D = 0 の場合は接する
+        const SimdReal is_tangent = (D >= neg_min_distance) & (D <= min_distance);
+        // D > 0 の場合は手前側の交点を優先する
+        const SimdReal d1_valid = (d1 > min_distance) & (d1 < max_hit_distance);
+        const SimdReal d2_valid = (d2 > min_distance) & (d2 < max_hit_distance);
+        distance = select(d1_valid, d1, d2);
+        distance = select(is_tangent, neg_b, distance);
+        return is_tangent | ((D > min_distance) & (d1_valid | d2_valid));
+    }
+
+public:
+    PackedSpheres() {}
+    PackedSpheres(const std::vector<const Sphere *> &_spheres)
+    {
+        for (const Sphere *sphere : _spheres)
+        {
+            add(sphere);
+        }
+    }
+
+    void clear()
+    {
+        for (AlignedVector<Real> &field : fields)
+            field.clear();
+        material_index.clear();
+        spheres.clear();
+        materials.clear();
+        material_ids.clear();
+    }
+
+    // 物体の追加
+    void add(const Sphere *sphere)
+    {
+        const size_t index = spheres.size();
+        spheres.push_back(sphere);
+        update_padding();
+        const Vec3 center = sphere->get_center();
+        const Real radius = sphere->get_radius();
+        if constexpr (USE_REFERENCE_POINT)
+        {
+            // 基準点とその値は倍精度で求めてから丸める（中心が原点の場合は +y 方向の点とする）
+            const Vec3T<double> c(center);
+            const double r = radius;
+            const double distance = c.norm();
+            const Vec3T<double> towards_origin = distance > 0 ? -c / distance : Vec3T<double>(0, 1, 0);
+            const Vec3 reference(c + r * towards_origin);
+            const Vec3 a(Vec3T<double>(reference) - c);
+            const Vec3T<double> a_rounded(a);
+            fields[0][index] = reference.x;
+            fields[1][index] = reference.y;
+            fields[2][index] = reference.z;
+            fields[3][index] = a.x;
+            fields[4][index] = a.y;
+            fields[5][index] = a.z;
+            fields[6][index] = static_cast<Real>(dot(a_rounded, a_rounded) - r * r);
+        }
+        else
+        {
+            fields[0][index] = center.x;
+            fields[1][index] = center.y;
+            fields[2][index] = center.z;
+            fields[3][index] = radius;
+        }
+
+        // 同じマテリアルを共有する球には同じ番号を割り当てる
+        // 一覧を線形に探すと球の数 × マテリアルの数に比例する時間がかかるため，ハッシュ表で番号を引く
+        const Material *material = sphere->get_material();
+        const auto [it, inserted] = material_ids.emplace(material, static_cast<int>(materials.size()));
+        if (inserted)
+            materials.push_back(material);
+        material_index.push_back(it->second);
+    }
+
+    // ゲッター
+    size_t size() const { return spheres.size(); }
+    const Sphere *get_sphere(const int index) const { return spheres[index]; }
+    int get_material_index(const int index) const { return material_index[index]; }
+    const Material *get_material(const int material_id) const { return materials[material_id]; }
+    size_t get_num_materials() const { return materials.size(); }
+
+    // [begin, end) の球のうち，レイと max_distance より手前で交差する最も近い球を探す
+    // 見つかった場合は closest_index と closest_distance を更新して true を返す
+    // (距離, 番号) の順序で (after_distance, after_index) 以下の球は除外する（Sphere::intersect に棄却された球の次を探すため）
+    bool find_closest(const Ray &ray, const int begin, const int end, const Real max_distance, int &closest_index, Real &closest_distance,
+                      const Real after_distance = -std::numeric_limits<Real>::infinity(), const int after_index = -1) const
+    {
+        const Vec3 origin = ray.get_origin();
+        const Vec3 direction = ray.get_direction();
+        const SimdReal o[3] = {SimdReal(origin.x), SimdReal(origin.y), SimdReal(origin.z)};
+        const SimdReal d[3] = {SimdReal(direction.x), SimdReal(direction.y), SimdReal(direction.z)};
+        const SimdReal end_index(static_cast<Real>(end));
+        const SimdReal after_d(after_distance), after_i(static_cast<Real>(after_index));
+
+        SimdReal best_distance(max_distance);
+        SimdReal best_index(Real(-1));
+
+        for (int i = begin; i < end; i += SimdReal::LANES)
+        {
+            const SimdReal index = SimdReal::iota(static_cast<Real>(i));
+            SimdReal distance;
+            const SimdReal is_hit = intersect_lanes(o, d, load(i), distance) & (index < end_index);
+            const SimdReal is_after = (distance > after_d) | ((distance >= after_d) & (index > after_i));
+            const SimdReal is_closer = is_hit & is_after & (distance < best_distance);
+            best_distance = select(is_closer, distance, best_distance);
+            best_index = select(is_closer, index, best_index);
+        }
+
+        // 各レーンの結果から最も近いものを選ぶ（距離が等しい場合は番号の小さい方）
+        Real distances[SimdReal::LANES], indices[SimdReal::LANES];
+        best_distance.store(distances);
+        best_index.store(indices);
+        bool found = false;
+        for (int lane = 0; lane < SimdReal::LANES; lane++)
+        {
+            if (indices[lane] < 0)
+                continue;
+            const int index = static_cast<int>(indices[lane]);
+            if (!found || distances[lane] < closest_distance || (distances[lane] == closest_distance && index < closest_index))
+            {
+                closest_index = index;
+                closest_distance = distances[lane];
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    // [begin, end) の球とパケット内のレイとの交差判定を行い，各レイの closest_index と closest_distance を更新する
+    // ray_mask のビットが立ったレーンのうち，直前のノード判定で交差した（node_hit が 1 の）レイのみを更新する
+    // 1 つの球の値を全レーンに複製し，SimdReal::LANES 本のレイをまとめて判定する（距離の規則は find_closest と同じ）
+    template <int N>
+    void find_closest(RayPacket<N> &packet, const int begin, const int end, const int ray_mask) const
+    {
+        constexpr int GROUP_MASK = (1 << SimdReal::LANES) - 1;
+        const SimdReal zero(Real(0));
+
+        for (int g = 0; g < N; g += SimdReal::LANES)
+        {
+            if (((ray_mask >> g) & GROUP_MASK) == 0)
+                continue;
+
+            const SimdReal o[3] = {SimdReal::load(&packet.origin[0][g]), SimdReal::load(&packet.origin[1][g]), SimdReal::load(&packet.origin[2][g])};
+            const SimdReal d[3] = {SimdReal::load(&packet.direction[0][g]), SimdReal::load(&packet.direction[1][g]), SimdReal::load(&packet.direction[2][g])};
+            const SimdReal is_active = SimdReal::load(&packet.node_hit[g]) > zero;
+            SimdReal best_distance = SimdReal::load(&packet.closest_distance[g]);
+            SimdReal best_index = SimdReal::load(&packet.closest_index[g]);
+
+            for (int i = begin; i < end; i++)
+            {
+                SimdReal distance;
+                const SimdReal is_hit = intersect_lanes(o, d, broadcast(i), distance);
+                const SimdReal is_closer = is_active & is_hit & (distance < best_distance);
+                best_distance = select(is_closer, distance, best_distance);
+                best_index = select(is_closer, SimdReal(static_cast<Real>(i)), best_index);
+            }
+
+            best_distance.store(&packet.closest_distance[g]);
+            best_index.store(&packet.closest_index[g]);
+        }
+    }
+
+    // 与えられたレイと全ての球との間で衝突計算を行い，最も手前に存在する球との衝突情報を返す
+    // 衝突情報は最も近い球の Sphere::intersect から生成するため，総当たりの場合と同じ値となる
+    // 単精度ではカーネルと Sphere::intersect の計算が異なり，かすめる球がカーネルでのみ交差と判定されることがあるため，
+    // Sphere::intersect に棄却された場合はその次に近い球を探し直す
+    std::optional<Hit> intersect(const Ray &ray) const
+    {
+        Real after_distance = -std::numeric_limits<Real>::infinity();
+        int after_index = -1;
+        while (true)
+        {
+            int closest_index;
+            Real closest_distance;
+            if (!find_closest(ray, 0, static_cast<int>(size()), std::numeric_limits<Real>::infinity(), closest_index, closest_distance, after_distance, after_index))
+                return std::nullopt;
+            if (std::optional<Hit> hit = spheres[closest_index]->intersect(ray))
+                return hit;
+            after_distance = closest_distance;
+            after_index = closest_index;
+        }
+    }
+};
+
+#endif
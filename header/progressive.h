@@ -0,0 +1,111 @@
+#ifndef PROGRESSIVE_H
+#define PROGRESSIVE_H
+
+#include <algorithm>
+#include <chrono>
+#include "accumulation_buffer.h"
+#include "adaptive_sampler.h"
+#include "camera.h"
+#include "renderer.h"
+#include "trace.h"
+
+// 1 パスを終えた時点での進捗
+struct ProgressivePass
+{
+    int pass;                 // パスの番号（0 から）
+    int samples_per_pixel;    // これまでに追跡した 1 ピクセルあたりのサンプル数
+    double elapsed_seconds;   // 描画開始からの経過時間
+    double relative_error;    // AccumulationBuffer::get_mean_relative_error の値
+};
+
+// 全ピクセルに少数のサンプルを加えるパスを繰り返し，パスごとに現在の推定値をカメラの画像に書き込む
+// 最初のパスは 1 サンプルとしてすぐにプレビューを得られるようにし，以降はパスごとにサンプル数を倍にして max_samples_per_pass まで増やす
+// max_samples に達するか，時間の予算・ノイズの目標を満たした時点で終える
+class ProgressiveRenderer
+{
+private:
+    int max_samples;          // 1 ピクセルあたりのサンプル数の上限
+    int max_samples_per_pass; // 1 パスで追加するサンプル数の上限
+    double time_budget;       // 描画時間の予算 [s]（0 以下の場合は制限しない）
+    double noise_target;      // 相対誤差の目標（0 以下の場合は制限しない）
+
+public:
+    static constexpr int DEFAULT_MAX_SAMPLES_PER_PASS{16};
+
+    // コンストラクタ
+    ProgressiveRenderer(const int _max_samples, const double _time_budget = 0, const double _noise_target = 0,
+                        const int _max_samples_per_pass = DEFAULT_MAX_SAMPLES_PER_PASS)
+        : max_samples(_max_samples), max_samples_per_pass(_max_samples_per_pass), time_budget(_time_budget), noise_target(_noise_target)
+    {
+        if (_max_samples < 1 || _max_samples_per_pass < 1)
+        {
+            throw sample_count_exception();
+        }
+    }
+
+    // ゲッター
+    int get_max_samples() const { return max_samples; }
+    int get_max_samples_per_pass() const { return max_samples_per_pass; }
+    double get_time_budget() const { return time_budget; }
+    double get_noise_target() const { return noise_target; }
+
+    // accumulation に ray_color(ray, random) のサンプルをパスごとに加え，各パスの後に on_pass(pass) を呼び出す
+    // on_pass の時点で camera の画像は現在の推定値となっている
+    // 各ピクセルの k 本目のサンプルは固定サンプル数の Renderer::render と同じ乱数を用いるため，max_samples に達した場合は同じ画像となる
+    template <typename RayColorFunction, typename PassCallback>
+    ProgressivePass render(Renderer &renderer, Camera &camera, AccumulationBuffer &accumulation, const RayColorFunction &ray_color,
+                           const PassCallback &on_pass) const
+    {
+        const auto begin = std::chrono::steady_clock::now();
+        auto elapsed = [&]()
+        { return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count(); };
+
+        ProgressivePass progress{-1, 0, .0, .0};
+        int samples_per_pass = 1;
+        double seconds_per_sample = .0;
+        while (progress.samples_per_pixel < max_samples)
+        {
+            const int target = std::min(max_samples, progress.samples_per_pixel + samples_per_pass);
+            // 次のパスが残り時間に収まらないと見込まれる場合は，最初のパスを除いて打ち切る
+            if (progress.pass >= 0 && time_budget > 0 && progress.elapsed_seconds + seconds_per_sample * (target - progress.samples_per_pixel) > time_budget)
+                break;
+
+            // 全ピクセルのサンプル数を target に揃える
+            {
+                TraceScope trace("pass", "progressive");
+                trace.add_arg("pass", progress.pass + 1);
+                trace.add_arg("samples_per_pixel", target);
+                renderer.render(camera, AdaptiveSampler(target, target, .0), accumulation, ray_color);
+            }
+
+            const double seconds = elapsed();
+            seconds_per_sample = (seconds - progress.elapsed_seconds) / (target - progress.samples_per_pixel);
+            progress = ProgressivePass{progress.pass + 1, target, seconds, accumulation.get_mean_relative_error()};
+            on_pass(progress);
+
+            // 1 サンプルでは分散を求められないため，ノイズの判定は 2 サンプル以上で行う
+            if (noise_target > 0 && target >= 2 && progress.relative_error <= noise_target)
+                break;
+            samples_per_pass = std::min(2 * samples_per_pass, max_samples_per_pass);
+        }
+        return progress;
+    }
+
+    template <typename RayColorFunction>
+    ProgressivePass render(Renderer &renderer, Camera &camera, AccumulationBuffer &accumulation, const RayColorFunction &ray_color) const
+    {
+        return render(renderer, camera, accumulation, ray_color, [](const ProgressivePass &) {});
+    }
+
+    class sample_count_exception
+    {
+    private:
+        const char *msg = "\x1b[31mError : The sample counts of the progressive renderer are set less than 1.\x1b[39m";
+
+    public:
+        sample_count_exception() {}
+        const char *get_msg() const { return msg; }
+    };
+};
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <atomic>
+#include <cstdint>
+
+// PCG32 (XSH-RR) 擬似乱数生成器
+// 64bit の状態を持ち，ロックを必要としないためスレッドごとに独立したインスタンスを持たせて利用する
+class Pcg32
+{
+private:
+    uint64_t state;
+    uint64_t increment; // 系列（ストリーム）を選択する奇数
+
+    static constexpr uint64_t MULTIPLIER{6364136223846793005ULL};
+
+public:
+    static constexpr uint64_t DEFAULT_SEED{0x853c49e6748fea9bULL};
+    static constexpr uint64_t DEFAULT_STREAM{0xda3e39cb94b95bdbULL};
+
+    // コンストラクタ
+    Pcg32(const uint64_t _seed = DEFAULT_SEED, const uint64_t _stream = DEFAULT_STREAM)
+    {
+        seed(_seed, _stream);
+    }
+
+    // 初期状態 seed と系列 stream から状態を初期化する
+    void seed(const uint64_t _seed, const uint64_t _stream = DEFAULT_STREAM)
+    {
+        state = 0u;
+        increment = (_stream << 1u) | 1u;
+        next_uint();
+        state += _seed;
+        next_uint();
+    }
+
+    // 32bit の一様乱数を生成
+    uint32_t next_uint()
+    {
+        const uint64_t old_state = state;
+        state = old_state * MULTIPLIER + increment;
+        const uint32_t xorshifted = static_cast<uint32_t>(((old_state >> 18u) ^ old_state) >> 27u);
+        const uint32_t rotation = static_cast<uint32_t>(old_state >> 59u);
+        return (xorshifted >> rotation) | (xorshifted << ((-rotation) & 31u));
+    }
+
+    // [0, 1) の一様乱数を生成
+    double next_double()
+    {
+        return next_uint() * (1.0 / 4294967296.0);
+    }
+};
+
+// 64bit 値を攪拌する（SplitMix64 の最終段）
+inline uint64_t mix_bits(uint64_t v)
+{
+    v ^= v >> 30;
+    v *= 0xbf58476d1ce4e5b9ULL;
+    v ^= v >> 27;
+    v *= 0x94d049bb133111ebULL;
+    v ^= v >> 31;
+    return v;
+}
+
+// ピクセル座標・サンプル番号・フレーム番号から乱数生成器を初期化する
+// 同じ (pixel, sample, frame) からは，どのスレッドで計算しても同じ乱数列が得られる
+inline Pcg32 make_sample_random(const int pixel_x, const int pixel_y, const int sample, const int frame = 0)
+{
+    const uint64_t pixel = (static_cast<uint64_t>(static_cast<uint32_t>(pixel_y)) << 32) | static_cast<uint32_t>(pixel_x);
+    const uint64_t index = (static_cast<uint64_t>(static_cast<uint32_t>(frame)) << 32) | static_cast<uint32_t>(sample);
+    return Pcg32(mix_bits(pixel + mix_bits(index)), mix_bits(index));
+}
+
+// スレッドごとに独立した乱数生成器（シーン構築など，ピクセルに紐付かない乱数に用いる）
+// 最初に呼び出したスレッドは既定の系列，以降のスレッドは呼び出した順に異なる系列を用いるため，スレッド間で乱数列が重ならない
+inline Pcg32 &thread_local_random()
+{
+    static std::atomic<uint64_t> next_stream{0};
+    thread_local Pcg32 random = [] {
+        const uint64_t stream = next_stream.fetch_add(1, std::memory_order_relaxed);
+        return Pcg32(Pcg32::DEFAULT_SEED, stream == 0 ? Pcg32::DEFAULT_STREAM : mix_bits(Pcg32::DEFAULT_STREAM + stream));
+    }();
+    return random;
+}
+
+#endif
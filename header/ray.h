@@ -4,43 +4,55 @@
 #include <iostream>
 #include "vec3.h"
 
-class Ray
+template <typename T>
+class RayT
 {
 private:
     // レイの始点座標
-    const Vec3 origin;
+    Vec3T<T> origin;
     // レイの方向
-    const Vec3 direction;
+    Vec3T<T> direction;
 
 public:
     // コンストラクタ
     // レイの方向ベクトルは，正規化（単位ベクトル）して格納
-    Ray(const Vec3 &_origin, const Vec3 &_direction)
+    RayT(const Vec3T<T> &_origin, const Vec3T<T> &_direction)
         : origin(_origin), direction(_direction.normalize()) {}
 
+    // 正規化済みの方向ベクトルからレイを生成する
+    // 成分ごとに保存したレイを復元する際に，再度の正規化で値が変わらないようにする
+    static RayT from_normalized(const Vec3T<T> &_origin, const Vec3T<T> &_normalized_direction)
+    {
+        RayT r(_origin, _normalized_direction);
+        r.direction = _normalized_direction;
+        return r;
+    }
+
     // ゲッター
-    Vec3 get_origin() const
+    Vec3T<T> get_origin() const
     {
         return origin;
     }
 
-    Vec3 get_direction() const
+    Vec3T<T> get_direction() const
     {
         return direction;
     }
 
     // r = o + t * d
-    Vec3 operator()(double t) const
+    Vec3T<T> operator()(T t) const
     {
         return origin + t * direction;
     }
 
     // コンソール出力
-    inline friend std::ostream &operator<<(std::ostream &stream, const Ray &r)
+    inline friend std::ostream &operator<<(std::ostream &stream, const RayT &r)
     {
         stream << "origin    : " << r.origin << "\ndirection : " << r.direction;
         return stream;
     }
 };
 
+using Ray = RayT<Real>;
+
 #endif
\ No newline at end of file
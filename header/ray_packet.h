@@ -0,0 +1,107 @@
+#ifndef RAY_PACKET_H
+#define RAY_PACKET_H
+
+#include "aabb.h"
+#include "hit.h"
+#include "ray.h"
+#include "simd.h"
+#include "vec3.h"
+
+// 始点・方向の近い N 本のレイを成分ごとの配列としてまとめたもの（N = 4, 8, 16）
+// BVH のノードや球との交差判定を SimdReal::LANES 本ずつまとめて行う
+// 末尾の使われないレーンは探索範囲を負とすることで，どの物体とも交差しない非アクティブなレイとして扱う
+// N がレーン数より少ない場合（単精度の AVX で N = 4 など）は，配列をレーン数まで非アクティブなレーンで埋める
+template <int N>
+struct RayPacket
+{
+    static_assert(N > 0 && N <= 16 && (N % SimdReal::LANES == 0 || SimdReal::LANES % N == 0), "RayPacket size must be a multiple or a divisor of SimdReal::LANES up to 16");
+    static constexpr int SIZE{N};
+    static constexpr int CAPACITY{N < SimdReal::LANES ? SimdReal::LANES : N};
+
+    alignas(64) Real origin[3][CAPACITY];
+    alignas(64) Real direction[3][CAPACITY];
+    alignas(64) Real inverse_direction[3][CAPACITY];
+    alignas(64) Real closest_distance[CAPACITY]; // 見つかった最も近い衝突までの距離（探索範囲の上限）
+    alignas(64) Real closest_index[CAPACITY];    // 最も近い球の番号（見つからない場合は -1）
+    alignas(64) Real node_hit[CAPACITY];         // 直前に判定したノードとの交差結果（1 : 交差，0 : 交差しない）
+    int size;                                    // アクティブなレイの本数
+
+    RayPacket() { clear(); }
+
+    // 全てのレーンを非アクティブにする
+    void clear()
+    {
+        size = 0;
+        for (int i = 0; i < CAPACITY; i++)
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                origin[axis][i] = .0;
+                direction[axis][i] = axis == 2 ? 1.0 : .0;
+                inverse_direction[axis][i] = axis == 2 ? 1.0 : .0;
+            }
+            closest_distance[i] = -1.0;
+            closest_index[i] = -1.0;
+            node_hit[i] = .0;
+        }
+    }
+
+    bool is_full() const { return size == N; }
+
+    // アクティブなレイを持つレーンのビットマスク
+    int get_active_mask() const { return (1 << size) - 1; }
+
+    void add(const Ray &ray)
+    {
+        const Vec3 o = ray.get_origin();
+        const Vec3 d = ray.get_direction();
+        for (int axis = 0; axis < 3; axis++)
+        {
+            origin[axis][size] = o[axis];
+            direction[axis][size] = d[axis];
+            inverse_direction[axis][size] = Real(1) / d[axis];
+        }
+        closest_distance[size] = Hit::MAX_DISTANCE;
+        closest_index[size] = -1.0;
+        size++;
+    }
+
+    Ray get_ray(const int i) const
+    {
+        return Ray::from_normalized(Vec3(origin[0][i], origin[1][i], origin[2][i]), Vec3(direction[0][i], direction[1][i], direction[2][i]));
+    }
+
+    int get_closest_index(const int i) const { return static_cast<int>(closest_index[i]); }
+
+    // スラブ法による全てのレイとノードとの交差判定
+    // AABB::intersect と同じ規則で [0, closest_distance] の範囲と交差するかを node_hit に格納し，交差したレーンのビットマスクを返す
+    int intersect(const AABB &box)
+    {
+        int mask = 0;
+        const SimdReal zero(Real(0)), one(Real(1));
+        for (int g = 0; g < N; g += SimdReal::LANES)
+        {
+            SimdReal t0 = zero;
+            SimdReal t1 = SimdReal::load(&closest_distance[g]);
+            for (int axis = 0; axis < 3; axis++)
+            {
+                const SimdReal o = SimdReal::load(&origin[axis][g]);
+                const SimdReal inv = SimdReal::load(&inverse_direction[axis][g]);
+                const SimdReal t_lower = (SimdReal(box.lower[axis]) - o) * inv;
+                const SimdReal t_upper = (SimdReal(box.upper[axis]) - o) * inv;
+                // NaN（0 * inf）の場合は比較が偽となり，範囲を狭めない
+                const SimdReal is_swapped = t_lower > t_upper;
+                const SimdReal t_near = select(is_swapped, t_upper, t_lower);
+                const SimdReal t_far = select(is_swapped, t_lower, t_upper);
+                t0 = select(t_near > t0, t_near, t0);
+                t1 = select(t_far < t1, t_far, t1);
+            }
+            const SimdReal is_hit = t0 <= t1;
+            select(is_hit, one, zero).store(&node_hit[g]);
+            mask |= is_hit.movemask() << g;
+        }
+        return mask;
+    }
+};
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef REAL_H
+#define REAL_H
+
+// 描画に用いる浮動小数点型
+// Vec3・Color・Ray・Hit・Sphere はスカラー型のテンプレート（Vec3T など）であり，Vec3 などはこの型で実体化したもの
+// 交差判定の SIMD カーネル（PackedSpheres・RayPacket）と BVH もこの型で計算する
+// RAYTRACING_SINGLE_PRECISION を定義してビルドすると単精度（float）で描画する（既定は倍精度で，テストは倍精度で行う）
+#if defined(RAYTRACING_SINGLE_PRECISION)
+using Real = float;
+#else
+using Real = double;
+#endif
+
+#endif
@@ -0,0 +1,211 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "accumulation_buffer.h"
+#include "adaptive_sampler.h"
+#include "camera.h"
+#include "color.h"
+#include "framebuffer.h"
+#include "image.h"
+#include "random.h"
+#include "ray.h"
+#include "sampler.h"
+#include "scheduler.h"
+#include "stats.h"
+#include "trace.h"
+
+// 画像を分割した矩形領域 [x_begin, x_end) x [y_begin, y_end)
+struct Tile
+{
+    int x_begin, y_begin;
+    int x_end, y_end;
+};
+
+class Renderer
+{
+private:
+    int num_threads;
+    int tile_size;
+    int frame{0}; // 乱数の初期化に用いるフレーム番号
+    std::shared_ptr<const Sampler> sampler; // サンプルの値を決める標本列（nullptr の場合は独立な乱数）
+    std::vector<WorkerStats> worker_stats; // 直前のレンダリングにおけるワーカーごとの稼働統計
+
+    template <typename PixelColorFunction>
+    static void render_tile(const FrameBufferView &framebuffer, const Tile &tile, const PixelColorFunction &pixel_color)
+    {
+        for (int y = tile.y_begin; y < tile.y_end; y++)
+        {
+            Color *row = framebuffer.get_row(y);
+            for (int x = tile.x_begin; x < tile.x_end; x++)
+            {
+                row[x] = pixel_color(x, y);
+            }
+        }
+    }
+
+public:
+    static constexpr int DEFAULT_TILE_SIZE{16};
+
+    // コンストラクタ
+    // スレッド数に 0 以下を指定した場合は，ハードウェアの並列数を用いる
+    Renderer(const int _num_threads = 0, const int _tile_size = DEFAULT_TILE_SIZE) : num_threads(_num_threads), tile_size(_tile_size)
+    {
+        if (_tile_size <= 0)
+        {
+            throw tile_size_exception();
+        }
+        if (num_threads <= 0)
+        {
+            num_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        }
+    }
+
+    // ゲッター
+    int get_num_threads() const { return num_threads; }
+    int get_tile_size() const { return tile_size; }
+    int get_frame() const { return frame; }
+    const std::shared_ptr<const Sampler> &get_sampler() const { return sampler; }
+    const std::vector<WorkerStats> &get_worker_stats() const { return worker_stats; }
+
+    // セッター
+    void set_frame(const int _frame) { frame = _frame; }
+    void set_sampler(const std::shared_ptr<const Sampler> &_sampler) { sampler = _sampler; }
+
+    // ピクセル (x, y) の sample 番目のサンプルが値を取り出す SampleStream
+    SampleStream make_sample_stream(const int x, const int y, const int sample) const
+    {
+        return ::make_sample_stream(x, y, sample, frame, sampler.get());
+    }
+
+    // 直前のレンダリングにおけるワーカーごとの稼働統計を出力
+    void print_worker_stats(std::ostream &stream = std::cout) const
+    {
+        for (size_t worker_id = 0; worker_id < worker_stats.size(); worker_id++)
+        {
+            stream << "worker " << worker_id << " : " << worker_stats[worker_id] << "\n";
+        }
+    }
+
+    // 画像を tile_size 四方のタイルに分割する（右端・下端のタイルは画像内に収まるよう切り詰める）
+    std::vector<Tile> split_into_tiles(const int width, const int height) const
+    {
+        std::vector<Tile> tiles;
+        for (int y = 0; y < height; y += tile_size)
+        {
+            for (int x = 0; x < width; x += tile_size)
+            {
+                tiles.push_back(Tile{x, y, std::min(x + tile_size, width), std::min(y + tile_size, height)});
+            }
+        }
+        return tiles;
+    }
+
+    // 各ピクセルの色を pixel_color(x, y) で計算し，タイル単位で複数スレッドに分配して framebuffer に直接書き込む
+    // タイルごとの計算量の偏りは，ワークスティーリングによって実行時に平準化する
+    template <typename PixelColorFunction>
+    void render(const FrameBufferView &framebuffer, const PixelColorFunction &pixel_color)
+    {
+        render_tiles(framebuffer, [&](const Tile &tile, const int)
+                     { render_tile(framebuffer, tile, pixel_color); });
+    }
+
+    // framebuffer をタイルに分割し，各タイルについて tile_function(tile, worker_id) を複数スレッドで呼び出す
+    // worker_id は [0, num_threads) の範囲で，ワーカーごとの作業領域を使い回すのに用いる
+    template <typename TileFunction>
+    void render_tiles(const FrameBufferView &framebuffer, const TileFunction &tile_function)
+    {
+        const std::vector<Tile> tiles = split_into_tiles(framebuffer.get_width(), framebuffer.get_height());
+        const int worker_count = std::max(1, std::min(num_threads, static_cast<int>(tiles.size())));
+        TraceScope trace("render", "render");
+        trace.add_arg("width", framebuffer.get_width());
+        trace.add_arg("height", framebuffer.get_height());
+        trace.add_arg("tiles", static_cast<long long>(tiles.size()));
+        trace.add_arg("threads", worker_count);
+
+        // タイルごとの処理を，ワーカーごとの行に記録する
+        WorkStealingScheduler scheduler(worker_count);
+        scheduler.run(static_cast<int>(tiles.size()), [&](const int task, const int worker_id)
+                      {
+                          TraceScope tile_trace("tile", "render", worker_id + 1);
+                          tile_trace.add_arg("x", tiles[task].x_begin);
+                          tile_trace.add_arg("y", tiles[task].y_begin);
+                          tile_function(tiles[task], worker_id); });
+        worker_stats = scheduler.get_worker_stats();
+        RAYTRACING_STATS_REPORT("render " + std::to_string(framebuffer.get_width()) + "x" + std::to_string(framebuffer.get_height()) + ", " + std::to_string(worker_count) + " threads");
+    }
+
+    template <typename PixelColorFunction>
+    void render(Image &image, const PixelColorFunction &pixel_color)
+    {
+        render(FrameBufferView(image), pixel_color);
+    }
+
+    // カメラから 1 ピクセルあたり samples_per_pixel 本のレイを飛ばし，ray_color(ray, random) の平均をカメラの画像に書き込む
+    // サンプルの値は (pixel, sample, frame) と標本列から決まるため，スレッド数によらず同じ画像が得られる
+    template <typename RayColorFunction>
+    void render(Camera &camera, const int samples_per_pixel, const RayColorFunction &ray_color)
+    {
+        render(camera.get_framebuffer(), [&](const int x, const int y)
+        {
+            Color pixel_color(0);
+            for (int s = 0; s < samples_per_pixel; s++)
+            {
+                SampleStream random = make_sample_stream(x, y, s);
+                Ray r = camera.get_ray(x, y, random);
+                pixel_color += ray_color(r, random);
+            }
+            return pixel_color / samples_per_pixel;
+        });
+    }
+
+    // ピクセルごとのサンプル数を sampler で決めながらカメラからレイを飛ばし，ray_color(ray, random) を accumulation に加える
+    // accumulation に既にサンプルがある場合はその続きの番号から追跡し，最後に各ピクセルの平均をカメラの画像に書き込む
+    // 各ピクセルの k 本目のサンプルは固定サンプル数の render と同じ乱数を用いるため，全ピクセルが max_samples 本に達した場合は同じ画像となる
+    template <typename RayColorFunction>
+    void render(Camera &camera, const AdaptiveSampler &sampler, AccumulationBuffer &accumulation, const RayColorFunction &ray_color)
+    {
+        const FrameBufferView framebuffer = camera.get_framebuffer();
+        if (framebuffer.get_width() != accumulation.get_width() || framebuffer.get_height() != accumulation.get_height())
+        {
+            throw AccumulationBuffer::size_mismatch_exception();
+        }
+        render_tiles(framebuffer, [&](const Tile &tile, const int)
+        {
+            for (int y = tile.y_begin; y < tile.y_end; y++)
+            {
+                Color *row = framebuffer.get_row(y);
+                for (int x = tile.x_begin; x < tile.x_end; x++)
+                {
+                    PixelStatistics &pixel = accumulation.get_pixel(x, y);
+                    for (int batch = sampler.get_next_batch(pixel); batch > 0; batch = sampler.get_next_batch(pixel))
+                    {
+                        for (int i = 0; i < batch; i++)
+                        {
+                            SampleStream random = make_sample_stream(x, y, pixel.count);
+                            Ray r = camera.get_ray(x, y, random);
+                            pixel.add(ray_color(r, random));
+                        }
+                    }
+                    row[x] = pixel.get_mean();
+                }
+            }
+        });
+    }
+
+    class tile_size_exception
+    {
+    private:
+        const char *msg = "\x1b[31mError : The tile size of the renderer is set less than or equal to 0.\x1b[39m";
+
+    public:
+        tile_size_exception() {}
+        const char *get_msg() const { return msg; }
+    };
+};
+
+#endif
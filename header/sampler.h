@@ -0,0 +1,389 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "random.h"
+
+// ピクセル座標・サンプル番号・次元から [0, 1) の値を決める標本列
+// カメラのピクセル内の位置（2 次元）・レンズ上の位置（2 次元）・反射方向（1 バウンスあたり 2 次元）などが，
+// 1 つの経路の中で消費する順に 0, 1, 2, ... 次元目の値を受け取る
+class Sampler
+{
+public:
+    virtual ~Sampler() {}
+
+    // ピクセル (pixel_x, pixel_y) の sample 番目のサンプルの dimension 次元目の値
+    virtual double get(const int pixel_x, const int pixel_y, const int sample, const int dimension) const = 0;
+
+    // この標本列で与える次元数（これ以降の次元は SampleStream の独立な乱数を用いる）
+    virtual int get_dimensions() const = 0;
+
+protected:
+    static uint32_t hash(const uint64_t a, const uint64_t b = 0, const uint64_t c = 0)
+    {
+        return static_cast<uint32_t>(mix_bits(a + mix_bits(b + mix_bits(c))));
+    }
+
+    static double to_unit(const uint32_t x)
+    {
+        return x * (1.0 / 4294967296.0);
+    }
+};
+
+// 1 つの経路が消費する値を次元の順に取り出すカーソル
+// 標本列が与えない次元と，標本列を指定しない場合は，(pixel, sample, frame) から初期化した PCG32 の乱数を用いる
+class SampleStream
+{
+private:
+    Pcg32 random;
+    const Sampler *sampler{nullptr};
+    int pixel_x{0}, pixel_y{0};
+    int sample{0};
+    int dimension{0}; // 次に取り出す次元
+
+public:
+    // コンストラクタ
+    SampleStream(const uint64_t _seed = Pcg32::DEFAULT_SEED, const uint64_t _stream = Pcg32::DEFAULT_STREAM) : random(_seed, _stream) {}
+    explicit SampleStream(const Pcg32 &_random, const Sampler *_sampler = nullptr, const int _pixel_x = 0, const int _pixel_y = 0, const int _sample = 0)
+        : random(_random), sampler(_sampler), pixel_x(_pixel_x), pixel_y(_pixel_y), sample(_sample) {}
+
+    // ゲッター
+    const Sampler *get_sampler() const { return sampler; }
+    int get_dimension() const { return dimension; }
+
+    // 次の次元の [0, 1) の値
+    double next_double()
+    {
+        const int d = dimension++;
+        if (sampler != nullptr && d < sampler->get_dimensions())
+            return sampler->get(pixel_x, pixel_y, sample, d);
+        return random.next_double();
+    }
+};
+
+// ピクセル座標・サンプル番号・フレーム番号から，sampler を用いる SampleStream を初期化する（sampler が nullptr の場合は独立な乱数のみ）
+inline SampleStream make_sample_stream(const int pixel_x, const int pixel_y, const int sample, const int frame = 0, const Sampler *sampler = nullptr)
+{
+    return SampleStream(make_sample_random(pixel_x, pixel_y, sample, frame), sampler, pixel_x, pixel_y, sample);
+}
+
+// スレッドごとに独立した SampleStream（ピクセルに紐付かない呼び出しに用いる）
+// thread_local_random と同じく，スレッドごとに異なる PCG32 のストリームを割り当てる（最初のスレッドは既定のストリーム）
+inline SampleStream &thread_local_sample_stream()
+{
+    static std::atomic<uint64_t> next_stream{0};
+    thread_local SampleStream stream = []
+    {
+        const uint64_t stream_index = next_stream.fetch_add(1, std::memory_order_relaxed);
+        return SampleStream(Pcg32::DEFAULT_SEED, stream_index == 0 ? Pcg32::DEFAULT_STREAM : mix_bits(Pcg32::DEFAULT_STREAM + stream_index));
+    }();
+    return stream;
+}
+
+// 全ての次元で独立な一様乱数を用いる（ホワイトノイズ）
+// SampleStream では PCG32 の乱数をそのまま用いるため，標本列を指定しない場合と同じ画像となる
+class IndependentSampler final : public Sampler
+{
+public:
+    double get(const int pixel_x, const int pixel_y, const int sample, const int dimension) const override
+    {
+        const uint64_t pixel = (static_cast<uint64_t>(static_cast<uint32_t>(pixel_y)) << 32) | static_cast<uint32_t>(pixel_x);
+        const uint64_t index = (static_cast<uint64_t>(static_cast<uint32_t>(dimension)) << 32) | static_cast<uint32_t>(sample);
+        return to_unit(hash(pixel, index));
+    }
+
+    int get_dimensions() const override { return 0; }
+};
+
+// Owen スクランブルを施した Sobol 列（Burley, "Practical Hash-based Owen Scrambling", 2020）
+// 4 次元の Sobol 列を 4 次元ごとに異なるシードでサンプル番号を並べ替えて繋げ（パディング），各次元の値をハッシュによる Owen スクランブルで攪拌する
+// 2 のべき乗個のサンプルごとに各 2 次元の組が (0, m, 2)-ネットとなり，ピクセル間は独立となる
+class SobolSampler final : public Sampler
+{
+private:
+    static constexpr int SOBOL_DIMENSIONS{4};
+    static constexpr int MAX_DIMENSIONS{1024};
+    uint32_t seed;
+
+    // Joe & Kuo の原始多項式と初期方向数から求めた 4 次元分の方向数
+    static const std::array<std::array<uint32_t, 32>, SOBOL_DIMENSIONS> &get_directions()
+    {
+        static const std::array<std::array<uint32_t, 32>, SOBOL_DIMENSIONS> directions = []()
+        {
+            // {次数 s, 係数 a, 初期方向数 m}（0 次元目は van der Corput 列）
+            const struct
+            {
+                int s;
+                uint32_t a;
+                uint32_t m[3];
+            } polynomials[SOBOL_DIMENSIONS - 1] = {{1, 0, {1}}, {2, 1, {1, 3}}, {3, 1, {1, 3, 1}}};
+
+            std::array<std::array<uint32_t, 32>, SOBOL_DIMENSIONS> v{};
+            for (int i = 0; i < 32; i++)
+                v[0][i] = 1u << (31 - i);
+            for (int d = 1; d < SOBOL_DIMENSIONS; d++)
+            {
+                const int s = polynomials[d - 1].s;
+                const uint32_t a = polynomials[d - 1].a;
+                for (int i = 0; i < 32; i++)
+                {
+                    if (i < s)
+                    {
+                        v[d][i] = polynomials[d - 1].m[i] << (31 - i);
+                        continue;
+                    }
+                    v[d][i] = v[d][i - s] ^ (v[d][i - s] >> s);
+                    for (int k = 1; k < s; k++)
+                        v[d][i] ^= ((a >> (s - 1 - k)) & 1u) * v[d][i - k];
+                }
+            }
+            return v;
+        }();
+        return directions;
+    }
+
+    static uint32_t sobol(uint32_t index, const int dimension)
+    {
+        const std::array<uint32_t, 32> &v = get_directions()[dimension];
+        uint32_t x = 0;
+        for (int bit = 0; index != 0; bit++, index >>= 1)
+        {
+            if (index & 1u)
+                x ^= v[bit];
+        }
+        return x;
+    }
+
+    static uint32_t reverse_bits(uint32_t x)
+    {
+        x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+        x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+        x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+        x = ((x >> 8) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8);
+        return (x >> 16) | (x << 16);
+    }
+
+    // 下位ビットの値が上位ビットにのみ影響する置換（Laine & Karras）
+    static uint32_t laine_karras_permutation(uint32_t x, const uint32_t seed)
+    {
+        x += seed;
+        x ^= x * 0x6c50b47cu;
+        x ^= x * 0xb82f1e52u;
+        x ^= x * 0xc7afe638u;
+        x ^= x * 0x8d22f6e6u;
+        return x;
+    }
+
+public:
+    // 上位ビットから順に，それより上位のビットのみに依存して反転させる（Owen スクランブル）
+    static uint32_t nested_uniform_scramble(const uint32_t x, const uint32_t seed)
+    {
+        return reverse_bits(laine_karras_permutation(reverse_bits(x), seed));
+    }
+
+    // サンプル番号 index のシード seed で攪拌した dimension 次元目の値（ピクセルによらない）
+    static uint32_t scrambled_sobol(const uint32_t index, const int dimension, const uint32_t seed)
+    {
+        const uint32_t group_seed = static_cast<uint32_t>(mix_bits(seed + mix_bits(dimension / SOBOL_DIMENSIONS)));
+        const uint32_t shuffled_index = nested_uniform_scramble(index, group_seed);
+        return nested_uniform_scramble(sobol(shuffled_index, dimension % SOBOL_DIMENSIONS), static_cast<uint32_t>(mix_bits(group_seed + dimension)));
+    }
+
+    // コンストラクタ
+    SobolSampler(const uint32_t _seed = 0) : seed(_seed) {}
+
+    double get(const int pixel_x, const int pixel_y, const int sample, const int dimension) const override
+    {
+        return to_unit(scrambled_sobol(static_cast<uint32_t>(sample), dimension, hash(seed, static_cast<uint32_t>(pixel_x), static_cast<uint32_t>(pixel_y))));
+    }
+
+    int get_dimensions() const override { return MAX_DIMENSIONS; }
+};
+
+// 次元ごとに異なる素数を基数とする Halton 列
+// ピクセル・次元ごとにハッシュで決めたずらし量を各桁に加えて（桁ごとのスクランブル），ピクセル間の相関をなくす
+class HaltonSampler final : public Sampler
+{
+private:
+    static constexpr int PRIMES[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53};
+    static constexpr int MAX_DIMENSIONS{sizeof(PRIMES) / sizeof(PRIMES[0])};
+    static constexpr double ONE_MINUS_EPSILON{0x1.fffffffffffffp-1};
+    uint32_t seed;
+
+public:
+    // コンストラクタ
+    HaltonSampler(const uint32_t _seed = 0) : seed(_seed) {}
+
+    // 各桁に digit_seed から決めた量を基数を法として加えた，基数 base の根基逆関数
+    static double scrambled_radical_inverse(uint32_t index, const int base, const uint32_t digit_seed)
+    {
+        const double inverse_base = 1.0 / base;
+        double weight = inverse_base;
+        double result = .0;
+        // 2^-32 程度の精度まで桁を求める（index を使い切った後の 0 の桁もずらす）
+        for (int k = 0; weight > 1.0 / 4294967296.0; k++)
+        {
+            const uint32_t digit = index % base;
+            index /= base;
+            const uint32_t shift = static_cast<uint32_t>(mix_bits(digit_seed + mix_bits(k)) % base);
+            result += ((digit + shift) % base) * weight;
+            weight *= inverse_base;
+        }
+        return std::min(result, ONE_MINUS_EPSILON);
+    }
+
+    double get(const int pixel_x, const int pixel_y, const int sample, const int dimension) const override
+    {
+        const uint32_t digit_seed = hash(seed, (static_cast<uint64_t>(static_cast<uint32_t>(pixel_y)) << 32) | static_cast<uint32_t>(pixel_x), dimension);
+        return scrambled_radical_inverse(static_cast<uint32_t>(sample), PRIMES[dimension], digit_seed);
+    }
+
+    int get_dimensions() const override { return MAX_DIMENSIONS; }
+};
+
+// 全ピクセルで共通の Owen スクランブル Sobol 列を，ブルーノイズのタイルから決めたピクセルごとの量だけ [0, 1) 上で回転させる
+// （Georgiev & Fajardo, "Blue-noise Dithered Sampling", 2016）
+// 隣り合うピクセルの値が似ないため，少ないサンプル数での誤差が高周波のノイズとなり目立ちにくい
+class BlueNoiseSampler final : public Sampler
+{
+public:
+    static constexpr int TILE_SIZE{64};
+
+private:
+    static constexpr int MAX_DIMENSIONS{1024};
+    uint32_t seed;
+
+    // void-and-cluster 法（Ulichney, 1993）で TILE_SIZE 四方のタイルの各画素に 0 ~ TILE_SIZE^2 - 1 の順位を付ける
+    static std::vector<uint16_t> make_tile()
+    {
+        const int n = TILE_SIZE * TILE_SIZE;
+        const double sigma = 1.9;
+
+        // 周期境界でのガウス関数
+        std::vector<double> kernel(n);
+        for (int dy = 0; dy < TILE_SIZE; dy++)
+        {
+            for (int dx = 0; dx < TILE_SIZE; dx++)
+            {
+                const int x = std::min(dx, TILE_SIZE - dx);
+                const int y = std::min(dy, TILE_SIZE - dy);
+                kernel[dy * TILE_SIZE + dx] = std::exp(-(x * x + y * y) / (2 * sigma * sigma));
+            }
+        }
+        auto splat = [&](std::vector<double> &energy, const int p, const double sign)
+        {
+            const int px = p % TILE_SIZE, py = p / TILE_SIZE;
+            for (int y = 0; y < TILE_SIZE; y++)
+            {
+                const double *row = &kernel[((y - py + TILE_SIZE) % TILE_SIZE) * TILE_SIZE];
+                for (int x = 0; x < TILE_SIZE; x++)
+                    energy[y * TILE_SIZE + x] += sign * row[(x - px + TILE_SIZE) % TILE_SIZE];
+            }
+        };
+        // 最も密な点（エネルギー最大の 1）と最も大きな空隙（エネルギー最小の 0）
+        auto tightest_cluster = [&](const std::vector<char> &pattern, const std::vector<double> &energy)
+        {
+            int best = -1;
+            for (int p = 0; p < n; p++)
+                if (pattern[p] && (best < 0 || energy[p] > energy[best]))
+                    best = p;
+            return best;
+        };
+        auto largest_void = [&](const std::vector<char> &pattern, const std::vector<double> &energy)
+        {
+            int best = -1;
+            for (int p = 0; p < n; p++)
+                if (!pattern[p] && (best < 0 || energy[p] < energy[best]))
+                    best = p;
+            return best;
+        };
+
+        // 初期パターン : 1 割の画素をランダムに選び，最も密な点を最も大きな空隙へ移すことを収束まで繰り返す
+        std::vector<char> pattern(n, 0);
+        std::vector<double> energy(n, .0);
+        Pcg32 random(0x5eed);
+        int ones = 0;
+        while (ones < n / 10)
+        {
+            const int p = static_cast<int>(random.next_uint() % n);
+            if (!pattern[p])
+            {
+                pattern[p] = 1;
+                splat(energy, p, 1.0);
+                ones++;
+            }
+        }
+        while (true)
+        {
+            const int cluster = tightest_cluster(pattern, energy);
+            pattern[cluster] = 0;
+            splat(energy, cluster, -1.0);
+            const int hole = largest_void(pattern, energy);
+            pattern[hole] = 1;
+            splat(energy, hole, 1.0);
+            if (hole == cluster)
+                break;
+        }
+
+        std::vector<uint16_t> rank(n);
+        // 初期パターンの点を密な順に取り除き，大きい順位から付ける
+        {
+            std::vector<char> prototype = pattern;
+            std::vector<double> prototype_energy = energy;
+            for (int r = ones - 1; r >= 0; r--)
+            {
+                const int cluster = tightest_cluster(prototype, prototype_energy);
+                prototype[cluster] = 0;
+                splat(prototype_energy, cluster, -1.0);
+                rank[cluster] = static_cast<uint16_t>(r);
+            }
+        }
+        // 残りの画素は最も大きな空隙から埋め，小さい順位から付ける
+        // （半分を超えた後の「0 の最も密な点」は 1 のエネルギーが最小の 0 と一致するため，同じ操作で求まる）
+        for (int r = ones; r < n; r++)
+        {
+            const int hole = largest_void(pattern, energy);
+            pattern[hole] = 1;
+            splat(energy, hole, 1.0);
+            rank[hole] = static_cast<uint16_t>(r);
+        }
+        return rank;
+    }
+
+public:
+    // 全インスタンスで共有するブルーノイズのタイル（初回の呼び出しで生成する）
+    static const std::vector<uint16_t> &get_tile()
+    {
+        static const std::vector<uint16_t> tile = make_tile();
+        return tile;
+    }
+
+    // コンストラクタ
+    BlueNoiseSampler(const uint32_t _seed = 0) : seed(_seed) { get_tile(); }
+
+    // タイルの (x, y) の値（周期的に繰り返す）を [0, 1) に写したもの
+    static double get_tile_value(const int x, const int y)
+    {
+        const int tx = ((x % TILE_SIZE) + TILE_SIZE) % TILE_SIZE;
+        const int ty = ((y % TILE_SIZE) + TILE_SIZE) % TILE_SIZE;
+        return (get_tile()[ty * TILE_SIZE + tx] + 0.5) / (TILE_SIZE * TILE_SIZE);
+    }
+
+    double get(const int pixel_x, const int pixel_y, const int sample, const int dimension) const override
+    {
+        // 次元ごとにタイルをずらし，次元間の相関をなくす
+        const uint32_t offset = hash(seed, dimension, 0xb1);
+        const double rotation = get_tile_value(pixel_x + static_cast<int>(offset % TILE_SIZE), pixel_y + static_cast<int>((offset >> 16) % TILE_SIZE));
+        const double value = to_unit(SobolSampler::scrambled_sobol(static_cast<uint32_t>(sample), dimension, seed)) + rotation;
+        return value < 1.0 ? value : value - 1.0;
+    }
+
+    int get_dimensions() const override { return MAX_DIMENSIONS; }
+};
+
+#endif
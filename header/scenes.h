@@ -0,0 +1,102 @@
+#ifndef SCENES_H
+#define SCENES_H
+
+#include <cmath>
+#include <memory>
+#include "aggregate.h"
+#include "color.h"
+#include "material.h"
+#include "random.h"
+#include "sphere.h"
+#include "util.h"
+#include "vec3.h"
+
+// 各章のプログラム・テスト・ベンチマークで共通して用いるシーンの配置
+// いずれも物体を追加するのみで，BVH の構築（Aggregate::build）は呼び出し側で行う
+
+// 02・03 の配置：マテリアルを持たない球を地面の上に 1 つ置く
+inline void add_sphere_on_ground(Aggregate &world)
+{
+    world.add(std::make_shared<Sphere>(Vec3(0, 0, -1), 0.5));
+    world.add(std::make_shared<Sphere>(Vec3(0, -100.5, -1), 100));
+}
+
+// 04-01 の配置：拡散反射の球 1 つと鏡面の球 2 つを地面に並べる
+inline void add_material_spheres(Aggregate &world)
+{
+    world.add(std::make_shared<MaterializedSphere>(Vec3(0, 0, -1), 0.5, std::make_shared<Lambertian>(Color(0.7, 0.3, 0.3))));
+    world.add(std::make_shared<MaterializedSphere>(Vec3(1, 0, -1), 0.5, std::make_shared<Mirror>(Color(0.8, 0.6, 0.2))));
+    world.add(std::make_shared<MaterializedSphere>(Vec3(-1, 0, -1), 0.5, std::make_shared<Mirror>(Color(0.8))));
+    world.add(std::make_shared<MaterializedSphere>(Vec3(0, -100.5, -1), 100, std::make_shared<Lambertian>(Color(0.8, 0.8, 0.0))));
+}
+
+// 04-02・05-02・05-03 の配置：拡散反射・鏡面・ガラスの球を 1 つずつ地面に並べる
+inline void add_three_spheres(Aggregate &world)
+{
+    world.add(std::make_shared<MaterializedSphere>(Vec3(0, 0, -1), 0.5, std::make_shared<Lambertian>(Color(0.1, 0.2, 0.5))));
+    world.add(std::make_shared<MaterializedSphere>(Vec3(1, 0, -1), 0.5, std::make_shared<Mirror>(Color(0.8, 0.6, 0.2))));
+    world.add(std::make_shared<MaterializedSphere>(Vec3(-1, 0, -1), 0.5, std::make_shared<Glass>(1.5)));
+    world.add(std::make_shared<MaterializedSphere>(Vec3(0, -100.5, -1), 100, std::make_shared<Lambertian>(Color(0.8, 0.8, 0.0))));
+}
+
+// 05-01 の配置：視野角 90 度のカメラの視野の端に接する青と赤の球を左右に置く
+inline void add_fov_spheres(Aggregate &world)
+{
+    const double radius = cos(M_PI / 4);
+    world.add(std::make_shared<MaterializedSphere>(Vec3(-radius, 0, -1), radius, std::make_shared<Lambertian>(Color(0, 0, 1))));
+    world.add(std::make_shared<MaterializedSphere>(Vec3(radius, 0, -1), radius, std::make_shared<Lambertian>(Color(1, 0, 0))));
+}
+
+// 10 の配置で小さな球を決める乱数のシード（src/10_last_seen.cpp とベンチマークの既定値で共有し，同じシーンとする）
+constexpr uint64_t LAST_SEEN_SEED{1};
+
+// 10 の配置：大きな球 3 つの周りに小さな球を敷き詰める（小さな球の位置とマテリアルは random で決める）
+template <typename Random>
+void add_last_seen_spheres(Aggregate &world, Random &random)
+{
+    world.add(std::make_shared<MaterializedSphere>(Vec3(0, -1000, 0), 1000, std::make_shared<Lambertian>(Color(0.5))));
+    world.add(std::make_shared<MaterializedSphere>(Vec3(0, 1, 0), 1.0, std::make_shared<Glass>(1.5)));
+    world.add(std::make_shared<MaterializedSphere>(Vec3(-4, 1, 0), 1.0, std::make_shared<Lambertian>(Color(0.4, 0.2, 0.1))));
+    world.add(std::make_shared<MaterializedSphere>(Vec3(4, 1, 0), 1.0, std::make_shared<Mirror>(Color(0.7, 0.6, 0.5))));
+    for (int i = -11; i < 11; i++)
+    {
+        for (int j = -11; j < 11; j++)
+        {
+            const double choose_mat = generate_random_in_range(random, .0, 1.0);
+            const Vec3 center(i + 0.9 * generate_random_in_range(random, .0, 1.0), 0.2, j + 0.9 * generate_random_in_range(random, .0, 1.0));
+            if ((center - Vec3(4, 0.2, 0)).norm() <= 0.9)
+                continue;
+
+            std::shared_ptr<Material> material;
+            if (choose_mat < 0.8)
+            {
+                // diffuse
+                const Color albedo(generate_random_in_range(random, .0, 1.0), generate_random_in_range(random, .0, 1.0), generate_random_in_range(random, .0, 1.0));
+                material = std::make_shared<Lambertian>(albedo);
+            }
+            else if (choose_mat < 0.95)
+            {
+                // metal
+                const Color albedo(generate_random_in_range(random, .5, 1.0), generate_random_in_range(random, .5, 1.0), generate_random_in_range(random, .5, 1.0));
+                material = std::make_shared<Mirror>(albedo);
+            }
+            else
+            {
+                // glass
+                material = std::make_shared<Glass>(1.5);
+            }
+            world.add(std::make_shared<MaterializedSphere>(center, 0.2, material));
+        }
+    }
+}
+
+// add_three_spheres の配置で BVH を構築したシーン
+inline Aggregate make_three_spheres_world()
+{
+    Aggregate world;
+    add_three_spheres(world);
+    world.build();
+    return world;
+}
+
+#endif
@@ -0,0 +1,194 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ワーカー 1 つあたりの稼働統計
+struct WorkerStats
+{
+    double busy_seconds{.0};  // タスクを実行していた時間
+    double idle_seconds{.0};  // 実行開始から全タスク終了までのうち，タスクを実行していなかった時間
+    int executed_tasks{0};    // 実行したタスク数（盗んだタスクを含む）
+    int stolen_tasks{0};      // 他のワーカーから盗んだタスク数
+
+    // コンソール出力
+    inline friend std::ostream &operator<<(std::ostream &stream, const WorkerStats &s)
+    {
+        stream << "busy : " << s.busy_seconds << " [s], idle : " << s.idle_seconds << " [s], tasks : " << s.executed_tasks << " (stolen : " << s.stolen_tasks << ")";
+        return stream;
+    }
+};
+
+// ワーカーごとに両端キューを持ち，自分のキューが空になったらランダムに選んだ他のワーカーから盗むスケジューラ
+class WorkStealingScheduler
+{
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // ワーカーごとのタスクキュー
+    // 持ち主は先頭から取り出し，盗むワーカーは末尾から取り出す
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<int> tasks;
+    };
+
+    int num_workers;
+    std::vector<WorkerStats> worker_stats;
+
+    static bool pop_front(WorkerQueue &queue, int &task)
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            return false;
+        task = queue.tasks.front();
+        queue.tasks.pop_front();
+        return true;
+    }
+
+    static bool pop_back(WorkerQueue &queue, int &task)
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            return false;
+        task = queue.tasks.back();
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    static double elapsed_seconds(const Clock::time_point &begin, const Clock::time_point &end)
+    {
+        return std::chrono::duration<double>(end - begin).count();
+    }
+
+public:
+    // コンストラクタ
+    WorkStealingScheduler(const int _num_workers) : num_workers(std::max(1, _num_workers)), worker_stats(num_workers) {}
+
+    // ゲッター
+    int get_num_workers() const { return num_workers; }
+    const std::vector<WorkerStats> &get_worker_stats() const { return worker_stats; }
+
+    // タスク 0, 1, ..., task_count - 1 を execute(task, worker_id) で実行し，全タスクの終了を待つ
+    // 初期状態では連続したタスクをワーカーに均等に割り当て，局所性を保ったまま偏りを盗みで解消する
+    // タスクが例外を送出した場合は残りのタスクを実行せずに破棄し，全ワーカーの終了後に最初の例外を送出し直す
+    template <typename TaskFunction>
+    void run(const int task_count, const TaskFunction &execute)
+    {
+        std::vector<WorkerQueue> queues(num_workers);
+        for (int worker_id = 0; worker_id < num_workers; worker_id++)
+        {
+            const int begin = static_cast<int>(static_cast<int64_t>(task_count) * worker_id / num_workers);
+            const int end = static_cast<int>(static_cast<int64_t>(task_count) * (worker_id + 1) / num_workers);
+            for (int task = begin; task < end; task++)
+            {
+                queues[worker_id].tasks.push_back(task);
+            }
+        }
+
+        std::atomic<int> remaining_tasks(task_count);
+        std::atomic<bool> failed(false);
+        std::exception_ptr exception;
+        std::mutex exception_mutex;
+        std::vector<Clock::time_point> finish_times(num_workers);
+        worker_stats.assign(num_workers, WorkerStats());
+        const Clock::time_point start_time = Clock::now();
+
+        auto worker = [&](const int worker_id)
+        {
+            WorkerStats &stats = worker_stats[worker_id];
+            // 盗む相手を選ぶための xorshift 乱数
+            uint32_t victim_state = 2463534242u ^ static_cast<uint32_t>(worker_id * 0x9E3779B9u);
+
+            while (remaining_tasks.load(std::memory_order_acquire) > 0)
+            {
+                int task;
+                bool stolen = false;
+                bool found = pop_front(queues[worker_id], task);
+
+                // 自分のキューが空の場合，ランダムに選んだワーカーから盗む
+                for (int attempt = 0; !found && attempt < 2 * num_workers && num_workers > 1; attempt++)
+                {
+                    victim_state ^= victim_state << 13;
+                    victim_state ^= victim_state >> 17;
+                    victim_state ^= victim_state << 5;
+                    const int victim = static_cast<int>(victim_state % num_workers);
+                    if (victim != worker_id)
+                    {
+                        found = stolen = pop_back(queues[victim], task);
+                    }
+                }
+
+                if (!found)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                // 他のタスクが失敗した場合は実行せずに数だけ減らす
+                if (failed.load(std::memory_order_acquire))
+                {
+                    remaining_tasks.fetch_sub(1, std::memory_order_release);
+                    continue;
+                }
+
+                const Clock::time_point task_begin = Clock::now();
+                try
+                {
+                    execute(task, worker_id);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(exception_mutex);
+                    if (!exception)
+                        exception = std::current_exception();
+                    failed.store(true, std::memory_order_release);
+                }
+                stats.busy_seconds += elapsed_seconds(task_begin, Clock::now());
+                stats.executed_tasks++;
+                if (stolen)
+                    stats.stolen_tasks++;
+                remaining_tasks.fetch_sub(1, std::memory_order_release);
+            }
+            finish_times[worker_id] = Clock::now();
+        };
+
+        if (num_workers == 1)
+        {
+            worker(0);
+        }
+        else
+        {
+            std::vector<std::thread> workers;
+            workers.reserve(num_workers);
+            for (int worker_id = 0; worker_id < num_workers; worker_id++)
+            {
+                workers.emplace_back(worker, worker_id);
+            }
+            for (std::thread &t : workers)
+            {
+                t.join();
+            }
+        }
+
+        // 全タスクが終了した時刻を基準に，各ワーカーの待ち時間を求める
+        const Clock::time_point end_time = *std::max_element(finish_times.begin(), finish_times.end());
+        for (WorkerStats &stats : worker_stats)
+        {
+            stats.idle_seconds = std::max(.0, elapsed_seconds(start_time, end_time) - stats.busy_seconds);
+        }
+        if (exception)
+            std::rethrow_exception(exception);
+    }
+};
+
+#endif
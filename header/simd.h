@@ -0,0 +1,211 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+// 浮動小数点数の SIMD レジスタを包むクラス
+// コンパイル時に有効な命令セットに応じて，AVX・SSE2・スカラー（1 レーン）を切り替える
+// レーン数は倍精度（SimdDouble）が 4・2・1，単精度（SimdFloat）が 8・4・1
+// AVX を有効にするには -mavx2 や -march=native を付けてビルドする
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <cmath>
+#include <type_traits>
+#include "real.h"
+
+struct SimdDouble
+{
+#if defined(__AVX__)
+    static constexpr int LANES{4};
+    __m256d v;
+
+    SimdDouble() {}
+    SimdDouble(const __m256d _v) : v(_v) {}
+    explicit SimdDouble(const double s) : v(_mm256_set1_pd(s)) {}
+
+    static SimdDouble load(const double *p) { return SimdDouble(_mm256_loadu_pd(p)); }
+    void store(double *p) const { _mm256_storeu_pd(p, v); }
+    // 各レーンに start, start + 1, ... を格納
+    static SimdDouble iota(const double start) { return SimdDouble(_mm256_setr_pd(start, start + 1, start + 2, start + 3)); }
+
+    friend SimdDouble operator+(const SimdDouble a, const SimdDouble b) { return _mm256_add_pd(a.v, b.v); }
+    friend SimdDouble operator-(const SimdDouble a, const SimdDouble b) { return _mm256_sub_pd(a.v, b.v); }
+    friend SimdDouble operator*(const SimdDouble a, const SimdDouble b) { return _mm256_mul_pd(a.v, b.v); }
+    friend SimdDouble operator/(const SimdDouble a, const SimdDouble b) { return _mm256_div_pd(a.v, b.v); }
+    friend SimdDouble operator&(const SimdDouble a, const SimdDouble b) { return _mm256_and_pd(a.v, b.v); }
+    friend SimdDouble operator|(const SimdDouble a, const SimdDouble b) { return _mm256_or_pd(a.v, b.v); }
+    friend SimdDouble operator<(const SimdDouble a, const SimdDouble b) { return _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ); }
+    friend SimdDouble operator>(const SimdDouble a, const SimdDouble b) { return _mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ); }
+    friend SimdDouble operator<=(const SimdDouble a, const SimdDouble b) { return _mm256_cmp_pd(a.v, b.v, _CMP_LE_OQ); }
+    friend SimdDouble operator>=(const SimdDouble a, const SimdDouble b) { return _mm256_cmp_pd(a.v, b.v, _CMP_GE_OQ); }
+    friend SimdDouble sqrt(const SimdDouble a) { return _mm256_sqrt_pd(a.v); }
+    friend SimdDouble max(const SimdDouble a, const SimdDouble b) { return _mm256_max_pd(a.v, b.v); }
+    friend SimdDouble min(const SimdDouble a, const SimdDouble b) { return _mm256_min_pd(a.v, b.v); }
+    // mask のレーンが真なら a，偽なら b を選択
+    friend SimdDouble select(const SimdDouble mask, const SimdDouble a, const SimdDouble b) { return _mm256_blendv_pd(b.v, a.v, mask.v); }
+    // 比較結果のマスクを各レーン 1bit の整数に変換
+    int movemask() const { return _mm256_movemask_pd(v); }
+#elif defined(__SSE2__)
+    static constexpr int LANES{2};
+    __m128d v;
+
+    SimdDouble() {}
+    SimdDouble(const __m128d _v) : v(_v) {}
+    explicit SimdDouble(const double s) : v(_mm_set1_pd(s)) {}
+
+    static SimdDouble load(const double *p) { return SimdDouble(_mm_loadu_pd(p)); }
+    void store(double *p) const { _mm_storeu_pd(p, v); }
+    static SimdDouble iota(const double start) { return SimdDouble(_mm_setr_pd(start, start + 1)); }
+
+    friend SimdDouble operator+(const SimdDouble a, const SimdDouble b) { return _mm_add_pd(a.v, b.v); }
+    friend SimdDouble operator-(const SimdDouble a, const SimdDouble b) { return _mm_sub_pd(a.v, b.v); }
+    friend SimdDouble operator*(const SimdDouble a, const SimdDouble b) { return _mm_mul_pd(a.v, b.v); }
+    friend SimdDouble operator/(const SimdDouble a, const SimdDouble b) { return _mm_div_pd(a.v, b.v); }
+    friend SimdDouble operator&(const SimdDouble a, const SimdDouble b) { return _mm_and_pd(a.v, b.v); }
+    friend SimdDouble operator|(const SimdDouble a, const SimdDouble b) { return _mm_or_pd(a.v, b.v); }
+    friend SimdDouble operator<(const SimdDouble a, const SimdDouble b) { return _mm_cmplt_pd(a.v, b.v); }
+    friend SimdDouble operator>(const SimdDouble a, const SimdDouble b) { return _mm_cmpgt_pd(a.v, b.v); }
+    friend SimdDouble operator<=(const SimdDouble a, const SimdDouble b) { return _mm_cmple_pd(a.v, b.v); }
+    friend SimdDouble operator>=(const SimdDouble a, const SimdDouble b) { return _mm_cmpge_pd(a.v, b.v); }
+    friend SimdDouble sqrt(const SimdDouble a) { return _mm_sqrt_pd(a.v); }
+    friend SimdDouble max(const SimdDouble a, const SimdDouble b) { return _mm_max_pd(a.v, b.v); }
+    friend SimdDouble min(const SimdDouble a, const SimdDouble b) { return _mm_min_pd(a.v, b.v); }
+    // SSE2 には blendv がないため，論理演算で選択する
+    friend SimdDouble select(const SimdDouble mask, const SimdDouble a, const SimdDouble b) { return _mm_or_pd(_mm_and_pd(mask.v, a.v), _mm_andnot_pd(mask.v, b.v)); }
+    int movemask() const { return _mm_movemask_pd(v); }
+#else
+    static constexpr int LANES{1};
+    double v;
+    bool mask{false};
+
+    SimdDouble() {}
+    explicit SimdDouble(const double s) : v(s) {}
+
+    static SimdDouble load(const double *p) { return SimdDouble(*p); }
+    void store(double *p) const { *p = v; }
+    static SimdDouble iota(const double start) { return SimdDouble(start); }
+
+    static SimdDouble from_mask(const bool m)
+    {
+        SimdDouble r(.0);
+        r.mask = m;
+        return r;
+    }
+
+    friend SimdDouble operator+(const SimdDouble a, const SimdDouble b) { return SimdDouble(a.v + b.v); }
+    friend SimdDouble operator-(const SimdDouble a, const SimdDouble b) { return SimdDouble(a.v - b.v); }
+    friend SimdDouble operator*(const SimdDouble a, const SimdDouble b) { return SimdDouble(a.v * b.v); }
+    friend SimdDouble operator/(const SimdDouble a, const SimdDouble b) { return SimdDouble(a.v / b.v); }
+    friend SimdDouble operator&(const SimdDouble a, const SimdDouble b) { return from_mask(a.mask && b.mask); }
+    friend SimdDouble operator|(const SimdDouble a, const SimdDouble b) { return from_mask(a.mask || b.mask); }
+    friend SimdDouble operator<(const SimdDouble a, const SimdDouble b) { return from_mask(a.v < b.v); }
+    friend SimdDouble operator>(const SimdDouble a, const SimdDouble b) { return from_mask(a.v > b.v); }
+    friend SimdDouble operator<=(const SimdDouble a, const SimdDouble b) { return from_mask(a.v <= b.v); }
+    friend SimdDouble operator>=(const SimdDouble a, const SimdDouble b) { return from_mask(a.v >= b.v); }
+    friend SimdDouble sqrt(const SimdDouble a) { return SimdDouble(std::sqrt(a.v)); }
+    friend SimdDouble max(const SimdDouble a, const SimdDouble b) { return SimdDouble(a.v > b.v ? a.v : b.v); }
+    friend SimdDouble min(const SimdDouble a, const SimdDouble b) { return SimdDouble(a.v < b.v ? a.v : b.v); }
+    friend SimdDouble select(const SimdDouble mask, const SimdDouble a, const SimdDouble b) { return mask.mask ? a : b; }
+    int movemask() const { return mask ? 1 : 0; }
+#endif
+};
+
+struct SimdFloat
+{
+#if defined(__AVX__)
+    static constexpr int LANES{8};
+    __m256 v;
+
+    SimdFloat() {}
+    SimdFloat(const __m256 _v) : v(_v) {}
+    explicit SimdFloat(const float s) : v(_mm256_set1_ps(s)) {}
+
+    static SimdFloat load(const float *p) { return SimdFloat(_mm256_loadu_ps(p)); }
+    void store(float *p) const { _mm256_storeu_ps(p, v); }
+    static SimdFloat iota(const float start) { return SimdFloat(_mm256_setr_ps(start, start + 1, start + 2, start + 3, start + 4, start + 5, start + 6, start + 7)); }
+
+    friend SimdFloat operator+(const SimdFloat a, const SimdFloat b) { return _mm256_add_ps(a.v, b.v); }
+    friend SimdFloat operator-(const SimdFloat a, const SimdFloat b) { return _mm256_sub_ps(a.v, b.v); }
+    friend SimdFloat operator*(const SimdFloat a, const SimdFloat b) { return _mm256_mul_ps(a.v, b.v); }
+    friend SimdFloat operator/(const SimdFloat a, const SimdFloat b) { return _mm256_div_ps(a.v, b.v); }
+    friend SimdFloat operator&(const SimdFloat a, const SimdFloat b) { return _mm256_and_ps(a.v, b.v); }
+    friend SimdFloat operator|(const SimdFloat a, const SimdFloat b) { return _mm256_or_ps(a.v, b.v); }
+    friend SimdFloat operator<(const SimdFloat a, const SimdFloat b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+    friend SimdFloat operator>(const SimdFloat a, const SimdFloat b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+    friend SimdFloat operator<=(const SimdFloat a, const SimdFloat b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ); }
+    friend SimdFloat operator>=(const SimdFloat a, const SimdFloat b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ); }
+    friend SimdFloat sqrt(const SimdFloat a) { return _mm256_sqrt_ps(a.v); }
+    friend SimdFloat max(const SimdFloat a, const SimdFloat b) { return _mm256_max_ps(a.v, b.v); }
+    friend SimdFloat min(const SimdFloat a, const SimdFloat b) { return _mm256_min_ps(a.v, b.v); }
+    friend SimdFloat select(const SimdFloat mask, const SimdFloat a, const SimdFloat b) { return _mm256_blendv_ps(b.v, a.v, mask.v); }
+    int movemask() const { return _mm256_movemask_ps(v); }
+#elif defined(__SSE2__)
+    static constexpr int LANES{4};
+    __m128 v;
+
+    SimdFloat() {}
+    SimdFloat(const __m128 _v) : v(_v) {}
+    explicit SimdFloat(const float s) : v(_mm_set1_ps(s)) {}
+
+    static SimdFloat load(const float *p) { return SimdFloat(_mm_loadu_ps(p)); }
+    void store(float *p) const { _mm_storeu_ps(p, v); }
+    static SimdFloat iota(const float start) { return SimdFloat(_mm_setr_ps(start, start + 1, start + 2, start + 3)); }
+
+    friend SimdFloat operator+(const SimdFloat a, const SimdFloat b) { return _mm_add_ps(a.v, b.v); }
+    friend SimdFloat operator-(const SimdFloat a, const SimdFloat b) { return _mm_sub_ps(a.v, b.v); }
+    friend SimdFloat operator*(const SimdFloat a, const SimdFloat b) { return _mm_mul_ps(a.v, b.v); }
+    friend SimdFloat operator/(const SimdFloat a, const SimdFloat b) { return _mm_div_ps(a.v, b.v); }
+    friend SimdFloat operator&(const SimdFloat a, const SimdFloat b) { return _mm_and_ps(a.v, b.v); }
+    friend SimdFloat operator|(const SimdFloat a, const SimdFloat b) { return _mm_or_ps(a.v, b.v); }
+    friend SimdFloat operator<(const SimdFloat a, const SimdFloat b) { return _mm_cmplt_ps(a.v, b.v); }
+    friend SimdFloat operator>(const SimdFloat a, const SimdFloat b) { return _mm_cmpgt_ps(a.v, b.v); }
+    friend SimdFloat operator<=(const SimdFloat a, const SimdFloat b) { return _mm_cmple_ps(a.v, b.v); }
+    friend SimdFloat operator>=(const SimdFloat a, const SimdFloat b) { return _mm_cmpge_ps(a.v, b.v); }
+    friend SimdFloat sqrt(const SimdFloat a) { return _mm_sqrt_ps(a.v); }
+    friend SimdFloat max(const SimdFloat a, const SimdFloat b) { return _mm_max_ps(a.v, b.v); }
+    friend SimdFloat min(const SimdFloat a, const SimdFloat b) { return _mm_min_ps(a.v, b.v); }
+    friend SimdFloat select(const SimdFloat mask, const SimdFloat a, const SimdFloat b) { return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)); }
+    int movemask() const { return _mm_movemask_ps(v); }
+#else
+    static constexpr int LANES{1};
+    float v;
+    bool mask{false};
+
+    SimdFloat() {}
+    explicit SimdFloat(const float s) : v(s) {}
+
+    static SimdFloat load(const float *p) { return SimdFloat(*p); }
+    void store(float *p) const { *p = v; }
+    static SimdFloat iota(const float start) { return SimdFloat(start); }
+
+    static SimdFloat from_mask(const bool m)
+    {
+        SimdFloat r(.0f);
+        r.mask = m;
+        return r;
+    }
+
+    friend SimdFloat operator+(const SimdFloat a, const SimdFloat b) { return SimdFloat(a.v + b.v); }
+    friend SimdFloat operator-(const SimdFloat a, const SimdFloat b) { return SimdFloat(a.v - b.v); }
+    friend SimdFloat operator*(const SimdFloat a, const SimdFloat b) { return SimdFloat(a.v * b.v); }
+    friend SimdFloat operator/(const SimdFloat a, const SimdFloat b) { return SimdFloat(a.v / b.v); }
+    friend SimdFloat operator&(const SimdFloat a, const SimdFloat b) { return from_mask(a.mask && b.mask); }
+    friend SimdFloat operator|(const SimdFloat a, const SimdFloat b) { return from_mask(a.mask || b.mask); }
+    friend SimdFloat operator<(const SimdFloat a, const SimdFloat b) { return from_mask(a.v < b.v); }
+    friend SimdFloat operator>(const SimdFloat a, const SimdFloat b) { return from_mask(a.v > b.v); }
+    friend SimdFloat operator<=(const SimdFloat a, const SimdFloat b) { return from_mask(a.v <= b.v); }
+    friend SimdFloat operator>=(const SimdFloat a, const SimdFloat b) { return from_mask(a.v >= b.v); }
+    friend SimdFloat sqrt(const SimdFloat a) { return SimdFloat(std::sqrt(a.v)); }
+    friend SimdFloat max(const SimdFloat a, const SimdFloat b) { return SimdFloat(a.v > b.v ? a.v : b.v); }
+    friend SimdFloat min(const SimdFloat a, const SimdFloat b) { return SimdFloat(a.v < b.v ? a.v : b.v); }
+    friend SimdFloat select(const SimdFloat mask, const SimdFloat a, const SimdFloat b) { return mask.mask ? a : b; }
+    int movemask() const { return mask ? 1 : 0; }
+#endif
+};
+
+// 描画に用いる浮動小数点型（Real）の SIMD レジスタ
+using SimdReal = std::conditional_t<std::is_same_v<Real, float>, SimdFloat, SimdDouble>;
+
+#endif
@@ -0,0 +1,154 @@
+#ifndef SIMD3_H
+#define SIMD3_H
+
+// 3 成分のベクトル・色を，末尾に 1 成分のパディングを加えて 1 本の SIMD レジスタに格納して演算する
+// RAYTRACING_SIMD_VEC3 を定義してビルドすると，Vec3T・ColorT はこれを用いた特殊化に切り替わる
+//   倍精度 : AVX2（4 レーン，__m256d）
+//   単精度 : SSE（4 レーン，__m128）
+// 対応する命令セットが有効でない型は，従来通りスカラーで演算する
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#include <cmath>
+#include <limits>
+
+template <typename T>
+struct Simd3
+{
+    static constexpr bool ENABLED{false};
+};
+
+#if defined(__AVX2__)
+template <>
+struct Simd3<double>
+{
+    static constexpr bool ENABLED{true};
+    using Register = __m256d;
+
+    static Register set(const double x, const double y, const double z) { return _mm256_setr_pd(x, y, z, .0); }
+    static Register set1(const double s) { return _mm256_setr_pd(s, s, s, .0); }
+    // 32 バイト境界に揃った連続する 4 要素の読み込み・書き込み
+    static Register load(const double *p) { return _mm256_load_pd(p); }
+    static void store(double *p, const Register a) { _mm256_store_pd(p, a); }
+
+    static Register add(const Register a, const Register b) { return _mm256_add_pd(a, b); }
+    static Register sub(const Register a, const Register b) { return _mm256_sub_pd(a, b); }
+    static Register mul(const Register a, const Register b) { return _mm256_mul_pd(a, b); }
+    static Register div(const Register a, const Register b) { return _mm256_div_pd(a, b); }
+    static Register negate(const Register a) { return _mm256_xor_pd(a, _mm256_set1_pd(-.0)); }
+
+    // パディングを除く 3 成分が全て等しいか
+    static bool equal(const Register a, const Register b) { return (_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)) & 7) == 7; }
+
+    // 内積（スカラー版と同じ (x + y) + z の順に足す．FMA が使える場合は y・z 成分の積和を融合する）
+    static double dot(const Register a, const Register b)
+    {
+        const __m128d a_xy = _mm256_castpd256_pd128(a);
+        const __m128d b_xy = _mm256_castpd256_pd128(b);
+        const __m128d a_zw = _mm256_extractf128_pd(a, 1);
+        const __m128d b_zw = _mm256_extractf128_pd(b, 1);
+        const __m128d x = _mm_mul_sd(a_xy, b_xy);
+#if defined(__FMA__)
+        const __m128d xy = _mm_fmadd_sd(_mm_unpackhi_pd(a_xy, a_xy), _mm_unpackhi_pd(b_xy, b_xy), x);
+        return _mm_cvtsd_f64(_mm_fmadd_sd(a_zw, b_zw, xy));
+#else
+        const __m128d xy = _mm_add_sd(x, _mm_mul_sd(_mm_unpackhi_pd(a_xy, a_xy), _mm_unpackhi_pd(b_xy, b_xy)));
+        return _mm_cvtsd_f64(_mm_add_sd(xy, _mm_mul_sd(a_zw, b_zw)));
+#endif
+    }
+
+    // 外積 a.yzx * b.zxy - a.zxy * b.yzx
+    static Register cross(const Register a, const Register b)
+    {
+        const Register a_yzx = _mm256_permute4x64_pd(a, _MM_SHUFFLE(3, 0, 2, 1));
+        const Register b_yzx = _mm256_permute4x64_pd(b, _MM_SHUFFLE(3, 0, 2, 1));
+        const Register a_zxy = _mm256_permute4x64_pd(a, _MM_SHUFFLE(3, 1, 0, 2));
+        const Register b_zxy = _mm256_permute4x64_pd(b, _MM_SHUFFLE(3, 1, 0, 2));
+#if defined(__FMA__)
+        return _mm256_fmsub_pd(a_yzx, b_zxy, _mm256_mul_pd(a_zxy, b_yzx));
+#else
+        return _mm256_sub_pd(_mm256_mul_pd(a_yzx, b_zxy), _mm256_mul_pd(a_zxy, b_yzx));
+#endif
+    }
+
+    // 1 / sqrt(s)
+    // 倍精度の近似命令は AVX2 にないため，単精度の rsqrtps（相対誤差 1.5 * 2^-12）の結果を Newton 法で 3 回補正する
+    // 補正ごとに有効桁数がおよそ 2 倍になり，3 回で倍精度の丸め誤差程度になる
+    // 単精度で表せない範囲（正規化数の範囲外）の s は近似の初期値が得られないため，除算と平方根で求める
+    static Register reciprocal_sqrt(const double s)
+    {
+        if (!(s >= static_cast<double>(std::numeric_limits<float>::min()) && s <= static_cast<double>(std::numeric_limits<float>::max())))
+        {
+            return _mm256_set1_pd(1.0 / std::sqrt(s));
+        }
+        const __m128d x = _mm_set_sd(s);
+        __m128d y = _mm_cvtps_pd(_mm_rsqrt_ss(_mm_cvtsd_ss(_mm_setzero_ps(), x)));
+        const __m128d half_x = _mm_mul_sd(_mm_set_sd(.5), x);
+        for (int i = 0; i < 3; i++)
+        {
+            // y = y * (1.5 - 0.5 * s * y * y)
+            const __m128d y2 = _mm_mul_sd(y, y);
+#if defined(__FMA__)
+            y = _mm_mul_sd(y, _mm_fnmadd_sd(half_x, y2, _mm_set_sd(1.5)));
+#else
+            y = _mm_mul_sd(y, _mm_sub_sd(_mm_set_sd(1.5), _mm_mul_sd(half_x, y2)));
+#endif
+        }
+        return _mm256_broadcastsd_pd(y);
+    }
+};
+#endif
+
+#if defined(__SSE__)
+template <>
+struct Simd3<float>
+{
+    static constexpr bool ENABLED{true};
+    using Register = __m128;
+
+    static Register set(const float x, const float y, const float z) { return _mm_setr_ps(x, y, z, .0f); }
+    static Register set1(const float s) { return _mm_setr_ps(s, s, s, .0f); }
+    // 16 バイト境界に揃った連続する 4 要素の読み込み・書き込み
+    static Register load(const float *p) { return _mm_load_ps(p); }
+    static void store(float *p, const Register a) { _mm_store_ps(p, a); }
+
+    static Register add(const Register a, const Register b) { return _mm_add_ps(a, b); }
+    static Register sub(const Register a, const Register b) { return _mm_sub_ps(a, b); }
+    static Register mul(const Register a, const Register b) { return _mm_mul_ps(a, b); }
+    static Register div(const Register a, const Register b) { return _mm_div_ps(a, b); }
+    static Register negate(const Register a) { return _mm_xor_ps(a, _mm_set1_ps(-.0f)); }
+
+    static bool equal(const Register a, const Register b) { return (_mm_movemask_ps(_mm_cmpeq_ps(a, b)) & 7) == 7; }
+
+    static float dot(const Register a, const Register b)
+    {
+        const Register p = _mm_mul_ps(a, b);
+        const Register xy = _mm_add_ss(p, _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 2, 1, 1)));
+        return _mm_cvtss_f32(_mm_add_ss(xy, _mm_movehl_ps(p, p)));
+    }
+
+    static Register cross(const Register a, const Register b)
+    {
+        const Register a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+        const Register b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+        const Register a_zxy = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2));
+        const Register b_zxy = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2));
+        return _mm_sub_ps(_mm_mul_ps(a_yzx, b_zxy), _mm_mul_ps(a_zxy, b_yzx));
+    }
+
+    // 近似命令 rsqrtss（相対誤差 1.5 * 2^-12）を Newton 法で 1 回補正し，単精度の丸め誤差程度まで精度を上げる
+    static Register reciprocal_sqrt(const float s)
+    {
+        const Register x = _mm_set_ss(s);
+        const Register y = _mm_rsqrt_ss(x);
+        const Register y2 = _mm_mul_ss(y, y);
+        const Register r = _mm_mul_ss(_mm_mul_ss(_mm_set_ss(.5f), y), _mm_sub_ss(_mm_set_ss(3.0f), _mm_mul_ss(x, y2)));
+        return _mm_shuffle_ps(r, r, _MM_SHUFFLE(0, 0, 0, 0));
+    }
+};
+#endif
+
+#endif
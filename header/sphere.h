@@ -2,18 +2,27 @@
 #define SPHERE_H
 #include <cmath>
 #include <memory>
+#include "aabb.h"
 #include "vec3.h"
 #include "ray.h"
 #include "hit.h"
 #include "material.h"
+#include "material_variant.h"
 
-class Sphere
+// 中心と半径の型を T（float または double）とする球
+template <typename T>
+class SphereT
 {
 private:
-    const Vec3 center;
-    const double radius;
+    const Vec3T<T> center;
+    const T radius;
 
-    bool is_ray_outside_sphere(const Ray &ray, const Vec3 &normal) const
+protected:
+    // 閉じた集合に含まれるマテリアルの値（含まれない場合や，マテリアルを持たない球の場合は nullopt）
+    // 派生クラスが get_material を上書きしても反映されるよう，MaterializedSphereT のみが設定する
+    std::optional<MaterialVariant> material_variant;
+
+    bool is_ray_outside_sphere(const RayT<T> &ray, const Vec3T<T> &normal) const
     {
         if (dot(ray.get_direction(), normal.normalize()) > 0)
         {
@@ -29,7 +38,7 @@ private:
 
 public:
     // コンストラクタ
-    Sphere(const Vec3 &_center, const double _radius) : center(_center), radius(_radius)
+    SphereT(const Vec3T<T> &_center, const T _radius) : center(_center), radius(_radius)
     {
         if (_radius <= 0)
         {
@@ -38,39 +47,49 @@ public:
     }
 
     // コンソール出力
-    inline friend std::ostream &operator<<(std::ostream &stream, const Sphere &s)
+    inline friend std::ostream &operator<<(std::ostream &stream, const SphereT &s)
     {
         stream << "center : " << s.center << "\nradius : " << s.radius;
         return stream;
     }
 
     // ゲッター
-    Vec3 get_center() const
+    Vec3T<T> get_center() const
     {
         return center;
     }
 
-    double get_radius() const
+    T get_radius() const
     {
         return radius;
     }
 
+    // 球を囲む直方体
+    AABB get_bounding_box() const
+    {
+        return AABB(Vec3(center - radius), Vec3(center + radius));
+    }
+
     // 与えられたレイとの衝突判定
-    std::optional<Hit> intersect(const Ray &ray) const
+    std::optional<HitT<T>> intersect(const RayT<T> &ray) const
     {
+        // 単精度の場合も交差距離は倍精度で求める（地面のような大きな球では |oc|^2 と r^2 の差で桁落ちするため）
+        const Vec3T<double> oc = Vec3T<double>(ray.get_origin()) - Vec3T<double>(center);
+        const double min_distance = HitT<T>::MIN_DISTANCE;
+        const double max_distance = HitT<T>::MAX_DISTANCE;
         double a = 1.0;
-        double b = dot(ray.get_direction(), ray.get_origin() - center);
-        double c = pow((ray.get_origin() - center).norm(), 2) - pow(radius, 2);
+        double b = dot(Vec3T<double>(ray.get_direction()), oc);
+        double c = pow(oc.norm(), 2) - pow(static_cast<double>(radius), 2);
 
         double D = b * b - a * c;
         double distance;
 
         // D < 0 の場合，交差していない
-        if (D < -Hit::MIN_DISTANCE)
+        if (D < -min_distance)
             return std::nullopt;
 
         // D = 0 の場合，接する
-        else if (-Hit::MIN_DISTANCE <= D && D <= Hit::MIN_DISTANCE)
+        else if (-min_distance <= D && D <= min_distance)
         {
             distance = -b;
         }
@@ -82,29 +101,44 @@ public:
             double d2 = -b + std::sqrt(D);
 
             // レイの飛ばした逆方向で交差している場合
-            if (d1 < Hit::MIN_DISTANCE && d2 < Hit::MIN_DISTANCE)
+            if (d1 < min_distance && d2 < min_distance)
                 return std::nullopt;
 
             // 交差地点が非常に遠い場合
-            if (d1 > Hit::MAX_DISTANCE && d2 > Hit::MAX_DISTANCE)
+            if (d1 > max_distance && d2 > max_distance)
                 return std::nullopt;
 
-            if (Hit::MIN_DISTANCE < d1 && d1 < Hit::MAX_DISTANCE)
+            if (min_distance < d1 && d1 < max_distance)
             {
                 distance = d1;
             }
-            else if (Hit::MIN_DISTANCE < d2 && d2 < Hit::MAX_DISTANCE)
+            else if (min_distance < d2 && d2 < max_distance)
             {
                 distance = d2;
             }
+            // 手前側の交点が近すぎ，奥側の交点が遠すぎる場合
+            else
+                return std::nullopt;
         }
 
-        Vec3 hit_position = ray(distance);
-        Vec3 surface_normal = hit_position - center;
-        return Hit(distance, hit_position, surface_normal, this, is_ray_outside_sphere(ray, surface_normal));
+        Vec3T<T> hit_position = ray(static_cast<T>(distance));
+        Vec3T<T> surface_normal = hit_position - center;
+        return HitT<T>(static_cast<T>(distance), hit_position, surface_normal, this, is_ray_outside_sphere(ray, surface_normal));
     }
 
-    virtual Material *get_material() const { return new Lambertian(Color(0)); }
+    // マテリアルを持たない球は黒の Lambertian として扱う
+    // 既定のマテリアルは全ての球で共有し，呼び出しごとに確保しない
+    virtual Material *get_material() const
+    {
+        static Lambertian default_material(Color(0));
+        return &default_material;
+    }
+
+    // 仮想関数を介さずにマテリアルを取得する（nullptr の場合は get_material を用いる）
+    const MaterialVariant *get_material_variant() const
+    {
+        return material_variant ? &*material_variant : nullptr;
+    }
 
     class radius_exception
     {
@@ -117,15 +151,19 @@ public:
     };
 };
 
-class MaterializedSphere : public Sphere
+template <typename T>
+class MaterializedSphereT : public SphereT<T>
 {
 private:
     const std::shared_ptr<Material> material;
 
 public:
     // コンストラクタ
-    MaterializedSphere(const Vec3 &_center, const double _radius, const std::shared_ptr<Material> &_material)
-        : Sphere(_center, _radius), material(_material) {}
+    MaterializedSphereT(const Vec3T<T> &_center, const T _radius, const std::shared_ptr<Material> &_material)
+        : SphereT<T>(_center, _radius), material(_material)
+    {
+        this->material_variant = to_material_variant(_material.get());
+    }
 
     Material *get_material() const override
     {
@@ -133,4 +171,7 @@ public:
     }
 };
 
+using Sphere = SphereT<Real>;
+using MaterializedSphere = MaterializedSphereT<Real>;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,262 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// レンダリングの各段階の処理量と処理時間の計測
+// -DRAYTRACING_STATS を付けてビルドした場合のみ計測し，付けない場合は RAYTRACING_STATS_* のマクロが空となるためオーバーヘッドはない
+// 計測値はスレッドごとに持ち，レンダリングの終了時にまとめて出力する
+
+// 区間ごとの処理時間の合計と呼び出し回数
+struct StatsTimer
+{
+    long long nanoseconds{0};
+    long long calls{0};
+
+    void merge(const StatsTimer &other)
+    {
+        nanoseconds += other.nanoseconds;
+        calls += other.calls;
+    }
+};
+
+struct RenderStats
+{
+    static constexpr int BOUNCE_BINS{17}; // バウンス数の度数分布の階級数（最後の階級は BOUNCE_BINS - 1 回以上）
+
+    long long rays{0};         // 交差判定を行ったレイの本数
+    long long sphere_tests{0}; // 球との交差判定の回数
+    long long hits{0};         // 物体と衝突したレイの本数
+    long long paths{0};        // 終了した経路の数
+    long long bounce_histogram[BOUNCE_BINS]{}; // 経路ごとのバウンス（反射・屈折）回数の度数分布
+    long long russian_roulette_terminations{0}; // ロシアンルーレットで打ち切った経路の数
+    long long depth_limit_terminations{0};      // 最大バウンス数に達して打ち切った経路の数
+    StatsTimer intersect_timer;  // Aggregate::intersect
+    StatsTimer sample_ray_timer; // Material::sample_ray
+    StatsTimer save_png_timer;   // Image::save_png
+
+    // bounces 回のバウンスで終了した経路を count 本加える
+    void add_paths(const int bounces, const long long count = 1)
+    {
+        paths += count;
+        bounce_histogram[bounces < BOUNCE_BINS - 1 ? bounces : BOUNCE_BINS - 1] += count;
+    }
+
+    void merge(const RenderStats &other)
+    {
+        rays += other.rays;
+        sphere_tests += other.sphere_tests;
+        hits += other.hits;
+        paths += other.paths;
+        for (int i = 0; i < BOUNCE_BINS; i++)
+            bounce_histogram[i] += other.bounce_histogram[i];
+        russian_roulette_terminations += other.russian_roulette_terminations;
+        depth_limit_terminations += other.depth_limit_terminations;
+        intersect_timer.merge(other.intersect_timer);
+        sample_ray_timer.merge(other.sample_ray_timer);
+        save_png_timer.merge(other.save_png_timer);
+    }
+
+    bool is_empty() const
+    {
+        return rays == 0 && paths == 0 && intersect_timer.calls == 0 && sample_ray_timer.calls == 0 && save_png_timer.calls == 0;
+    }
+
+    // 経路あたりの平均バウンス数（最後の階級は BOUNCE_BINS - 1 回として数える）
+    double get_mean_bounces() const
+    {
+        long long sum = 0;
+        for (int i = 0; i < BOUNCE_BINS; i++)
+            sum += i * bounce_histogram[i];
+        return paths > 0 ? static_cast<double>(sum) / paths : .0;
+    }
+
+    // コンソール出力（処理時間は全スレッドの合計）
+    void print(std::ostream &stream) const
+    {
+        auto ratio = [](const long long a, const long long b)
+        { return b > 0 ? static_cast<double>(a) / b : .0; };
+        auto print_timer = [&](const char *name, const StatsTimer &timer)
+        {
+            stream << "  " << std::left << std::setw(22) << name << std::right << " : " << timer.nanoseconds * 1e-6 << " [ms] ("
+                   << timer.calls << " calls, " << ratio(timer.nanoseconds, timer.calls) << " [ns/call])\n";
+        };
+
+        stream << "  rays                   : " << rays << " (hits : " << hits << ", " << 100 * ratio(hits, rays) << "%)\n"
+               << "  sphere tests           : " << sphere_tests << " (" << ratio(sphere_tests, rays) << " per ray)\n"
+               << "  paths                  : " << paths << " (mean bounces : " << get_mean_bounces() << ")\n"
+               << "  bounces per path       :";
+        for (int i = 0; i < BOUNCE_BINS; i++)
+        {
+            if (bounce_histogram[i] > 0)
+                stream << " " << i << (i == BOUNCE_BINS - 1 ? "+" : "") << ":" << bounce_histogram[i];
+        }
+        stream << "\n"
+               << "  terminations           : russian roulette " << russian_roulette_terminations << ", depth limit " << depth_limit_terminations << "\n";
+        print_timer("Aggregate::intersect", intersect_timer);
+        print_timer("Material::sample_ray", sample_ray_timer);
+        print_timer("Image::save_png", save_png_timer);
+    }
+};
+
+// スレッドごとの計測値の登録先
+// 終了したスレッドの計測値は retired にまとめ，collect で実行中のスレッドの値と合わせる
+class StatsRegistry
+{
+private:
+    std::mutex mutex;
+    std::vector<RenderStats *> live;
+    RenderStats retired;
+
+public:
+    static StatsRegistry &get()
+    {
+        static StatsRegistry registry;
+        return registry;
+    }
+
+    // 最後の出力以降に残った計測値（レンダリング後の画像の保存など）をプログラムの終了時に出力する
+    ~StatsRegistry()
+    {
+        if (!retired.is_empty())
+        {
+            std::clog << "[stats] exit\n";
+            retired.print(std::clog);
+        }
+    }
+
+    void add(RenderStats *stats)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        live.push_back(stats);
+    }
+
+    void remove(RenderStats *stats)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        retired.merge(*stats);
+        live.erase(std::find(live.begin(), live.end(), stats));
+    }
+
+    // 全スレッドの計測値の合計（reset が true の場合は合計した後に 0 に戻す）
+    // 他のスレッドが計測中でない時点（レンダリングの終了後など）で呼び出す
+    RenderStats collect(const bool reset)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        RenderStats total = retired;
+        for (RenderStats *stats : live)
+            total.merge(*stats);
+        if (reset)
+        {
+            retired = RenderStats();
+            for (RenderStats *stats : live)
+                *stats = RenderStats();
+        }
+        return total;
+    }
+};
+
+// 呼び出したスレッドの計測値
+inline RenderStats &get_thread_stats()
+{
+    struct ThreadStats
+    {
+        RenderStats stats;
+        ThreadStats() { StatsRegistry::get().add(&stats); }
+        ~ThreadStats() { StatsRegistry::get().remove(&stats); }
+    };
+    thread_local ThreadStats thread_stats;
+    return thread_stats.stats;
+}
+
+// スコープを抜けるまでの時間を timer に加える
+class ScopedStatsTimer
+{
+private:
+    StatsTimer &timer;
+    std::chrono::steady_clock::time_point begin;
+
+public:
+    ScopedStatsTimer(StatsTimer &_timer) : timer(_timer), begin(std::chrono::steady_clock::now()) {}
+    ~ScopedStatsTimer()
+    {
+        timer.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+        timer.calls++;
+    }
+};
+
+// 交差判定・シェーディングの区間の開始と終了の通知
+// -DRAYTRACING_STATS_PHASES を付けてビルドした場合のみ，登録された関数を区間の開始時と終了時に呼び出す（ベンチマークが区間ごとのハードウェアカウンタの計測に用いる）
+// 関数はレンダリングを開始する前に登録し，終了した後に解除する
+enum class StatsPhase
+{
+    Intersect, // Aggregate::intersect
+    Shade,     // 衝突した点でのシェーディングと次のレイのサンプリング
+};
+constexpr int NUM_STATS_PHASES{2};
+
+struct StatsPhaseListener
+{
+    void (*begin)(StatsPhase){nullptr};
+    void (*end)(StatsPhase){nullptr};
+};
+
+inline StatsPhaseListener &get_stats_phase_listener()
+{
+    static StatsPhaseListener listener;
+    return listener;
+}
+
+// スコープの開始と終了を登録された関数に通知する
+class ScopedStatsPhase
+{
+private:
+    StatsPhase phase;
+    void (*end)(StatsPhase);
+
+public:
+    ScopedStatsPhase(const StatsPhase _phase) : phase(_phase), end(get_stats_phase_listener().end)
+    {
+        if (void (*begin)(StatsPhase) = get_stats_phase_listener().begin)
+            begin(phase);
+    }
+    ~ScopedStatsPhase()
+    {
+        if (end)
+            end(phase);
+    }
+};
+
+// 前回の出力以降の全スレッドの計測値を label と共に出力し，0 に戻す
+inline void print_stats_report(const std::string &label, std::ostream &stream = std::clog)
+{
+    const RenderStats stats = StatsRegistry::get().collect(true);
+    stream << "[stats] " << label << "\n";
+    stats.print(stream);
+}
+
+#if defined(RAYTRACING_STATS)
+#define RAYTRACING_STATS_ADD(counter, value) (get_thread_stats().counter += (value))
+#define RAYTRACING_STATS_PATHS(bounces, count) get_thread_stats().add_paths((bounces), (count))
+#define RAYTRACING_STATS_TIMER(timer) ScopedStatsTimer stats_##timer(get_thread_stats().timer)
+#define RAYTRACING_STATS_REPORT(label) print_stats_report(label)
+#else
+#define RAYTRACING_STATS_ADD(counter, value) ((void)0)
+#define RAYTRACING_STATS_PATHS(bounces, count) ((void)0)
+#define RAYTRACING_STATS_TIMER(timer) ((void)0)
+#define RAYTRACING_STATS_REPORT(label) ((void)0)
+#endif
+
+#if defined(RAYTRACING_STATS_PHASES)
+#define RAYTRACING_STATS_PHASE(phase) ScopedStatsPhase stats_phase_##phase(StatsPhase::phase)
+#else
+#define RAYTRACING_STATS_PHASE(phase) ((void)0)
+#endif
+
+#endif
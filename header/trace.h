@@ -0,0 +1,214 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+// Chrome の trace_event 形式（JSON）での処理の時系列の記録
+// 環境変数 RAYTRACING_TRACE に出力先のファイル名を指定する（または TraceRecorder::get().enable(path) を呼び出す）と記録を有効にし，
+// プログラムの終了時に書き出す．chrome://tracing や Perfetto（https://ui.perfetto.dev）で開くと，ワーカーごとのタイルの処理を確認できる
+// 記録はタイル・画像の保存などの粗い単位で行うため，無効の場合の負荷は分岐 1 回程度である
+
+// 1 つの区間（"X" : complete event）
+struct TraceEvent
+{
+    std::string name;
+    std::string category;
+    int lane;             // 表示する行（0 はメインスレッド，1 以降はレンダラのワーカー）
+    double begin_us;      // 記録の開始からの時刻 [us]
+    double duration_us;   // 区間の長さ [us]
+    std::string args;     // 付加情報（JSON のオブジェクトの中身，空でもよい）
+};
+
+class TraceRecorder
+{
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::atomic<bool> enabled{false};
+    std::string output_path;
+    Clock::time_point origin;
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+
+    TraceRecorder() : origin(Clock::now())
+    {
+        if (const char *path = std::getenv("RAYTRACING_TRACE"))
+        {
+            if (*path != '\0')
+                enable(path);
+        }
+    }
+
+public:
+    static constexpr int MAIN_LANE{0};
+
+    // JSON の文字列として書き出すために '"' と '\\' をエスケープし，制御文字（0x20 未満）は \u00XX の形式で書き出す
+    static std::string escape(const std::string &text)
+    {
+        std::string escaped;
+        for (const char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                escaped += '\\';
+                escaped += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char code[7];
+                std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned char>(c));
+                escaped += code;
+            }
+            else
+            {
+                escaped += c;
+            }
+        }
+        return escaped;
+    }
+
+    static TraceRecorder &get()
+    {
+        static TraceRecorder recorder;
+        return recorder;
+    }
+
+    // 有効な場合はプログラムの終了時に書き出す
+    ~TraceRecorder()
+    {
+        if (enabled)
+            save();
+    }
+
+    // ゲッター
+    bool is_enabled() const { return enabled; }
+    const std::string &get_output_path() const { return output_path; }
+
+    // 記録を有効にし，出力先を output_path とする
+    void enable(const std::string &_output_path)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        output_path = _output_path;
+        enabled = true;
+    }
+
+    // 記録を無効にする（記録済みの区間は残す）
+    void disable()
+    {
+        enabled = false;
+    }
+
+    // 記録の開始からの時刻 [us]
+    double now_us() const
+    {
+        return std::chrono::duration<double, std::micro>(Clock::now() - origin).count();
+    }
+
+    void add_event(TraceEvent event)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        events.push_back(std::move(event));
+    }
+
+    std::vector<TraceEvent> get_events()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return events;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        events.clear();
+    }
+
+    // 記録した区間と，行の名前（メタデータ）を output_path に書き出す
+    bool save()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::ofstream file(output_path);
+        if (!file)
+            return false;
+
+        std::set<int> lanes;
+        file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+        file << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"raytracing\"}}";
+        for (const TraceEvent &e : events)
+        {
+            char times[64];
+            std::snprintf(times, sizeof(times), "\"ts\": %.3f, \"dur\": %.3f", e.begin_us, e.duration_us);
+            file << ",\n{\"name\": \"" << escape(e.name) << "\", \"cat\": \"" << escape(e.category) << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << e.lane
+                 << ", " << times << ", \"args\": {" << e.args << "}}";
+            lanes.insert(e.lane);
+        }
+        for (const int lane : lanes)
+        {
+            const std::string name = lane == MAIN_LANE ? "main" : "worker " + std::to_string(lane - 1);
+            file << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << lane << ", \"args\": {\"name\": \"" << name << "\"}}";
+            file << ",\n{\"name\": \"thread_sort_index\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << lane << ", \"args\": {\"sort_index\": " << lane << "}}";
+        }
+        file << "\n]}\n";
+        return static_cast<bool>(file);
+    }
+};
+
+// スコープに入ってから抜けるまでを 1 つの区間として記録する（記録が無効の場合は何もしない）
+class TraceScope
+{
+private:
+    const char *name;
+    const char *category;
+    int lane;
+    std::string args;
+    double begin_us{-1.0};
+
+public:
+    TraceScope(const char *_name, const char *_category, const int _lane = TraceRecorder::MAIN_LANE)
+        : name(_name), category(_category), lane(_lane)
+    {
+        if (TraceRecorder::get().is_enabled())
+            begin_us = TraceRecorder::get().now_us();
+    }
+
+    ~TraceScope()
+    {
+        if (begin_us < 0)
+            return;
+        TraceRecorder &recorder = TraceRecorder::get();
+        recorder.add_event(TraceEvent{name, category, lane, begin_us, recorder.now_us() - begin_us, args});
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+    bool is_recording() const { return begin_us >= 0; }
+
+    // 付加情報を追加する（記録しない場合は何もしない）
+    void add_arg(const char *key, const long long value)
+    {
+        if (!is_recording())
+            return;
+        if (!args.empty())
+            args += ", ";
+        args += std::string("\"") + key + "\": " + std::to_string(value);
+    }
+
+    void add_arg(const char *key, const std::string &value)
+    {
+        if (!is_recording())
+            return;
+        if (!args.empty())
+            args += ", ";
+        args += std::string("\"") + key + "\": \"" + TraceRecorder::escape(value) + "\"";
+    }
+};
+
+#endif
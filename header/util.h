@@ -1,8 +1,12 @@
 #ifndef UTIL_H
 #define UTIL_H
 
+#include <algorithm>
 #include <cstdlib>
+#include <thread>
 #include <time.h>
+#include <vector>
+#include "random.h"
 
 template <typename T>
 T clamp(T x, T min, T max)
@@ -15,13 +19,50 @@ T clamp(T x, T min, T max)
         return x;
 }
 
-template <typename T>
-T generate_random_in_range(T min, T max)
+// random は next_double() を持つもの（Pcg32 や SampleStream）
+template <typename T, typename Random>
+T generate_random_in_range(Random &random, T min, T max)
 {
     // 0.0 以上 1.0 未満のランダムな浮動小数点数を生成
-    double normalized_random_value = static_cast<double>(rand()) / RAND_MAX;
+    double normalized_random_value = random.next_double();
     // [min,max) の実数乱数を返す
     return min + normalized_random_value * (max - min);
 }
 
+template <typename T>
+T generate_random_in_range(T min, T max)
+{
+    // スレッドごとの乱数生成器を用いるため，複数スレッドから同時に呼び出してもよい
+    return generate_random_in_range(thread_local_random(), min, max);
+}
+
+// [begin, end) を連続した区間に分割し，func(chunk_begin, chunk_end) を複数スレッドで並列に実行する
+// 区間の長さが min_chunk_size 未満の場合は呼び出したスレッドで実行する
+template <typename Function>
+void parallel_for(const int begin, const int end, const int min_chunk_size, const Function &func)
+{
+    const int length = end - begin;
+    if (length <= 0)
+        return;
+    const int max_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    const int num_chunks = std::max(1, std::min(max_threads, length / std::max(1, min_chunk_size)));
+    if (num_chunks == 1)
+    {
+        func(begin, end);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_chunks - 1);
+    for (int chunk = 1; chunk < num_chunks; chunk++)
+    {
+        threads.emplace_back(func, begin + length * chunk / num_chunks, begin + length * (chunk + 1) / num_chunks);
+    }
+    func(begin, begin + length / num_chunks);
+    for (std::thread &t : threads)
+    {
+        t.join();
+    }
+}
+
 #endif
\ No newline at end of file
@@ -3,132 +3,138 @@
 
 #include <iostream>
 #include <cmath>
+#include "real.h"
 
-class Vec3
+// 成分の型を T（float または double）とする 3 次元ベクトル
+template <typename T>
+class Vec3T
 {
 public:
-    double x, y, z;
+    T x, y, z;
 
     // コンストラクタ
-    Vec3() : x(.0), y(.0), z(.0) {}
-    Vec3(double _i) : x(_i), y(_i), z(_i) {}
-    Vec3(double _x, double _y, double _z) : x(_x), y(_y), z(_z) {}
+    Vec3T() : x(.0), y(.0), z(.0) {}
+    Vec3T(T _i) : x(_i), y(_i), z(_i) {}
+    Vec3T(T _x, T _y, T _z) : x(_x), y(_y), z(_z) {}
+    // 精度の異なるベクトルからの変換
+    template <typename U>
+    explicit Vec3T(const Vec3T<U> &v) : x(static_cast<T>(v.x)), y(static_cast<T>(v.y)), z(static_cast<T>(v.z)) {}
 
     // デストラクタ
-    ~Vec3() {}
+    ~Vec3T() {}
 
     // ベクトル同士の演算
-    inline Vec3 operator+(const Vec3 &v) const
+    inline Vec3T operator+(const Vec3T &v) const
     {
-        return Vec3(x + v.x, y + v.y, z + v.z);
+        return Vec3T(x + v.x, y + v.y, z + v.z);
     }
 
-    inline Vec3 operator+=(const Vec3 &v)
+    inline Vec3T operator+=(const Vec3T &v)
     {
         x += v.x, y += v.y, z += v.z;
         return *this;
     }
 
-    inline Vec3 operator-(const Vec3 &v) const
+    inline Vec3T operator-(const Vec3T &v) const
     {
-        return Vec3(x - v.x, y - v.y, z - v.z);
+        return Vec3T(x - v.x, y - v.y, z - v.z);
     }
 
-    inline Vec3 operator-=(const Vec3 &v)
+    inline Vec3T operator-=(const Vec3T &v)
     {
         x -= v.x, y -= v.y, z -= v.z;
         return *this;
     }
 
-    inline Vec3 operator*(const Vec3 &v) const
+    inline Vec3T operator*(const Vec3T &v) const
     {
-        return Vec3(x * v.x, y * v.y, z * v.z);
+        return Vec3T(x * v.x, y * v.y, z * v.z);
     }
 
-    inline Vec3 operator*=(const Vec3 &v)
+    inline Vec3T operator*=(const Vec3T &v)
     {
         x *= v.x, y *= v.y, z *= v.z;
         return *this;
     }
 
-    inline Vec3 operator/(const Vec3 &v) const
+    inline Vec3T operator/(const Vec3T &v) const
     {
-        return Vec3(x / v.x, y / v.y, z / v.z);
+        return Vec3T(x / v.x, y / v.y, z / v.z);
     }
 
-    inline Vec3 operator/=(const Vec3 &v)
+    inline Vec3T operator/=(const Vec3T &v)
     {
         x /= v.x, y /= v.y, z /= v.z;
         return *this;
     }
 
     // ベクトルとスカラーの演算
-    inline Vec3 operator+(const double s) const
+    inline Vec3T operator+(const T s) const
     {
-        return Vec3(x + s, y + s, z + s);
+        return Vec3T(x + s, y + s, z + s);
     }
 
-    inline friend Vec3 operator+(const double s, const Vec3 &v)
+    inline friend Vec3T operator+(const T s, const Vec3T &v)
     {
-        return Vec3(s + v.x, s + v.y, s + v.z);
+        return Vec3T(s + v.x, s + v.y, s + v.z);
     }
 
-    inline Vec3 operator+=(const double s)
+    inline Vec3T operator+=(const T s)
     {
         x += s, y += s, z += s;
         return *this;
     }
 
-    inline Vec3 operator-(const double s) const
+    inline Vec3T operator-(const T s) const
     {
-        return Vec3(x - s, y - s, z - s);
+        return Vec3T(x - s, y - s, z - s);
     }
 
-    inline friend Vec3 operator-(const double s, const Vec3 &v)
+    inline friend Vec3T operator-(const T s, const Vec3T &v)
     {
-        return Vec3(s - v.x, s - v.y, s - v.z);
+        return Vec3T(s - v.x, s - v.y, s - v.z);
     }
 
-    inline Vec3 operator-=(const double s)
+    inline Vec3T operator-=(const T s)
     {
         x -= s, y -= s, z -= s;
         return *this;
     }
 
-    inline Vec3 operator*(const double s) const
+    inline Vec3T operator*(const T s) const
     {
-        return Vec3(x * s, y * s, z * s);
+        return Vec3T(x * s, y * s, z * s);
     }
 
-    inline friend Vec3 operator*(const double s, const Vec3 &v)
+    inline friend Vec3T operator*(const T s, const Vec3T &v)
     {
-        return Vec3(s * v.x, s * v.y, s * v.z);
+        return Vec3T(s * v.x, s * v.y, s * v.z);
     }
 
-    inline Vec3 operator*=(const double s)
+    inline Vec3T operator*=(const T s)
     {
         x *= s, y *= s, z *= s;
         return *this;
     }
 
-    inline Vec3 operator/(const double s) const
+    inline Vec3T operator/(const T s) const
     {
-        return Vec3(x / s, y / s, z / s);
+        return Vec3T(x / s, y / s, z / s);
     }
 
-    inline friend Vec3 operator/(const double s, const Vec3 &v)
+    inline friend Vec3T operator/(const T s, const Vec3T &v)
     {
-        return Vec3(s / v.x, s / v.y, s / v.z);
+        return Vec3T(s / v.x, s / v.y, s / v.z);
     }
 
-    inline Vec3 operator/=(const double s)
+    inline Vec3T operator/=(const T s)
     {
         x /= s, y /= s, z /= s;
         return *this;
     }
 
     // イコール演算子
-    inline bool operator==(const Vec3 &v) const
+    inline bool operator==(const Vec3T &v) const
     {
         if (x == v.x && y == v.y && z == v.z)
             return true;
@@ -136,51 +142,64 @@ public:
             return false;
     }
 
+    // 軸番号（0: x, 1: y, 2: z）による成分の取得
+    inline T operator[](const int axis) const
+    {
+        return axis == 0 ? x : (axis == 1 ? y : z);
+    }
+
     // マイナス演算
-    inline Vec3 operator-() const
+    inline Vec3T operator-() const
     {
-        return Vec3(-x, -y, -z);
+        return Vec3T(-x, -y, -z);
     }
 
     // ノルム値
-    double norm() const
+    T norm() const
     {
         return std::sqrt(x * x + y * y + z * z);
     }
 
     // 正規化
-    Vec3 normalize() const
+    Vec3T normalize() const
     {
-        double norm = this->norm();
-        return Vec3(
+        T norm = this->norm();
+        return Vec3T(
             x / norm,
             y / norm,
             z / norm);
     }
 
     // 内積
-    inline friend double dot(const Vec3 &v1, const Vec3 &v2)
+    inline friend T dot(const Vec3T &v1, const Vec3T &v2)
     {
         return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
     }
 
     // 外積
-    inline friend Vec3 cross(const Vec3 &v1, const Vec3 &v2)
+    inline friend Vec3T cross(const Vec3T &v1, const Vec3T &v2)
     {
-        return Vec3(
+        return Vec3T(
             v1.y * v2.z - v1.z * v2.y,
             v1.z * v2.x - v1.x * v2.z,
             v1.x * v2.y - v1.y * v2.x);
     }
 
     // コンソール出力
-    inline friend std::ostream &operator<<(std::ostream &stream, const Vec3 &v)
+    inline friend std::ostream &operator<<(std::ostream &stream, const Vec3T &v)
     {
         stream << "(" << v.x << ", " << v.y << ", " << v.z << ")";
         return stream;
     }
 };
 
+// SIMD レジスタで演算する特殊化（RAYTRACING_SIMD_VEC3 を定義した場合のみ）
+#if defined(RAYTRACING_SIMD_VEC3)
+#include "vec3_simd.h"
+#endif
+
+using Vec3 = Vec3T<Real>;
+
 Vec3 spherical_to_cartesian(double theta, double phi)
 {
     /**
@@ -197,4 +216,16 @@ Vec3 spherical_to_cartesian(double theta, double phi)
     return Vec3(sin(theta) * sin(phi), cos(theta), sin(theta) * cos(phi));
 }
 
+// 単位ベクトル n を第 3 軸とする正規直交基底 (tangent, bitangent, n) を求める
+// 三角関数や正規化を用いず，n.z の符号以外で分岐しない構成法（Duff et al., "Building an Orthonormal Basis, Revisited", 2017）
+template <typename T>
+void make_orthonormal_basis(const Vec3T<T> &n, Vec3T<T> &tangent, Vec3T<T> &bitangent)
+{
+    const T sign = std::copysign(T(1), n.z);
+    const T a = T(-1) / (sign + n.z);
+    const T b = n.x * n.y * a;
+    tangent = Vec3T<T>(T(1) + sign * n.x * n.x * a, sign * b, -sign * n.x);
+    bitangent = Vec3T<T>(b, sign + n.y * n.y * a, -n.y);
+}
+
 #endif
\ No newline at end of file
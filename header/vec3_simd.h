@@ -0,0 +1,124 @@
+#ifndef VEC3_SIMD_H
+#define VEC3_SIMD_H
+
+// vec3.h から RAYTRACING_SIMD_VEC3 が定義されている場合にのみ読み込まれる
+// Vec3T と同じ演算子・関数を，成分（x, y, z とパディング）を SIMD レジスタ 1 本に読み込んで実装する
+// 加減乗除はスカラー版と同じ結果となり，正規化（逆数の平方根を掛ける）と FMA を用いた外積は最下位ビット程度の差が出る
+#include <iostream>
+#include <cmath>
+#include "simd3.h"
+
+template <typename T>
+class SimdVec3T
+{
+    using Simd = Simd3<T>;
+    using Register = typename Simd::Register;
+
+public:
+    // 成分はレジスタ幅の境界に揃えた 4 要素として持ち，演算の際に load / store でレジスタとやり取りする
+    alignas(sizeof(Register)) T x;
+    T y, z;
+    T padding;
+
+    // コンストラクタ
+    SimdVec3T() : x(0), y(0), z(0), padding(0) {}
+    SimdVec3T(T _i) : x(_i), y(_i), z(_i), padding(0) {}
+    SimdVec3T(T _x, T _y, T _z) : x(_x), y(_y), z(_z), padding(0) {}
+    explicit SimdVec3T(const Register _v) { Simd::store(&x, _v); }
+    // 精度の異なるベクトルからの変換
+    template <typename U>
+    explicit SimdVec3T(const Vec3T<U> &u) : x(static_cast<T>(u.x)), y(static_cast<T>(u.y)), z(static_cast<T>(u.z)), padding(0) {}
+
+    // 3 成分とパディングを 1 本のレジスタとして読み込む
+    Register get_register() const { return Simd::load(&x); }
+
+    // ベクトル同士の演算
+    inline Vec3T<T> operator+(const Vec3T<T> &u) const { return Vec3T<T>(Simd::add(get_register(), u.get_register())); }
+    inline Vec3T<T> operator+=(const Vec3T<T> &u) { return assign(Simd::add(get_register(), u.get_register())); }
+    inline Vec3T<T> operator-(const Vec3T<T> &u) const { return Vec3T<T>(Simd::sub(get_register(), u.get_register())); }
+    inline Vec3T<T> operator-=(const Vec3T<T> &u) { return assign(Simd::sub(get_register(), u.get_register())); }
+    inline Vec3T<T> operator*(const Vec3T<T> &u) const { return Vec3T<T>(Simd::mul(get_register(), u.get_register())); }
+    inline Vec3T<T> operator*=(const Vec3T<T> &u) { return assign(Simd::mul(get_register(), u.get_register())); }
+    inline Vec3T<T> operator/(const Vec3T<T> &u) const { return Vec3T<T>(Simd::div(get_register(), u.get_register())); }
+    inline Vec3T<T> operator/=(const Vec3T<T> &u) { return assign(Simd::div(get_register(), u.get_register())); }
+
+    // ベクトルとスカラーの演算
+    inline Vec3T<T> operator+(const T s) const { return Vec3T<T>(Simd::add(get_register(), Simd::set1(s))); }
+    inline friend Vec3T<T> operator+(const T s, const Vec3T<T> &u) { return Vec3T<T>(Simd::add(Simd::set1(s), u.get_register())); }
+    inline Vec3T<T> operator+=(const T s) { return assign(Simd::add(get_register(), Simd::set1(s))); }
+    inline Vec3T<T> operator-(const T s) const { return Vec3T<T>(Simd::sub(get_register(), Simd::set1(s))); }
+    inline friend Vec3T<T> operator-(const T s, const Vec3T<T> &u) { return Vec3T<T>(Simd::sub(Simd::set1(s), u.get_register())); }
+    inline Vec3T<T> operator-=(const T s) { return assign(Simd::sub(get_register(), Simd::set1(s))); }
+    inline Vec3T<T> operator*(const T s) const { return Vec3T<T>(Simd::mul(get_register(), Simd::set1(s))); }
+    inline friend Vec3T<T> operator*(const T s, const Vec3T<T> &u) { return Vec3T<T>(Simd::mul(Simd::set1(s), u.get_register())); }
+    inline Vec3T<T> operator*=(const T s) { return assign(Simd::mul(get_register(), Simd::set1(s))); }
+    inline Vec3T<T> operator/(const T s) const { return Vec3T<T>(Simd::div(get_register(), Simd::set1(s))); }
+    inline friend Vec3T<T> operator/(const T s, const Vec3T<T> &u) { return Vec3T<T>(Simd::div(Simd::set1(s), u.get_register())); }
+    inline Vec3T<T> operator/=(const T s) { return assign(Simd::div(get_register(), Simd::set1(s))); }
+
+    // イコール演算子（パディングは比較しない）
+    inline bool operator==(const Vec3T<T> &u) const { return Simd::equal(get_register(), u.get_register()); }
+
+    // 軸番号（0: x, 1: y, 2: z）による成分の取得
+    inline T operator[](const int axis) const
+    {
+        return axis == 0 ? x : (axis == 1 ? y : z);
+    }
+
+    // マイナス演算
+    inline Vec3T<T> operator-() const { return Vec3T<T>(Simd::negate(get_register())); }
+
+    // ノルム値
+    T norm() const
+    {
+        return std::sqrt(Simd::dot(get_register(), get_register()));
+    }
+
+    // 正規化（逆数の平方根を各成分に掛ける）
+    Vec3T<T> normalize() const
+    {
+        return Vec3T<T>(Simd::mul(get_register(), Simd::reciprocal_sqrt(Simd::dot(get_register(), get_register()))));
+    }
+
+    // 内積
+    inline friend T dot(const Vec3T<T> &v1, const Vec3T<T> &v2) { return Simd::dot(v1.get_register(), v2.get_register()); }
+
+    // 外積
+    inline friend Vec3T<T> cross(const Vec3T<T> &v1, const Vec3T<T> &v2) { return Vec3T<T>(Simd::cross(v1.get_register(), v2.get_register())); }
+
+    // コンソール出力
+    inline friend std::ostream &operator<<(std::ostream &stream, const Vec3T<T> &u)
+    {
+        stream << "(" << u.x << ", " << u.y << ", " << u.z << ")";
+        return stream;
+    }
+
+private:
+    Vec3T<T> assign(const Register result)
+    {
+        Simd::store(&x, result);
+        return static_cast<const Vec3T<T> &>(*this);
+    }
+};
+
+#if defined(__AVX2__)
+template <>
+class Vec3T<double> : public SimdVec3T<double>
+{
+public:
+    using SimdVec3T<double>::SimdVec3T;
+};
+static_assert(sizeof(SimdVec3T<double>) == 4 * sizeof(double), "SimdVec3T<double> must be exactly one register wide");
+#endif
+
+#if defined(__SSE__)
+template <>
+class Vec3T<float> : public SimdVec3T<float>
+{
+public:
+    using SimdVec3T<float>::SimdVec3T;
+};
+static_assert(sizeof(SimdVec3T<float>) == 4 * sizeof(float), "SimdVec3T<float> must be exactly one register wide");
+#endif
+
+#endif
@@ -0,0 +1,452 @@
+#ifndef WAVEFRONT_H
+#define WAVEFRONT_H
+
+#include <algorithm>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "aabb.h"
+#include "aggregate.h"
+#include "aligned_allocator.h"
+#include "camera.h"
+#include "color.h"
+#include "framebuffer.h"
+#include "hit.h"
+#include "integrator.h"
+#include "material.h"
+#include "material_variant.h"
+#include "random.h"
+#include "ray.h"
+#include "ray_packet.h"
+#include "renderer.h"
+#include "sphere.h"
+#include "stats.h"
+
+// 追跡中の経路を成分ごとの配列（Structure of Arrays）として保持するキュー
+struct PathQueue
+{
+    AlignedVector<Real> origin_x, origin_y, origin_z;
+    AlignedVector<Real> direction_x, direction_y, direction_z;
+    AlignedVector<Real> throughput_r, throughput_g, throughput_b;
+    std::vector<SampleStream> random; // 経路ごとの SampleStream（深さ優先で追跡した場合と同じ順に値を取り出す）
+    std::vector<int> path_index; // 結果を書き込む radiance の添字
+
+    size_t size() const { return path_index.size(); }
+
+    void clear()
+    {
+        origin_x.clear();
+        origin_y.clear();
+        origin_z.clear();
+        direction_x.clear();
+        direction_y.clear();
+        direction_z.clear();
+        throughput_r.clear();
+        throughput_g.clear();
+        throughput_b.clear();
+        random.clear();
+        path_index.clear();
+    }
+
+    void push(const Ray &ray, const Color &throughput, const SampleStream &path_random, const int path)
+    {
+        const Vec3 o = ray.get_origin();
+        const Vec3 d = ray.get_direction();
+        origin_x.push_back(o.x);
+        origin_y.push_back(o.y);
+        origin_z.push_back(o.z);
+        direction_x.push_back(d.x);
+        direction_y.push_back(d.y);
+        direction_z.push_back(d.z);
+        throughput_r.push_back(throughput.r);
+        throughput_g.push_back(throughput.g);
+        throughput_b.push_back(throughput.b);
+        random.push_back(path_random);
+        path_index.push_back(path);
+    }
+
+    Ray get_ray(const int i) const
+    {
+        return Ray::from_normalized(Vec3(origin_x[i], origin_y[i], origin_z[i]), Vec3(direction_x[i], direction_y[i], direction_z[i]));
+    }
+
+    Color get_throughput(const int i) const
+    {
+        return Color(throughput_r[i], throughput_g[i], throughput_b[i]);
+    }
+
+    // other の i 番目の経路を末尾に追加
+    void push(const PathQueue &other, const int i)
+    {
+        origin_x.push_back(other.origin_x[i]);
+        origin_y.push_back(other.origin_y[i]);
+        origin_z.push_back(other.origin_z[i]);
+        direction_x.push_back(other.direction_x[i]);
+        direction_y.push_back(other.direction_y[i]);
+        direction_z.push_back(other.direction_z[i]);
+        throughput_r.push_back(other.throughput_r[i]);
+        throughput_g.push_back(other.throughput_g[i]);
+        throughput_b.push_back(other.throughput_b[i]);
+        random.push_back(other.random[i]);
+        path_index.push_back(other.path_index[i]);
+    }
+};
+
+// 経路を 1 本ずつ最後まで追跡する代わりに，多数の経路をまとめて
+// 交差判定 → マテリアルごとのシェーディング → 次のレイのキューへの追加 の段階ごとに一括処理するパストレーサ
+// 各段階の処理が同種の多数の要素に対する単純なループとなるため，BVH やマテリアルのデータがキャッシュに載り続ける
+// 経路ごとの乱数生成器と演算の順序は PathIntegrator::trace と同じであり，同じ画像が得られる
+// カメラからのレイと，鏡面で 1 回反射したレイは向きが揃っているため，packet_size 本ずつのパケットで交差判定を行う
+// sort_rays を有効にすると，2 回目以降の交差判定の前にレイを方向の象限と始点の位置で並べ替え，近いレイを続けて判定する
+class WavefrontIntegrator
+{
+private:
+    // 物体と衝突した経路（シェーディング待ち）
+    struct HitItem
+    {
+        int queue_index; // PathQueue 内の添字
+        Hit hit;
+    };
+
+    // MaterialVariant の各型に加えて，閉じた集合に含まれないマテリアル（仮想関数で呼び出す）の分だけキューを用意する
+    static constexpr int VIRTUAL_MATERIAL_QUEUE{static_cast<int>(std::variant_size_v<MaterialVariant>)};
+    static constexpr int MATERIAL_QUEUE_COUNT{VIRTUAL_MATERIAL_QUEUE + 1};
+
+public:
+    // ワーカーごとの作業領域（タイルをまたいで再利用し，メモリ確保を初回のみに抑える）
+    struct Workspace
+    {
+        PathQueue current, next;
+        std::vector<HitItem> hit_queues[MATERIAL_QUEUE_COUNT];
+        std::vector<Color> radiance;    // 経路ごとの結果（打ち切られた経路は黒のまま）
+        std::vector<Color> pixel_sums;  // タイル内のピクセルごとの寄与の和
+        int coherent_begin{0}, coherent_end{0}; // current のうち，パケットで交差判定を行う範囲
+        std::vector<int> sort_keys, sort_order, bin_offsets; // レイの並べ替えに用いる
+        long long num_rays{0};                                // 追跡したレイの本数（交差判定の回数）
+    };
+
+private:
+    int max_depth;
+    int russian_roulette_depth;
+    int max_paths;   // 一度に追跡する経路数の上限
+    int packet_size; // パケットのレイの本数（0 の場合は常に 1 本ずつ交差判定を行う）
+    bool sort_rays;  // 交差判定の前にレイを並べ替えるか
+
+    // MaterialVariant の値を持たない球（マテリアルを持たない球や，get_material を上書きした派生クラス）は，
+    // get_material を仮想関数で呼び出すキューへ振り分ける
+    static int get_material_queue(const Sphere *sphere)
+    {
+        const MaterialVariant *material = sphere->get_material_variant();
+        return material ? static_cast<int>(material->index()) : VIRTUAL_MATERIAL_QUEUE;
+    }
+
+    // 衝突しなかった経路は空の色で確定し，衝突した経路はマテリアルごとのキューへ振り分ける
+    static void classify(Workspace &workspace, const int i, const Ray &ray, const std::optional<Hit> &result)
+    {
+        PathQueue &queue = workspace.current;
+        if (!result)
+        {
+            workspace.radiance[queue.path_index[i]] = queue.get_throughput(i) * PathIntegrator::background(ray);
+            return;
+        }
+        workspace.hit_queues[get_material_queue(result->get_sphere())].push_back(HitItem{i, *result});
+    }
+
+    // current[begin, end) を 1 本ずつ交差判定する
+    static void intersect_rays(Workspace &workspace, const Aggregate &world, const int begin, const int end)
+    {
+        for (int i = begin; i < end; i++)
+        {
+            const Ray ray = workspace.current.get_ray(i);
+            classify(workspace, i, ray, world.intersect(ray));
+        }
+    }
+
+    // current[begin, end) を N 本ずつのパケットにまとめて交差判定する（N 本に満たない端数は 1 本ずつ判定する）
+    template <int N>
+    static void intersect_packets(Workspace &workspace, const Aggregate &world, const int begin, const int end)
+    {
+        RayPacket<N> packet;
+        std::optional<Hit> hits[N];
+        int i = begin;
+        for (; i + N <= end; i += N)
+        {
+            packet.clear();
+            for (int k = 0; k < N; k++)
+                packet.add(workspace.current.get_ray(i + k));
+            world.intersect(packet, hits);
+            for (int k = 0; k < N; k++)
+                classify(workspace, i + k, packet.get_ray(k), hits[k]);
+        }
+        intersect_rays(workspace, world, i, end);
+    }
+
+    // current[begin, end) のレイを 方向の象限 → 始点を含む格子のセル の順に並べたときの順序を sort_order に追加する
+    // セルは範囲内の始点を囲む直方体を SORT_GRID_RESOLUTION^3 個に分割したもので，同じビン内の順序は保つ
+    static void sort_range(Workspace &workspace, const int begin, const int end)
+    {
+        const PathQueue &queue = workspace.current;
+        AABB origin_bounds;
+        for (int i = begin; i < end; i++)
+            origin_bounds.expand(Vec3(queue.origin_x[i], queue.origin_y[i], queue.origin_z[i]));
+
+        auto cell = [&](const double v, const int axis)
+        {
+            const double extent = origin_bounds.upper[axis] - origin_bounds.lower[axis];
+            if (extent <= .0)
+                return 0;
+            const int c = static_cast<int>(SORT_GRID_RESOLUTION * (v - origin_bounds.lower[axis]) / extent);
+            return std::min(std::max(c, 0), SORT_GRID_RESOLUTION - 1);
+        };
+
+        std::vector<int> &offsets = workspace.bin_offsets;
+        offsets.assign(SORT_BIN_COUNT + 1, 0);
+        workspace.sort_keys.resize(queue.size());
+        for (int i = begin; i < end; i++)
+        {
+            const int octant = (queue.direction_x[i] < 0 ? 1 : 0) | (queue.direction_y[i] < 0 ? 2 : 0) | (queue.direction_z[i] < 0 ? 4 : 0);
+            const int cell_index = (cell(queue.origin_z[i], 2) * SORT_GRID_RESOLUTION + cell(queue.origin_y[i], 1)) * SORT_GRID_RESOLUTION + cell(queue.origin_x[i], 0);
+            const int key = octant * SORT_GRID_RESOLUTION * SORT_GRID_RESOLUTION * SORT_GRID_RESOLUTION + cell_index;
+            workspace.sort_keys[i] = key;
+            offsets[key + 1]++;
+        }
+        for (int b = 0; b < SORT_BIN_COUNT; b++)
+            offsets[b + 1] += offsets[b];
+
+        const int order_begin = static_cast<int>(workspace.sort_order.size());
+        workspace.sort_order.resize(order_begin + (end - begin));
+        for (int i = begin; i < end; i++)
+            workspace.sort_order[order_begin + offsets[workspace.sort_keys[i]]++] = i;
+    }
+
+    // パケットで判定する範囲を除いたレイを並べ替える（パケットで判定する範囲の位置は変わらない）
+    static void sort_stage(Workspace &workspace)
+    {
+        const int begin = workspace.coherent_begin;
+        const int end = workspace.coherent_end;
+        const int size = static_cast<int>(workspace.current.size());
+        workspace.sort_order.clear();
+        sort_range(workspace, 0, begin);
+        for (int i = begin; i < end; i++)
+            workspace.sort_order.push_back(i);
+        sort_range(workspace, end, size);
+
+        for (const int i : workspace.sort_order)
+            workspace.next.push(workspace.current, i);
+        std::swap(workspace.current, workspace.next);
+        workspace.next.clear();
+    }
+
+    // 交差判定の段階
+    void intersect_stage(Workspace &workspace, const Aggregate &world) const
+    {
+        const int begin = workspace.coherent_begin;
+        const int end = workspace.coherent_end;
+        intersect_rays(workspace, world, 0, begin);
+        switch (packet_size)
+        {
+        case 4:
+            intersect_packets<4>(workspace, world, begin, end);
+            break;
+        case 8:
+            intersect_packets<8>(workspace, world, begin, end);
+            break;
+        case 16:
+            intersect_packets<16>(workspace, world, begin, end);
+            break;
+        default:
+            intersect_rays(workspace, world, begin, end);
+            break;
+        }
+        intersect_rays(workspace, world, end, static_cast<int>(workspace.current.size()));
+    }
+
+    // シェーディングと延長の段階 : 同じ種類のマテリアルをまとめて処理し，継続する経路を次のキューへ追加する
+    // get_material(sphere) は，このキューに属する球から具象マテリアルへの参照を取り出す
+    template <typename GetMaterialFunction>
+    void shade_stage(Workspace &workspace, std::vector<HitItem> &hits, const int depth, const GetMaterialFunction &get_material) const
+    {
+        RAYTRACING_STATS_PHASE(Shade);
+        PathQueue &queue = workspace.current;
+        for (const HitItem &item : hits)
+        {
+            const int i = item.queue_index;
+            const auto &material = get_material(item.hit.get_sphere());
+            SampleStream &random = queue.random[i];
+
+            const Ray next_ray = [&]
+            {
+                RAYTRACING_STATS_TIMER(sample_ray_timer);
+                return material.sample_ray(queue.get_ray(i), item.hit, random);
+            }();
+            Color throughput = queue.get_throughput(i);
+            throughput *= material.get_brdf();
+
+            if (russian_roulette_depth >= 0 && depth + 1 >= russian_roulette_depth)
+            {
+                const double p = PathIntegrator::survival_probability(throughput);
+                if (random.next_double() >= p)
+                {
+                    RAYTRACING_STATS_ADD(russian_roulette_terminations, 1);
+                    RAYTRACING_STATS_PATHS(depth + 1, 1);
+                    continue;
+                }
+                throughput /= p;
+            }
+            workspace.next.push(next_ray, throughput, random, queue.path_index[i]);
+        }
+        hits.clear();
+    }
+
+    // MaterialVariant の MaterialIndex 番目の型のキューを処理する
+    // カメラからのレイが鏡面で反射したレイは次のキューで連続するため，その範囲をパケットで判定する対象として記録する
+    template <std::size_t MaterialIndex>
+    void shade_variant_stage(Workspace &workspace, const int depth) const
+    {
+        const int next_begin = static_cast<int>(workspace.next.size());
+        shade_stage(workspace, workspace.hit_queues[MaterialIndex], depth, [](const Sphere *sphere) -> const auto &
+                    { return std::get<MaterialIndex>(*sphere->get_material_variant()); });
+        if (std::is_same_v<std::variant_alternative_t<MaterialIndex, MaterialVariant>, Mirror> && depth == 0)
+        {
+            workspace.coherent_begin = next_begin;
+            workspace.coherent_end = static_cast<int>(workspace.next.size());
+        }
+    }
+
+    template <std::size_t... MaterialIndices>
+    void shade_variant_stages(Workspace &workspace, const int depth, std::index_sequence<MaterialIndices...>) const
+    {
+        (shade_variant_stage<MaterialIndices>(workspace, depth), ...);
+    }
+
+    // バッチ内の全ての経路を，終了するか最大バウンス数に達するまで段階ごとに追跡する
+    void trace_batch(Workspace &workspace, const Aggregate &world) const
+    {
+        // カメラからのレイは全てパケットで判定する
+        workspace.coherent_begin = 0;
+        workspace.coherent_end = static_cast<int>(workspace.current.size());
+        for (int depth = 0; depth <= max_depth && workspace.current.size() > 0; depth++)
+        {
+            if (sort_rays && depth > 0)
+                sort_stage(workspace);
+            workspace.num_rays += static_cast<long long>(workspace.current.size());
+            intersect_stage(workspace, world);
+#if defined(RAYTRACING_STATS)
+            long long num_hits = 0;
+            for (const std::vector<HitItem> &hits : workspace.hit_queues)
+                num_hits += static_cast<long long>(hits.size());
+            RAYTRACING_STATS_PATHS(depth, static_cast<long long>(workspace.current.size()) - num_hits);
+#endif
+            workspace.coherent_begin = workspace.coherent_end = 0;
+            shade_variant_stages(workspace, depth, std::make_index_sequence<std::variant_size_v<MaterialVariant>>());
+            shade_stage(workspace, workspace.hit_queues[VIRTUAL_MATERIAL_QUEUE], depth, [](const Sphere *sphere) -> const Material &
+                        { return *sphere->get_material(); });
+            std::swap(workspace.current, workspace.next);
+            workspace.next.clear();
+        }
+        // 最大バウンス数に達した経路
+        RAYTRACING_STATS_ADD(depth_limit_terminations, static_cast<long long>(workspace.current.size()));
+        RAYTRACING_STATS_PATHS(max_depth + 1, static_cast<long long>(workspace.current.size()));
+        workspace.current.clear();
+    }
+
+public:
+    static constexpr int DEFAULT_MAX_PATHS{1 << 14};
+    static constexpr int DEFAULT_PACKET_SIZE{PathIntegrator::DEFAULT_PACKET_SIZE};
+    static constexpr int SORT_GRID_RESOLUTION{4};
+    static constexpr int SORT_BIN_COUNT{8 * SORT_GRID_RESOLUTION * SORT_GRID_RESOLUTION * SORT_GRID_RESOLUTION};
+
+    // コンストラクタ
+    // packet_size には 0（パケットを用いない），4，8，16 のいずれかを指定する
+    WavefrontIntegrator(
+        const int _max_depth = PathIntegrator::DEFAULT_MAX_DEPTH,
+        const int _russian_roulette_depth = PathIntegrator::DEFAULT_RUSSIAN_ROULETTE_DEPTH,
+        const int _max_paths = DEFAULT_MAX_PATHS,
+        const int _packet_size = DEFAULT_PACKET_SIZE,
+        const bool _sort_rays = false)
+        : max_depth(_max_depth),
+          russian_roulette_depth(_russian_roulette_depth),
+          max_paths(std::max(1, _max_paths)),
+          packet_size(_packet_size),
+          sort_rays(_sort_rays)
+    {
+        if (_packet_size != 0 && _packet_size != 4 && _packet_size != 8 && _packet_size != 16)
+        {
+            throw packet_size_exception();
+        }
+    }
+
+    // ゲッター
+    int get_max_depth() const { return max_depth; }
+    int get_russian_roulette_depth() const { return russian_roulette_depth; }
+    int get_max_paths() const { return max_paths; }
+    int get_packet_size() const { return packet_size; }
+    bool get_sort_rays() const { return sort_rays; }
+
+    // タイル内の全ピクセルについて samples_per_pixel 本ずつ経路を追跡し，平均を framebuffer に書き込む
+    // サンプルの値は renderer の標本列とフレーム番号から決める
+    // 経路数が max_paths を超える場合は，サンプル番号の小さい順に複数のバッチに分けて追跡する
+    void render_tile(const Renderer &renderer, const Camera &camera, const Aggregate &world, const Tile &tile, const int samples_per_pixel,
+                     const FrameBufferView &framebuffer, Workspace &workspace) const
+    {
+        const int tile_width = tile.x_end - tile.x_begin;
+        const int pixel_count = tile_width * (tile.y_end - tile.y_begin);
+        const int batch_samples = std::max(1, std::min(samples_per_pixel, max_paths / std::max(1, pixel_count)));
+        workspace.pixel_sums.assign(pixel_count, Color(0));
+
+        for (int sample_begin = 0; sample_begin < samples_per_pixel; sample_begin += batch_samples)
+        {
+            const int sample_count = std::min(batch_samples, samples_per_pixel - sample_begin);
+
+            // カメラからのレイを生成する（経路の番号は ピクセル番号 * sample_count + サンプル番号）
+            workspace.radiance.assign(pixel_count * sample_count, Color(0));
+            for (int p = 0; p < pixel_count; p++)
+            {
+                const int x = tile.x_begin + p % tile_width;
+                const int y = tile.y_begin + p / tile_width;
+                for (int s = 0; s < sample_count; s++)
+                {
+                    SampleStream random = renderer.make_sample_stream(x, y, sample_begin + s);
+                    const Ray ray = camera.get_ray(x, y, random);
+                    workspace.current.push(ray, Color(1), random, p * sample_count + s);
+                }
+            }
+
+            trace_batch(workspace, world);
+
+            // 深さ優先の場合と同じく，サンプル番号の順に足し合わせる
+            for (int p = 0; p < pixel_count; p++)
+            {
+                for (int s = 0; s < sample_count; s++)
+                {
+                    workspace.pixel_sums[p] += workspace.radiance[p * sample_count + s];
+                }
+            }
+        }
+
+        for (int p = 0; p < pixel_count; p++)
+        {
+            framebuffer.set_pixel(tile.x_begin + p % tile_width, tile.y_begin + p / tile_width, workspace.pixel_sums[p] / samples_per_pixel);
+        }
+    }
+
+    // renderer のスレッドでタイルごとに render_tile を実行し，カメラの画像に書き込む
+    // 追跡したレイの本数（PathIntegrator::trace が num_rays に返す値の全サンプルの和と同じ）を返す
+    long long render(Renderer &renderer, Camera &camera, const int samples_per_pixel, const Aggregate &world) const
+    {
+        std::vector<Workspace> workspaces(renderer.get_num_threads());
+        const FrameBufferView framebuffer = camera.get_framebuffer();
+        renderer.render_tiles(framebuffer, [&](const Tile &tile, const int worker_id)
+                              { render_tile(renderer, camera, world, tile, samples_per_pixel, framebuffer, workspaces[worker_id]); });
+        long long num_rays = 0;
+        for (const Workspace &workspace : workspaces)
+            num_rays += workspace.num_rays;
+        return num_rays;
+    }
+
+    using packet_size_exception = PathIntegrator::packet_size_exception;
+};
+
+#endif
@@ -1,6 +1,7 @@
 #include <iostream>
 #include "../header/image.h"
 #include "../header/ray.h"
+#include "../header/renderer.h"
 
 Color ray_color(const Ray &r)
 {
@@ -24,16 +25,13 @@ int main()
     Vec3 vertical = Vec3(0, viewport_height, 0);
     Vec3 left_lower_corner = origin - horizon / 2 - vertical / 2 - Vec3(0, 0, focal_length);
 
-    for (int h = 0; h < image_height; h++)
+    Renderer renderer;
+    renderer.render(image, [&](const int w, const int h)
     {
-        for (int w = 0; w < image_width; w++)
-        {
-            double u = (double(w) + 0.5) / double(image_width);
-            double v = 1.0 - (double(h) + 0.5) / double(image_height);
-            Ray r(origin, left_lower_corner + u * horizon + v * vertical - origin);
-            Color pixel_color = ray_color(r);
-            image.set_pixel(w, h, pixel_color);
-        }
-    }
+        double u = (double(w) + 0.5) / double(image_width);
+        double v = 1.0 - (double(h) + 0.5) / double(image_height);
+        Ray r(origin, left_lower_corner + u * horizon + v * vertical - origin);
+        return ray_color(r);
+    });
     image.save_png("../image/01_ray_injection.png");
 }
@@ -4,7 +4,8 @@
 #include "../header/hit.h"
 #include "../header/image.h"
 #include "../header/ray.h"
-#include "../header/sphere.h"
+#include "../header/renderer.h"
+#include "../header/scenes.h"
 
 Color ray_color(const Ray &r, const Aggregate& world)
 {
@@ -35,19 +36,16 @@ int main()
     Vec3 left_lower_corner = origin - horizon / 2 - vertical / 2 - Vec3(0, 0, focal_length);
 
     Aggregate world;
-    world.add(std::make_shared<Sphere>(Vec3(0, 0, -1), 0.5));
-    world.add(std::make_shared<Sphere>(Vec3(0, -100.5, -1), 100));
+    add_sphere_on_ground(world);
+    world.build();
 
-    for (int h = 0; h < image_height; h++)
+    Renderer renderer;
+    renderer.render(image, [&](const int w, const int h)
     {
-        for (int w = 0; w < image_width; w++)
-        {
-            double u = (double(w) + 0.5) / double(image_width);
-            double v = 1.0 - (double(h) + 0.5) / double(image_height);
-            Ray r(origin, left_lower_corner + u * horizon + v * vertical - origin);
-            Color pixel_color = ray_color(r, world);
-            image.set_pixel(w, h, pixel_color);
-        }
-    }
+        double u = (double(w) + 0.5) / double(image_width);
+        double v = 1.0 - (double(h) + 0.5) / double(image_height);
+        Ray r(origin, left_lower_corner + u * horizon + v * vertical - origin);
+        return ray_color(r, world);
+    });
     image.save_png("../image/02_sphere_intersect.png");
 }
@@ -3,7 +3,8 @@
 #include "../header/aggregate.h"
 #include "../header/camera.h"
 #include "../header/ray.h"
-#include "../header/sphere.h"
+#include "../header/renderer.h"
+#include "../header/scenes.h"
 #include "../header/util.h"
 
 Color ray_color(const Ray &r, const Aggregate& world)
@@ -25,22 +26,13 @@ int main()
     PinholeCamera camera(image_width, image_height);
 
     Aggregate world;
-    world.add(std::make_shared<Sphere>(Vec3(0, 0, -1), 0.5));
-    world.add(std::make_shared<Sphere>(Vec3(0, -100.5, -1), 100));
+    add_sphere_on_ground(world);
+    world.build();
 
     const int samples_per_pixel = 100;
 
-    for (int h = 0; h < image_height; h++)
-    {
-        for (int w = 0; w < image_width; w++)
-        {
-            Color pixel_color(0);
-            for (int s = 0; s < samples_per_pixel; s++) {
-                Ray r = camera.get_ray(w, h);
-                pixel_color += ray_color(r, world);
-            }
-            camera.get_image().set_pixel(w, h, pixel_color / samples_per_pixel);
-        }
-    }
+    Renderer renderer;
+    renderer.render(camera, samples_per_pixel, [&](const Ray &r, SampleStream &)
+                    { return ray_color(r, world); });
     camera.get_image().save_png("../image/03_anti_aliasing.png");
 }
@@ -1,29 +1,14 @@
 #include <iostream>
-#include <optional>
+#include "../header/accumulation_buffer.h"
+#include "../header/adaptive_sampler.h"
 #include "../header/aggregate.h"
 #include "../header/camera.h"
+#include "../header/integrator.h"
 #include "../header/ray.h"
-#include "../header/sphere.h"
+#include "../header/renderer.h"
+#include "../header/scenes.h"
 #include "../header/util.h"
 
-Color ray_color(const Ray &r, const Aggregate &world, int interaction_count = 0)
-{
-    const int max_interaction_count = 10;
-    if (interaction_count > max_interaction_count)
-        return Color();
-
-    std::optional<Hit> result = world.intersect(r);
-    if (result)
-    {
-        Hit hit = *result;
-        const Sphere *sphere = hit.get_sphere();
-        Ray ray = sphere->get_material()->sample_ray(r, hit);
-        return sphere->get_material()->get_brdf() * ray_color(ray, world, interaction_count + 1);
-    }
-    auto t = 0.5 * (r.get_direction().y + 1.0);
-    return (1.0 - t) * Color(1) + t * Color(0.5, 0.7, 1.0);
-}
-
 int main()
 {
     const int image_width = 640;
@@ -37,25 +22,18 @@ int main()
 
     Aggregate world;
     double radius = cos(M_PI / 4);
-    world.add(std::make_shared<MaterializedSphere>(Vec3(0, 0, -1), 0.5, std::make_shared<Lambertian>(Color(0.1, 0.2, 0.5))));
-    world.add(std::make_shared<MaterializedSphere>(Vec3(1, 0, -1), 0.5, std::make_shared<Mirror>(Color(0.8, 0.6, 0.2))));
-    world.add(std::make_shared<MaterializedSphere>(Vec3(-1, 0, -1), 0.5, std::make_shared<Glass>(1.5)));
-    world.add(std::make_shared<MaterializedSphere>(Vec3(0, -100.5, -1), 100, std::make_shared<Lambertian>(Color(0.8, 0.8, 0.0))));
+    add_three_spheres(world);
+    world.build();
 
-    const int samples_per_pixel = 100;
+    // ピクセルごとに 16 ~ 100 サンプルの範囲で，輝度の信頼区間の半幅が平均の 5% 未満となるまで追跡する
+    const AdaptiveSampler sampler(16, 100, 0.05);
+    AccumulationBuffer accumulation(image_width, image_height);
 
-    for (int h = 0; h < image_height; h++)
-    {
-        for (int w = 0; w < image_width; w++)
-        {
-            Color pixel_color(0);
-            for (int s = 0; s < samples_per_pixel; s++)
-            {
-                Ray r = camera.get_ray(w, h);
-                pixel_color += ray_color(r, world);
-            }
-            camera.get_image().set_pixel(w, h, pixel_color / samples_per_pixel);
-        }
-    }
+    PathIntegrator integrator;
+    Renderer renderer;
+    renderer.render(camera, sampler, accumulation, [&](const Ray &r, SampleStream &random)
+                    { return integrator.trace(r, world, random); });
+    std::cout << "samples per pixel : " << double(accumulation.get_total_samples()) / (image_width * image_height) << std::endl;
+    accumulation.make_sample_heatmap(sampler.get_max_samples()).save_png("../image/05-03_sample_heatmap.png");
     camera.get_image().save_png("../image/05-03_camera_contrast.png");
 }
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include <limits>
+#include "../header/aabb.h"
+
+/**
+ * AABB クラスのテスト
+ */
+// 空の直方体の確認
+TEST(AABBTest, DefaultConstructorIsEmpty)
+{
+    AABB box;
+    EXPECT_TRUE(box.is_empty());
+    EXPECT_DOUBLE_EQ(box.get_surface_area(), 0.0);
+}
+
+// 点・直方体による拡張の確認
+TEST(AABBTest, Expand)
+{
+    AABB box;
+    box.expand(Vec3(1, 2, 3));
+    EXPECT_FALSE(box.is_empty());
+    EXPECT_EQ(box.lower, Vec3(1, 2, 3));
+    EXPECT_EQ(box.upper, Vec3(1, 2, 3));
+
+    box.expand(Vec3(-1, 5, 0));
+    EXPECT_EQ(box.lower, Vec3(-1, 2, 0));
+    EXPECT_EQ(box.upper, Vec3(1, 5, 3));
+
+    box.expand(AABB(Vec3(0, 0, 0), Vec3(4, 1, 1)));
+    EXPECT_EQ(box.lower, Vec3(-1, 0, 0));
+    EXPECT_EQ(box.upper, Vec3(4, 5, 3));
+}
+
+// 中心・表面積・最長軸の確認
+TEST(AABBTest, Properties)
+{
+    AABB box(Vec3(0, 0, 0), Vec3(1, 2, 3));
+    EXPECT_EQ(box.get_center(), Vec3(0.5, 1, 1.5));
+    EXPECT_DOUBLE_EQ(box.get_surface_area(), 2.0 * (2 + 6 + 3));
+    EXPECT_EQ(box.get_longest_axis(), 2);
+    EXPECT_EQ(AABB(Vec3(0), Vec3(5, 1, 1)).get_longest_axis(), 0);
+    EXPECT_EQ(AABB(Vec3(0), Vec3(1, 5, 1)).get_longest_axis(), 1);
+}
+
+// レイとの交差判定の確認
+TEST(AABBTest, Intersect)
+{
+    AABB box(Vec3(-1), Vec3(1));
+    const double inf = std::numeric_limits<double>::infinity();
+    Real t_entry;
+
+    // 正面から交差
+    EXPECT_TRUE(box.intersect(Vec3(0, 0, -5), Vec3(inf, inf, 1), 0.0, inf, t_entry));
+    EXPECT_DOUBLE_EQ(t_entry, 4.0);
+
+    // 外れる
+    EXPECT_FALSE(box.intersect(Vec3(0, 3, -5), Vec3(inf, inf, 1), 0.0, inf, t_entry));
+
+    // 交差範囲より遠い
+    EXPECT_FALSE(box.intersect(Vec3(0, 0, -5), Vec3(inf, inf, 1), 0.0, 3.0, t_entry));
+
+    // 内部から
+    EXPECT_TRUE(box.intersect(Vec3(0), Vec3(1, inf, inf), 0.0, inf, t_entry));
+    EXPECT_DOUBLE_EQ(t_entry, 0.0);
+
+    // 後ろ向き
+    EXPECT_FALSE(box.intersect(Vec3(0, 0, -5), Vec3(inf, inf, -1), 0.0, inf, t_entry));
+}
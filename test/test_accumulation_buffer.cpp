@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "../header/accumulation_buffer.h"
+#include "../header/image.h"
+
+/**
+ * PixelStatistics 構造体のテスト
+ */
+// 平均と分散が全サンプルから直接求めた値と一致することを確認
+TEST(PixelStatisticsTest, MeanAndVariance)
+{
+    PixelStatistics pixel;
+    EXPECT_EQ(pixel.get_mean(), Color(0));
+    EXPECT_DOUBLE_EQ(pixel.get_variance(), 0.0);
+
+    const double values[] = {0.1, 0.7, 0.4, 0.9, 0.2};
+    double sum = 0;
+    for (const double v : values)
+    {
+        pixel.add(Color(v));
+        sum += v;
+    }
+    const double mean = sum / 5;
+    double squared_sum = 0;
+    for (const double v : values)
+        squared_sum += (v - mean) * (v - mean);
+
+    EXPECT_EQ(pixel.count, 5);
+    EXPECT_NEAR(pixel.get_mean().g, mean, 1e-12);
+    // 灰色の輝度は色の値に等しい
+    EXPECT_NEAR(pixel.mean_luminance, mean, 1e-12);
+    EXPECT_NEAR(pixel.get_variance(), squared_sum / 4, 1e-12);
+    EXPECT_NEAR(pixel.get_standard_error(), std::sqrt(squared_sum / 4 / 5), 1e-12);
+}
+
+// 輝度の重みの確認
+TEST(PixelStatisticsTest, Luminance)
+{
+    EXPECT_NEAR(PixelStatistics::luminance(Color(1.0)), 1.0, 1e-12);
+    EXPECT_GT(PixelStatistics::luminance(Color(0, 1, 0)), PixelStatistics::luminance(Color(1, 0, 0)));
+    EXPECT_GT(PixelStatistics::luminance(Color(1, 0, 0)), PixelStatistics::luminance(Color(0, 0, 1)));
+}
+
+/**
+ * AccumulationBuffer クラスのテスト
+ */
+// サンプルの平均が画像に書き込まれることを確認
+TEST(AccumulationBufferTest, Resolve)
+{
+    AccumulationBuffer buffer(4, 3);
+    EXPECT_EQ(buffer.get_width(), 4);
+    EXPECT_EQ(buffer.get_height(), 3);
+    buffer.add_sample(1, 2, Color(0.2, 0.4, 0.6));
+    buffer.add_sample(1, 2, Color(0.4, 0.6, 0.8));
+    buffer.add_sample(3, 0, Color(1.0));
+    EXPECT_EQ(buffer.get_total_samples(), 3);
+
+    Image image(4, 3);
+    image.set_pixel(0, 0, Color(0.9));
+    buffer.resolve(FrameBufferView(image));
+    EXPECT_NEAR(image.get_pixel(1, 2).r, 0.3, 1e-12);
+    EXPECT_NEAR(image.get_pixel(1, 2).g, 0.5, 1e-12);
+    EXPECT_NEAR(image.get_pixel(1, 2).b, 0.7, 1e-12);
+    EXPECT_EQ(image.get_pixel(3, 0), Color(1.0));
+    // サンプルのないピクセルは黒
+    EXPECT_EQ(image.get_pixel(0, 0), Color(0));
+
+    buffer.clear();
+    EXPECT_EQ(buffer.get_total_samples(), 0);
+    EXPECT_EQ(buffer.get_pixel(1, 2).get_mean(), Color(0));
+}
+
+// 大きさの異なる画像への書き込みで例外スローを確認
+TEST(AccumulationBufferTest, ResolveSizeMismatchThrowsException)
+{
+    AccumulationBuffer buffer(4, 3);
+    Image image(3, 4);
+    EXPECT_THROW(buffer.resolve(FrameBufferView(image)), AccumulationBuffer::size_mismatch_exception);
+}
+
+// サンプル数のヒートマップの色を確認
+TEST(AccumulationBufferTest, SampleHeatmap)
+{
+    AccumulationBuffer buffer(3, 1);
+    for (int i = 0; i < 2; i++)
+        buffer.add_sample(1, 0, Color(0));
+    for (int i = 0; i < 6; i++)
+        buffer.add_sample(2, 0, Color(0));
+
+    Image heatmap = buffer.make_sample_heatmap(4);
+    // 0 本は青，上限の半分は緑，上限以上は赤
+    EXPECT_EQ(heatmap.get_pixel(0, 0), Color(0, 0, 1));
+    EXPECT_EQ(heatmap.get_pixel(1, 0), Color(0, 1, 0));
+    EXPECT_EQ(heatmap.get_pixel(2, 0), Color(1, 0, 0));
+}
+
+// 画像全体の相対誤差の確認
+TEST(AccumulationBufferTest, MeanRelativeError)
+{
+    AccumulationBuffer buffer(2, 1);
+    EXPECT_DOUBLE_EQ(buffer.get_mean_relative_error(), 0.0);
+    // 左のピクセルは分散なし，右のピクセルは平均 0.5，標準誤差 0.5
+    buffer.add_sample(0, 0, Color(0.3));
+    buffer.add_sample(0, 0, Color(0.3));
+    buffer.add_sample(1, 0, Color(0.0));
+    buffer.add_sample(1, 0, Color(1.0));
+    EXPECT_NEAR(buffer.get_mean_relative_error(), (0.0 + 0.5 / 0.5) / 2, 1e-9);
+}
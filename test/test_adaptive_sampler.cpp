@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include "../header/adaptive_sampler.h"
+
+/**
+ * AdaptiveSampler クラスのテスト
+ */
+// コンストラクタの動作確認
+TEST(AdaptiveSamplerTest, Constructor)
+{
+    AdaptiveSampler sampler(4, 64, 0.1);
+    EXPECT_EQ(sampler.get_min_samples(), 4);
+    EXPECT_EQ(sampler.get_max_samples(), 64);
+    EXPECT_DOUBLE_EQ(sampler.get_threshold(), 0.1);
+    EXPECT_EQ(sampler.get_batch_size(), AdaptiveSampler::DEFAULT_BATCH_SIZE);
+}
+
+// 無効なサンプル数・閾値で例外スローを確認
+TEST(AdaptiveSamplerTest, InvalidParametersThrowException)
+{
+    EXPECT_THROW(AdaptiveSampler(0, 8, 0.1), AdaptiveSampler::sample_count_exception);
+    EXPECT_THROW(AdaptiveSampler(8, 4, 0.1), AdaptiveSampler::sample_count_exception);
+    EXPECT_THROW(AdaptiveSampler(1, 4, 0.1, 0), AdaptiveSampler::sample_count_exception);
+    EXPECT_THROW(AdaptiveSampler(1, 4, -0.1), AdaptiveSampler::threshold_exception);
+}
+
+// 最小サンプル数に達するまで，収束の判定をしないことを確認
+TEST(AdaptiveSamplerTest, MinSamples)
+{
+    AdaptiveSampler sampler(5, 20, 0.1, 3);
+    PixelStatistics pixel;
+    EXPECT_EQ(sampler.get_next_batch(pixel), 5);
+    pixel.add(Color(0.5));
+    pixel.add(Color(0.5));
+    EXPECT_FALSE(sampler.is_converged(pixel));
+    EXPECT_EQ(sampler.get_next_batch(pixel), 3);
+}
+
+// 分散のないピクセルは収束し，分散の大きいピクセルは最大サンプル数まで追加されることを確認
+TEST(AdaptiveSamplerTest, Convergence)
+{
+    AdaptiveSampler sampler(4, 10, 0.01, 4);
+
+    PixelStatistics flat;
+    for (int i = 0; i < 4; i++)
+        flat.add(Color(0.3));
+    EXPECT_TRUE(sampler.is_converged(flat));
+    EXPECT_EQ(sampler.get_next_batch(flat), 0);
+
+    PixelStatistics noisy;
+    for (int i = 0; i < 4; i++)
+        noisy.add(Color(i % 2 == 0 ? 0.0 : 1.0));
+    EXPECT_FALSE(sampler.is_converged(noisy));
+    EXPECT_EQ(sampler.get_next_batch(noisy), 4);
+    for (int i = 0; i < 4; i++)
+        noisy.add(Color(i % 2 == 0 ? 0.0 : 1.0));
+    // 最大サンプル数を超えないよう端数のみ追加する
+    EXPECT_EQ(sampler.get_next_batch(noisy), 2);
+    noisy.add(Color(0.0));
+    noisy.add(Color(1.0));
+    EXPECT_EQ(sampler.get_next_batch(noisy), 0);
+
+    // 閾値が 0 の場合は分散がなくても最大サンプル数まで追加する
+    AdaptiveSampler exhaustive(4, 10, 0.0);
+    PixelStatistics black;
+    for (int i = 0; i < 4; i++)
+        black.add(Color(0.0));
+    EXPECT_FALSE(exhaustive.is_converged(black));
+}
@@ -95,6 +95,38 @@ TEST(AggregateTest, RayMissesSpheres)
     ASSERT_FALSE(result.has_value()) << "Intersection test failed: Expected nullopt, but got a valid Hit.";
 }
 
+// BVH の構築後も同じ衝突結果が得られることを確認
+TEST(AggregateTest, IntersectRayWithBVH)
+{
+    Vec3 ray_origin(0, 0, -5);
+    Vec3 ray_direction(0, 0, 1);
+    Ray ray(ray_origin, ray_direction);
+
+    Aggregate aggregate;
+    auto s1 = std::make_shared<Sphere>(Vec3(0.0, 0.0, 0.0), 2);
+    auto s2 = std::make_shared<Sphere>(Vec3(0.0, 0.0, 6.0), 3);
+    aggregate.add(s1);
+    aggregate.add(s2);
+    EXPECT_FALSE(aggregate.is_built());
+    aggregate.build();
+    EXPECT_TRUE(aggregate.is_built());
+
+    std::optional<Hit> result = aggregate.intersect(ray);
+    ASSERT_TRUE(result) << "Intersection test failed: Expected a valid Hit, but got nullopt.";
+    Hit hit = *result;
+    EXPECT_EQ(hit.get_distance(), 3);
+    EXPECT_EQ(hit.get_sphere(), s1.get());
+    EXPECT_EQ(hit.get_hit_position(), Vec3(0, 0, -2));
+
+    // 物体を追加すると BVH は破棄され，追加した物体も判定対象となる
+    auto s3 = std::make_shared<Sphere>(Vec3(0.0, 0.0, -3.0), 1);
+    aggregate.add(s3);
+    EXPECT_FALSE(aggregate.is_built());
+    result = aggregate.intersect(ray);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result->get_sphere(), s3.get());
+}
+
 // メイン関数（Google Testのエントリーポイント）
 int main(int argc, char **argv)
 {
@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include "../header/aggregate.h"
+#include "../header/aligned_allocator.h"
+#include "../header/camera.h"
+#include "../header/material.h"
+#include "../header/material_variant.h"
+#include "../header/random.h"
+#include "../header/sphere.h"
+
+// このテストでは，プログラム全体の動的確保の回数を数えるため operator new / delete を置き換える
+// AlignedVector や SIMD 型が用いるアライメント指定付きの確保と，nothrow 版も同じく数える
+namespace
+{
+    std::atomic<long> allocation_count(0);
+
+    void *counted_allocate(std::size_t size)
+    {
+        allocation_count++;
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    void *counted_allocate(std::size_t size, std::align_val_t alignment)
+    {
+        allocation_count++;
+        const std::size_t a = std::max(static_cast<std::size_t>(alignment), sizeof(void *));
+        // aligned_alloc は大きさがアライメントの倍数である必要がある
+        return std::aligned_alloc(a, (std::max<std::size_t>(size, 1) + a - 1) / a * a);
+    }
+
+    // 置き換えた operator delete から直接 free を呼び出すと，インライン展開後に new と free の組み合わせとして警告されるため関数を分ける
+#if defined(__GNUC__)
+    __attribute__((noinline))
+#endif
+    void counted_free(void *p) noexcept
+    {
+        std::free(p);
+    }
+}
+
+void *operator new(std::size_t size)
+{
+    if (void *p = counted_allocate(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    if (void *p = counted_allocate(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return counted_allocate(size); }
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return counted_allocate(size); }
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (void *p = counted_allocate(size, alignment))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+    if (void *p = counted_allocate(size, alignment))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept { return counted_allocate(size, alignment); }
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept { return counted_allocate(size, alignment); }
+
+void operator delete(void *p) noexcept { counted_free(p); }
+void operator delete[](void *p) noexcept { counted_free(p); }
+void operator delete(void *p, std::size_t) noexcept { counted_free(p); }
+void operator delete[](void *p, std::size_t) noexcept { counted_free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { counted_free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { counted_free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { counted_free(p); }
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept { counted_free(p); }
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept { counted_free(p); }
+
+namespace
+{
+    // レイを数バウンス追跡し，マテリアルの取得とサンプリングを行う
+    template <typename Bounce>
+    Color trace_path(const Ray &ray, const Aggregate &world, SampleStream &random, const Bounce &bounce, const int depth = 0)
+    {
+        if (depth >= 4)
+            return Color(1);
+        std::optional<Hit> hit = world.intersect(ray);
+        if (!hit)
+            return Color(1);
+        Color brdf(0);
+        Ray next_ray = bounce(ray, *hit, random, brdf);
+        return brdf * trace_path(next_ray, world, random, bounce, depth + 1);
+    }
+
+    template <typename Bounce>
+    Color trace_rays(const Camera &camera, const Aggregate &world, const Bounce &bounce)
+    {
+        Color sum(0);
+        for (int y = 0; y < 8; y++)
+        {
+            for (int x = 0; x < 8; x++)
+            {
+                SampleStream random = make_sample_stream(x, y, 0);
+                sum += trace_path(camera.get_ray(x, y, random), world, random, bounce);
+            }
+        }
+        return sum;
+    }
+}
+
+/**
+ * レイ 1 本あたりの動的確保の回数のテスト
+ */
+// シーン構築後は，レイの生成・交差判定・マテリアルの取得とサンプリングで動的確保が発生しないことを確認
+TEST(AllocationTest, NoAllocationPerRayInSteadyState)
+{
+    PinholeCamera camera(8, 8);
+    Aggregate world;
+    world.add(std::make_shared<Sphere>(Vec3(0, 0, -1), 0.5));
+    world.add(std::make_shared<Sphere>(Vec3(1, 0, -1), 0.5));
+    world.add(std::make_shared<MaterializedSphere>(Vec3(-1, 0, -1), 0.5, std::make_shared<Mirror>(Color(0.8))));
+    world.add(std::make_shared<MaterializedSphere>(Vec3(0, -100.5, -1), 100, std::make_shared<Lambertian>(Color(0.5))));
+    world.build();
+
+    auto virtual_bounce = [](const Ray &ray, const Hit &hit, SampleStream &random, Color &brdf)
+    {
+        Material *material = hit.get_sphere()->get_material();
+        brdf = material->get_brdf();
+        return material->sample_ray(ray, hit, random);
+    };
+    auto variant_bounce = [](const Ray &ray, const Hit &hit, SampleStream &random, Color &brdf)
+    {
+        const MaterialVariant *material = hit.get_sphere()->get_material_variant();
+        if (material == nullptr)
+        {
+            const Material *virtual_material = hit.get_sphere()->get_material();
+            brdf = virtual_material->get_brdf();
+            return virtual_material->sample_ray(ray, hit, random);
+        }
+        brdf = get_brdf(*material);
+        return sample_ray(*material, ray, hit, random);
+    };
+
+    // 関数内の static 変数の初期化などを済ませる
+    trace_rays(camera, world, virtual_bounce);
+    trace_rays(camera, world, variant_bounce);
+
+    const long before = allocation_count.load();
+    trace_rays(camera, world, virtual_bounce);
+    trace_rays(camera, world, variant_bounce);
+    EXPECT_EQ(allocation_count.load() - before, 0);
+}
+
+// マテリアルを持たない球のマテリアル取得で動的確保が発生しないことを確認
+TEST(AllocationTest, DefaultMaterialLookup)
+{
+    Sphere sphere(Vec3(0), 1.0);
+    sphere.get_material();
+
+    const long before = allocation_count.load();
+    for (int i = 0; i < 1000; i++)
+    {
+        EXPECT_NE(sphere.get_material(), nullptr);
+    }
+    EXPECT_EQ(allocation_count.load() - before, 0);
+}
+
+// アライメント指定付きの確保（AlignedVector）と nothrow 版の確保も数えることを確認
+TEST(AllocationTest, CountsAlignedAllocations)
+{
+    long before = allocation_count.load();
+    {
+        AlignedVector<double> values(16);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(values.data()) % 64, 0u);
+    }
+    EXPECT_EQ(allocation_count.load() - before, 1);
+
+    before = allocation_count.load();
+    int *p = new (std::nothrow) int[4];
+    delete[] p;
+    EXPECT_EQ(allocation_count.load() - before, 1);
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+#include "../header/aggregate.h"
+#include "../header/bvh.h"
+#include "../header/random.h"
+#include "../header/sphere.h"
+#include "../header/util.h"
+
+namespace
+{
+    std::vector<std::shared_ptr<Sphere>> make_random_spheres(const int count, Pcg32 &random)
+    {
+        std::vector<std::shared_ptr<Sphere>> spheres;
+        for (int i = 0; i < count; i++)
+        {
+            Vec3 center(generate_random_in_range(random, -20.0, 20.0), generate_random_in_range(random, -20.0, 20.0), generate_random_in_range(random, -20.0, 20.0));
+            spheres.push_back(std::make_shared<Sphere>(center, generate_random_in_range(random, 0.05, 1.0)));
+        }
+        return spheres;
+    }
+
+    Ray make_random_ray(Pcg32 &random)
+    {
+        Vec3 origin(generate_random_in_range(random, -30.0, 30.0), generate_random_in_range(random, -30.0, 30.0), generate_random_in_range(random, -30.0, 30.0));
+        Vec3 target(generate_random_in_range(random, -10.0, 10.0), generate_random_in_range(random, -10.0, 10.0), generate_random_in_range(random, -10.0, 10.0));
+        return Ray(origin, target - origin);
+    }
+}
+
+/**
+ * BVH クラスのテスト
+ */
+// 空の BVH
+TEST(BVHTest, Empty)
+{
+    BVH bvh;
+    EXPECT_TRUE(bvh.is_empty());
+    EXPECT_FALSE(bvh.intersect(Ray(Vec3(0), Vec3(0, 0, 1))).has_value());
+}
+
+// 全ての物体がちょうど 1 つの葉ノードに含まれ，親ノードが子ノードを包含することを確認
+TEST(BVHTest, BuildStructure)
+{
+    Pcg32 random(1);
+    std::vector<std::shared_ptr<Sphere>> spheres = make_random_spheres(1000, random);
+    BVH bvh(spheres);
+    EXPECT_EQ(bvh.get_num_primitives(), spheres.size());
+
+    const std::vector<BVHNode> &nodes = bvh.get_nodes();
+    std::vector<int> coverage(spheres.size(), 0);
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        const BVHNode &node = nodes[i];
+        if (node.count > 0)
+        {
+            for (int p = node.offset; p < node.offset + node.count; p++)
+                coverage[p]++;
+        }
+        else
+        {
+            for (int child : {static_cast<int>(i) + 1, node.offset})
+            {
+                ASSERT_LT(child, static_cast<int>(nodes.size()));
+                EXPECT_LE(node.bounds.lower.x, nodes[child].bounds.lower.x);
+                EXPECT_LE(node.bounds.lower.y, nodes[child].bounds.lower.y);
+                EXPECT_LE(node.bounds.lower.z, nodes[child].bounds.lower.z);
+                EXPECT_GE(node.bounds.upper.x, nodes[child].bounds.upper.x);
+                EXPECT_GE(node.bounds.upper.y, nodes[child].bounds.upper.y);
+                EXPECT_GE(node.bounds.upper.z, nodes[child].bounds.upper.z);
+            }
+        }
+    }
+    for (int count : coverage)
+        EXPECT_EQ(count, 1);
+}
+
+// 総当たりと同じ衝突結果が得られることを確認
+TEST(BVHTest, IntersectMatchesLinearSearch)
+{
+    Pcg32 random(2);
+    std::vector<std::shared_ptr<Sphere>> spheres = make_random_spheres(500, random);
+    Aggregate linear(spheres);
+    BVH bvh(spheres);
+
+    int hit_count = 0;
+    for (int i = 0; i < 2000; i++)
+    {
+        Ray ray = make_random_ray(random);
+        std::optional<Hit> expected = linear.intersect(ray);
+        std::optional<Hit> actual = bvh.intersect(ray);
+        ASSERT_EQ(expected.has_value(), actual.has_value());
+        if (expected)
+        {
+            hit_count++;
+            EXPECT_EQ(expected->get_sphere(), actual->get_sphere());
+            EXPECT_DOUBLE_EQ(expected->get_distance(), actual->get_distance());
+            EXPECT_EQ(expected->get_hit_normal(), actual->get_hit_normal());
+        }
+    }
+    EXPECT_GT(hit_count, 0);
+}
+
+// 中心が一致する物体が多数ある場合も構築・探索できることを確認
+TEST(BVHTest, CoincidentCentroids)
+{
+    std::vector<std::shared_ptr<Sphere>> spheres;
+    for (int i = 0; i < 100; i++)
+        spheres.push_back(std::make_shared<Sphere>(Vec3(0), 1.0 + 0.01 * i));
+    BVH bvh(spheres);
+    EXPECT_EQ(bvh.get_num_primitives(), spheres.size());
+
+    std::optional<Hit> hit = bvh.intersect(Ray(Vec3(0, 0, -10), Vec3(0, 0, 1)));
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_EQ(hit->get_sphere(), spheres.back().get());
+    EXPECT_NEAR(hit->get_distance(), 10 - 1.99, 1e-9);
+}
+
+// 大規模なシーン（10 万個の球）の構築と探索
+TEST(BVHTest, LargeScene)
+{
+    Pcg32 random(3);
+    std::vector<std::shared_ptr<Sphere>> spheres;
+    for (int i = 0; i < 100000; i++)
+    {
+        Vec3 center(generate_random_in_range(random, -500.0, 500.0), generate_random_in_range(random, -500.0, 500.0), generate_random_in_range(random, -500.0, 500.0));
+        spheres.push_back(std::make_shared<Sphere>(center, 0.5));
+    }
+    Aggregate aggregate(spheres);
+    aggregate.build();
+    ASSERT_TRUE(aggregate.is_built());
+
+    for (int i = 0; i < 200; i++)
+    {
+        Ray ray = make_random_ray(random);
+        std::optional<Hit> actual = aggregate.intersect(ray);
+        // 総当たりで最も近い球を求める
+        const Sphere *expected = nullptr;
+        double expected_distance = .0;
+        for (const std::shared_ptr<Sphere> &sphere : spheres)
+        {
+            const std::optional<Hit> candidate = sphere->intersect(ray);
+            if (candidate && (!expected || expected_distance > candidate->get_distance()))
+            {
+                expected = sphere.get();
+                expected_distance = candidate->get_distance();
+            }
+        }
+        ASSERT_EQ(expected != nullptr, actual.has_value());
+        if (expected)
+        {
+            EXPECT_EQ(expected, actual->get_sphere());
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+#include "../header/camera.h"
+#include "../header/framebuffer.h"
+#include "../header/image.h"
+
+/**
+ * FrameBufferView クラスのテスト
+ */
+// ビューが画像の画素領域を直接参照することを確認
+TEST(FrameBufferViewTest, ViewsImageData)
+{
+    Image image(6, 4);
+    FrameBufferView view(image);
+    EXPECT_EQ(view.get_width(), 6);
+    EXPECT_EQ(view.get_height(), 4);
+    EXPECT_EQ(view.get_data(), image.get_data());
+    EXPECT_EQ(view.get_row(3), image.get_row(3));
+
+    view.set_pixel(2, 1, Color(0.3));
+    EXPECT_EQ(image.get_pixel(2, 1), Color(0.3));
+
+    image.set_pixel(5, 3, Color(0.7));
+    EXPECT_EQ(view.get_pixel(5, 3), Color(0.7));
+}
+
+// ビューのコピーは同じ画素領域を参照することを確認
+TEST(FrameBufferViewTest, CopyDoesNotCopyPixels)
+{
+    Image image(2, 2);
+    FrameBufferView view(image);
+    FrameBufferView copied = view;
+    copied.set_pixel(1, 1, Color(1));
+    EXPECT_EQ(copied.get_data(), view.get_data());
+    EXPECT_EQ(image.get_pixel(1, 1), Color(1));
+}
+
+// カメラのフレームバッファがカメラの画像に書き込むことを確認
+TEST(FrameBufferViewTest, CameraFrameBuffer)
+{
+    PinholeCamera camera(8, 6);
+    FrameBufferView framebuffer = camera.get_framebuffer();
+    EXPECT_EQ(framebuffer.get_data(), camera.get_image().get_data());
+    EXPECT_EQ(framebuffer.get_width(), 8);
+    EXPECT_EQ(framebuffer.get_height(), 6);
+
+    framebuffer.set_pixel(7, 5, Color(0.5));
+    EXPECT_EQ(camera.get_image().get_pixel(7, 5), Color(0.5));
+}
@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <utility>
+#include <vector>
+// 保存した PNG を読み込んで検証するため，stb_image の実装をこのテストに含める
+#define STB_IMAGE_IMPLEMENTATION
+#include "../header/image.h"
+
+/**
+ * Image クラスのテスト
+ */
+// コンストラクタの動作確認（全画素が黒で初期化される）
+TEST(ImageTest, Constructor)
+{
+    Image image(4, 3);
+    EXPECT_EQ(image.get_width(), 4);
+    EXPECT_EQ(image.get_height(), 3);
+    EXPECT_EQ(image.get_size(), 12);
+    for (int y = 0; y < 3; y++)
+        for (int x = 0; x < 4; x++)
+            EXPECT_EQ(image.get_pixel(x, y), Color(0));
+}
+
+// 画素の設定と取得
+TEST(ImageTest, SetAndGetPixel)
+{
+    Image image(4, 3);
+    image.set_pixel(1, 2, Color(0.1, 0.2, 0.3));
+    image.set_pixel(3, 0, 0.5);
+    EXPECT_EQ(image.get_pixel(1, 2), Color(0.1, 0.2, 0.3));
+    EXPECT_EQ(image.get_pixel(3, 0), Color(0.5));
+}
+
+// 画素領域が行優先の連続領域で，キャッシュライン境界に揃っていることを確認
+TEST(ImageTest, ContiguousRowMajorData)
+{
+    const int width = 5;
+    const int height = 4;
+    Image image(width, height);
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+            image.set_pixel(x, y, Color(x, y, 0));
+
+    const Color *data = image.get_data();
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(data) % 64, 0);
+    for (int y = 0; y < height; y++)
+    {
+        EXPECT_EQ(image.get_row(y), data + y * width);
+        for (int x = 0; x < width; x++)
+            EXPECT_EQ(data[y * width + x], Color(x, y, 0));
+    }
+
+    // 直接書き込んだ値が get_pixel で取得できる
+    image.get_row(2)[3] = Color(9);
+    EXPECT_EQ(image.get_pixel(3, 2), Color(9));
+}
+
+// コピーは画素値を複製し，元の画像とは独立していることを確認
+TEST(ImageTest, CopyIsDeep)
+{
+    Image image(2, 2);
+    image.set_pixel(0, 0, Color(1));
+    Image copied = image;
+    EXPECT_NE(copied.get_data(), image.get_data());
+    EXPECT_EQ(copied.get_pixel(0, 0), Color(1));
+
+    copied.set_pixel(0, 0, Color(0.5));
+    EXPECT_EQ(image.get_pixel(0, 0), Color(1));
+}
+
+// ムーブは画素領域の所有権を移すことを確認
+TEST(ImageTest, MoveTransfersOwnership)
+{
+    Image image(8, 8);
+    image.set_pixel(7, 7, Color(0.25));
+    const Color *data = image.get_data();
+
+    Image moved = std::move(image);
+    EXPECT_EQ(moved.get_data(), data);
+    EXPECT_EQ(moved.get_pixel(7, 7), Color(0.25));
+}
+
+// ガンマ補正
+TEST(ImageTest, GammaCorrection)
+{
+    Image image(2, 1);
+    image.set_pixel(0, 0, Color(0.5));
+    image.set_pixel(1, 0, Color(1.0));
+    image.gamma_correction();
+    EXPECT_DOUBLE_EQ(image.get_pixel(0, 0).r, std::pow(0.5, 1 / 2.2));
+    EXPECT_DOUBLE_EQ(image.get_pixel(1, 0).g, 1.0);
+}
+
+// PNG 保存で [0~1] が [0~255] に変換されることを確認
+TEST(ImageTest, SavePng)
+{
+    Image image(3, 2);
+    image.set_pixel(0, 0, Color(0.0, 0.5, 1.0));
+    image.set_pixel(2, 1, Color(-1.0, 2.0, 0.25));
+    const char *filepath = "test_image_save_png.png";
+    image.save_png(filepath);
+
+    int width, height, channels;
+    unsigned char *pixels = stbi_load(filepath, &width, &height, &channels, 3);
+    ASSERT_NE(pixels, nullptr);
+    EXPECT_EQ(width, 3);
+    EXPECT_EQ(height, 2);
+    EXPECT_EQ(pixels[0], 0);
+    EXPECT_EQ(pixels[1], 127);
+    EXPECT_EQ(pixels[2], 255);
+    const int last = (1 * 3 + 2) * 3;
+    EXPECT_EQ(pixels[last + 0], 0);
+    EXPECT_EQ(pixels[last + 1], 255);
+    EXPECT_EQ(pixels[last + 2], 63);
+    stbi_image_free(pixels);
+    std::remove(filepath);
+}
+
+// スタックに収まらない大きさの画像も保存できることを確認
+TEST(ImageTest, SaveLargePng)
+{
+    // 8bit に量子化しても 8 MB を超える大きさ
+    const int width = 4096;
+    const int height = 1024;
+    Image image(width, height);
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+            image.set_pixel(x, y, Color(double(x) / width, double(y) / height, 0.5));
+    const char *filepath = "test_image_save_large_png.png";
+    image.save_png(filepath);
+
+    int loaded_width, loaded_height, channels;
+    unsigned char *pixels = stbi_load(filepath, &loaded_width, &loaded_height, &channels, 3);
+    ASSERT_NE(pixels, nullptr);
+    EXPECT_EQ(loaded_width, width);
+    EXPECT_EQ(loaded_height, height);
+    const size_t index = (static_cast<size_t>(height - 1) * width + (width - 1)) * 3;
+    EXPECT_EQ(pixels[index + 0], static_cast<unsigned char>(UCHAR_MAX * (double(width - 1) / width)));
+    EXPECT_EQ(pixels[index + 1], static_cast<unsigned char>(UCHAR_MAX * (double(height - 1) / height)));
+    stbi_image_free(pixels);
+    std::remove(filepath);
+}
+
+// 行ごとにフィルタをかけて書き出したファイルが stbi_write_png と同じ内容になることを確認
+TEST(ImageTest, SavePngMatchesStbiWritePng)
+{
+    const int width = 37;
+    const int height = 129;
+    Image image(width, height);
+    std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 3);
+    Pcg32 random(7);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            // 滑らかな部分と雑音を混ぜ，行ごとに異なるフィルタが選ばれるようにする
+            const Color color = y % 3 == 0 ? Color(Real(random.next_double()), Real(random.next_double()), Real(random.next_double()))
+                                           : Color(Real(x) / width, Real(y) / height, Real(0.5));
+            image.set_pixel(x, y, color);
+            unsigned char *pixel = pixels.data() + (static_cast<size_t>(y) * width + x) * 3;
+            pixel[0] = static_cast<unsigned char>(UCHAR_MAX * clamp(color.r, Real(0), Real(1)));
+            pixel[1] = static_cast<unsigned char>(UCHAR_MAX * clamp(color.g, Real(0), Real(1)));
+            pixel[2] = static_cast<unsigned char>(UCHAR_MAX * clamp(color.b, Real(0), Real(1)));
+        }
+    }
+    const char *filepath = "test_image_save_png_matches.png";
+    image.save_png(filepath);
+
+    int expected_length;
+    unsigned char *expected = stbi_write_png_to_mem(pixels.data(), width * 3, width, height, 3, &expected_length);
+    ASSERT_NE(expected, nullptr);
+    std::ifstream file(filepath, std::ios::binary);
+    const std::vector<unsigned char> actual((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(actual, std::vector<unsigned char>(expected, expected + expected_length));
+    STBIW_FREE(expected);
+    std::remove(filepath);
+}
+
+// 画像の差を求める
+TEST(ImageTest, Compare)
+{
+    Image a(2, 2), b(2, 2);
+    a.set_pixel(0, 0, Color(0.5));
+    b.set_pixel(0, 0, Color(0.5));
+    ImageDifference same = a.compare(b);
+    EXPECT_EQ(same.mean_absolute_error, 0.0);
+    EXPECT_EQ(same.max_absolute_error, 0.0);
+    EXPECT_TRUE(std::isinf(same.psnr));
+
+    // 1 画素の 1 チャンネルだけ 0.1 異なる（[0, 1] の範囲外の値は切り詰めて比較する）
+    b.set_pixel(1, 1, Color(0.1, 0.0, -3.0));
+    ImageDifference diff = a.compare(b);
+    EXPECT_DOUBLE_EQ(diff.mean_absolute_error, 0.1 / 12);
+    EXPECT_DOUBLE_EQ(diff.max_absolute_error, 0.1);
+    EXPECT_DOUBLE_EQ(diff.psnr, 10.0 * std::log10(12 / (0.1 * 0.1)));
+
+    EXPECT_THROW(a.compare(Image(2, 3)), Image::size_mismatch_exception);
+}
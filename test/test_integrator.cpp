@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include "../header/aggregate.h"
+#include "../header/camera.h"
+#include "../header/integrator.h"
+#include "../header/material.h"
+#include "../header/random.h"
+#include "../header/renderer.h"
+#include "../header/scenes.h"
+#include "../header/sphere.h"
+
+namespace
+{
+    // get_material を上書きして鏡面のマテリアルを返す球
+    class MirrorSphere : public Sphere
+    {
+    private:
+        Mirror material{Color(1)};
+
+    public:
+        using Sphere::Sphere;
+
+        Material *get_material() const override
+        {
+            return const_cast<Mirror *>(&material);
+        }
+    };
+
+    std::vector<Color> get_pixels(const Camera &camera)
+    {
+        const Image &image = camera.get_image();
+        return std::vector<Color>(image.get_data(), image.get_data() + image.get_width() * image.get_height());
+    }
+
+    // 反復化する前の再帰的な実装（参照用）
+    Color recursive_ray_color(const Ray &r, const Aggregate &world, SampleStream &random, int interaction_count = 0)
+    {
+        const int max_interaction_count = 10;
+        if (interaction_count > max_interaction_count)
+            return Color();
+
+        std::optional<Hit> result = world.intersect(r);
+        if (result)
+        {
+            Hit hit = *result;
+            const Sphere *sphere = hit.get_sphere();
+            Ray ray = sphere->get_material()->sample_ray(r, hit, random);
+            return sphere->get_material()->get_brdf() * recursive_ray_color(ray, world, random, interaction_count + 1);
+        }
+        auto t = 0.5 * (r.get_direction().y + 1.0);
+        return (1.0 - t) * Color(1) + t * Color(0.5, 0.7, 1.0);
+    }
+}
+
+/**
+ * PathIntegrator クラスのテスト
+ */
+// コンストラクタの動作確認
+TEST(PathIntegratorTest, Constructor)
+{
+    PathIntegrator integrator;
+    EXPECT_EQ(integrator.get_max_depth(), PathIntegrator::DEFAULT_MAX_DEPTH);
+    EXPECT_EQ(integrator.get_russian_roulette_depth(), PathIntegrator::DEFAULT_RUSSIAN_ROULETTE_DEPTH);
+    EXPECT_EQ(integrator.get_material_dispatch(), MaterialDispatch::Variant);
+    EXPECT_EQ(integrator.get_packet_size(), PathIntegrator::DEFAULT_PACKET_SIZE);
+
+    EXPECT_THROW(PathIntegrator(10, 3, MaterialDispatch::Variant, 3), PathIntegrator::packet_size_exception);
+    EXPECT_THROW(PathIntegrator(10, 3, MaterialDispatch::Variant, 32), PathIntegrator::packet_size_exception);
+}
+
+// どの物体とも衝突しない場合は空の色を返す
+TEST(PathIntegratorTest, MissReturnsBackground)
+{
+    Aggregate world;
+    PathIntegrator integrator;
+    SampleStream random;
+    Ray ray(Vec3(0), Vec3(0, 1, 0));
+    EXPECT_EQ(integrator.trace(ray, world, random), PathIntegrator::background(ray));
+    EXPECT_EQ(PathIntegrator::background(ray), Color(0.5, 0.7, 1.0));
+}
+
+// 最大バウンス数を超えた経路は黒となる
+TEST(PathIntegratorTest, MaxDepth)
+{
+    Aggregate world;
+    world.add(std::make_shared<MaterializedSphere>(Vec3(0), 1.0, std::make_shared<Lambertian>(Color(1.0))));
+    PathIntegrator integrator(0, -1);
+    SampleStream random;
+    // 球の内部から出たレイは必ず球に衝突する
+    EXPECT_EQ(integrator.trace(Ray(Vec3(0), Vec3(0, 0, 1)), world, random), Color(0));
+}
+
+// 追跡したレイの本数を数えても結果が変わらないことを確認
+TEST(PathIntegratorTest, CountsRays)
+{
+    Aggregate world = make_three_spheres_world();
+    PathIntegrator integrator(10, -1);
+    int num_rays = -1;
+    SampleStream random;
+    integrator.trace(Ray(Vec3(0), Vec3(0, 1, 0)), world, random, num_rays);
+    EXPECT_EQ(num_rays, 1);
+
+    // 地面（拡散反射面）に向けたレイは 2 本以上追跡する
+    SampleStream random1(5), random2(5);
+    const Ray ray(Vec3(0, 1, 0), Vec3(0, -1, -0.5));
+    EXPECT_EQ(integrator.trace(ray, world, random1), integrator.trace(ray, world, random2, num_rays));
+    EXPECT_GE(num_rays, 2);
+    EXPECT_LE(num_rays, integrator.get_max_depth() + 1);
+}
+
+// Sphere を派生させて get_material を上書きした場合，既定の設定でも上書きしたマテリアルが用いられることを確認
+TEST(PathIntegratorTest, UsesOverriddenGetMaterial)
+{
+    Aggregate world;
+    world.add(std::make_shared<MirrorSphere>(Vec3(0, 0, -5), 1.0));
+    PathIntegrator integrator;
+    ASSERT_EQ(integrator.get_material_dispatch(), MaterialDispatch::Variant);
+    SampleStream random;
+    // 鏡面で真後ろに反射したレイは空に届く（黒の Lambertian として扱われると空の色にならない）
+    EXPECT_EQ(integrator.trace(Ray(Vec3(0), Vec3(0, 0, -1)), world, random), PathIntegrator::background(Ray(Vec3(0), Vec3(0, 0, 1))));
+}
+
+// ロシアンルーレットを行わない場合，再帰的な実装と一致することを確認
+TEST(PathIntegratorTest, MatchesRecursiveImplementation)
+{
+    Aggregate world = make_three_spheres_world();
+    PinholeCamera camera(32, 24);
+    PathIntegrator virtual_integrator(10, -1, MaterialDispatch::Virtual);
+    PathIntegrator variant_integrator(10, -1, MaterialDispatch::Variant);
+
+    for (int y = 0; y < 24; y++)
+    {
+        for (int x = 0; x < 32; x++)
+        {
+            SampleStream random1 = make_sample_stream(x, y, 0);
+            SampleStream random2 = make_sample_stream(x, y, 0);
+            SampleStream random3 = make_sample_stream(x, y, 0);
+            Ray ray = camera.get_ray(x, y, random1);
+            camera.get_ray(x, y, random2);
+            camera.get_ray(x, y, random3);
+
+            // BRDF を掛ける順序が異なるため，丸め誤差の範囲で一致することを確認する
+            Color expected = recursive_ray_color(ray, world, random1);
+            for (const Color &actual : {virtual_integrator.trace(ray, world, random2), variant_integrator.trace(ray, world, random3)})
+            {
+                EXPECT_NEAR(actual.r, expected.r, 1e-12);
+                EXPECT_NEAR(actual.g, expected.g, 1e-12);
+                EXPECT_NEAR(actual.b, expected.b, 1e-12);
+            }
+        }
+    }
+}
+
+// ロシアンルーレットを行っても期待値が変わらないことを確認
+TEST(PathIntegratorTest, RussianRouletteIsUnbiased)
+{
+    Aggregate world = make_three_spheres_world();
+    PinholeCamera camera(32, 24);
+    PathIntegrator reference(10, -1);
+    PathIntegrator roulette(10, 1);
+
+    const int num_samples = 20000;
+    // 拡散反射面（地面）を写すピクセル
+    const int x = 16;
+    const int y = 20;
+    double sum[2] = {}, sum_sq[2] = {};
+    for (int s = 0; s < num_samples; s++)
+    {
+        SampleStream random1 = make_sample_stream(x, y, s, 0);
+        SampleStream random2 = make_sample_stream(x, y, s, 1);
+        double v1 = reference.trace(camera.get_ray(x, y, random1), world, random1).g;
+        double v2 = roulette.trace(camera.get_ray(x, y, random2), world, random2).g;
+        sum[0] += v1, sum_sq[0] += v1 * v1;
+        sum[1] += v2, sum_sq[1] += v2 * v2;
+    }
+
+    double mean[2], variance[2];
+    for (int i = 0; i < 2; i++)
+    {
+        mean[i] = sum[i] / num_samples;
+        variance[i] = sum_sq[i] / num_samples - mean[i] * mean[i];
+    }
+    const double standard_error = std::sqrt((variance[0] + variance[1]) / num_samples);
+    EXPECT_GT(mean[0], 0.0);
+    EXPECT_NEAR(mean[0], mean[1], 4 * standard_error);
+}
+
+// render でパケットを用いて描画しても，Renderer::render に trace を渡した場合と同じ画像・レイの本数となることを確認
+TEST(PathIntegratorTest, RenderMatchesTrace)
+{
+    Aggregate world;
+    add_material_spheres(world);
+    world.build();
+    Aggregate unbuilt_world;
+    add_material_spheres(unbuilt_world);
+
+    for (const int max_depth : {0, 1, PathIntegrator::DEFAULT_MAX_DEPTH})
+    {
+        const PathIntegrator reference(max_depth);
+        PinholeCamera expected_camera(29, 19);
+        std::atomic<long long> expected_rays(0);
+        Renderer(1).render(expected_camera, 3, [&](const Ray &r, SampleStream &random)
+                           {
+                               int n;
+                               const Color color = reference.trace(r, world, random, n);
+                               expected_rays += n;
+                               return color; });
+        const std::vector<Color> expected = get_pixels(expected_camera);
+
+        for (const int packet_size : {0, 4, 8, 16})
+        {
+            const PathIntegrator integrator(max_depth, PathIntegrator::DEFAULT_RUSSIAN_ROULETTE_DEPTH, MaterialDispatch::Variant, packet_size);
+            for (const Aggregate *w : {&world, &unbuilt_world})
+            {
+                PinholeCamera camera(29, 19);
+                Renderer renderer(3, 7);
+                EXPECT_EQ(integrator.render(renderer, camera, 3, *w), expected_rays.load());
+                EXPECT_EQ(get_pixels(camera), expected) << "max_depth " << max_depth << ", packet size " << packet_size;
+            }
+        }
+    }
+}
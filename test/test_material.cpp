@@ -31,6 +31,48 @@ TEST(LambertianTest, SampleRay)
     }
 }
 
+// 同じ乱数生成器の状態からは同じ反射レイが得られることを確認
+TEST(LambertianTest, SampleRayIsReproducible)
+{
+    Lambertian lambertian(Color(0.5));
+    Vec3 hit_position(0.0, 0.0, 0.0);
+    Ray incident_ray(Vec3(0.0, 1.0, 0.0), Vec3(0.0, -1.0, 0.0));
+    Hit hit(1, hit_position, Vec3(0.0, 1.0, 0.0), nullptr, true);
+
+    SampleStream random1 = make_sample_stream(3, 5, 7);
+    SampleStream random2 = make_sample_stream(3, 5, 7);
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_EQ(lambertian.sample_ray(incident_ray, hit, random1).get_direction(), lambertian.sample_ray(incident_ray, hit, random2).get_direction());
+    }
+}
+
+// 反射レイの方向が法線を軸とする cos(theta) に比例する分布に従うことを確認
+TEST(LambertianTest, SampleRayIsCosineWeighted)
+{
+    Lambertian lambertian(Color(0.5));
+    for (const Vec3 &normal : {Vec3(0.0, 1.0, 0.0), Vec3(0.0, 0.0, -1.0), Vec3(1.0, -2.0, 0.5).normalize()})
+    {
+        Hit hit(1, Vec3(0.0), normal, nullptr, true);
+        Ray incident_ray(Vec3(0.0) + normal, -normal);
+        SampleStream random(42);
+        const int num_samples = 100000;
+        double sum_cos = 0, sum_cos_squared = 0;
+        for (int i = 0; i < num_samples; i++)
+        {
+            const Vec3 direction = lambertian.sample_ray(incident_ray, hit, random).get_direction();
+            EXPECT_NEAR(direction.norm(), 1.0, 1e-9);
+            const double cos_theta = dot(direction, normal);
+            ASSERT_GT(cos_theta, 0.0);
+            sum_cos += cos_theta;
+            sum_cos_squared += cos_theta * cos_theta;
+        }
+        // 密度 cos(theta) / π のとき E[cos] = 2/3，E[cos^2] = 1/2
+        EXPECT_NEAR(sum_cos / num_samples, 2.0 / 3.0, 5e-3);
+        EXPECT_NEAR(sum_cos_squared / num_samples, 0.5, 5e-3);
+    }
+}
+
 TEST(LambertianTest, GetBRDFDirect)
 {
     // アルベド（反射率）の設定
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include "../header/material_variant.h"
+#include "../header/sphere.h"
+
+namespace
+{
+    // 閉じた集合に含まれない独自のマテリアル
+    class Emissive : public Material
+    {
+    public:
+        using Material::sample_ray;
+
+        Ray sample_ray(const Ray &, const Hit &hit, SampleStream &) const override
+        {
+            return Ray(hit.get_hit_position(), hit.get_hit_normal());
+        }
+
+        Color get_brdf() const override
+        {
+            return Color(2.0);
+        }
+    };
+
+    // Lambertian を派生させ，BRDF を半分にしたマテリアル
+    class TintedLambertian : public Lambertian
+    {
+    public:
+        using Lambertian::Lambertian;
+
+        Color get_brdf() const override
+        {
+            return 0.5 * Lambertian::get_brdf();
+        }
+    };
+}
+
+/**
+ * MaterialVariant のテスト
+ */
+// 仮想関数による呼び出しと同じ結果が得られることを確認
+TEST(MaterialVariantTest, MatchesVirtualDispatch)
+{
+    Hit hit(1, Vec3(0, 0, -1), Vec3(0, 0, -1), nullptr, true);
+    Ray incident_ray(Vec3(0.3, 0.2, -5), Vec3(-0.05, -0.03, 1));
+
+    std::unique_ptr<Material> materials[] = {
+        std::make_unique<Lambertian>(Color(0.1, 0.2, 0.3)),
+        std::make_unique<Mirror>(Color(0.8, 0.6, 0.2)),
+        std::make_unique<Glass>(1.5)};
+
+    for (const std::unique_ptr<Material> &material : materials)
+    {
+        std::optional<MaterialVariant> variant = to_material_variant(material.get());
+        ASSERT_TRUE(variant.has_value());
+        EXPECT_EQ(get_brdf(*variant), material->get_brdf());
+
+        SampleStream random1(11);
+        SampleStream random2(11);
+        for (int i = 0; i < 10; i++)
+        {
+            Ray expected = material->sample_ray(incident_ray, hit, random1);
+            Ray actual = sample_ray(*variant, incident_ray, hit, random2);
+            EXPECT_EQ(expected.get_origin(), actual.get_origin());
+            EXPECT_EQ(expected.get_direction(), actual.get_direction());
+        }
+    }
+}
+
+// 変換後の型が元のマテリアルの型と一致することを確認
+TEST(MaterialVariantTest, HoldsConcreteType)
+{
+    Lambertian lambertian(Color(0.5));
+    Mirror mirror(Color(0.5));
+    Glass glass(1.5);
+    EXPECT_TRUE(std::holds_alternative<Lambertian>(*to_material_variant(&lambertian)));
+    EXPECT_TRUE(std::holds_alternative<Mirror>(*to_material_variant(&mirror)));
+    EXPECT_TRUE(std::holds_alternative<Glass>(*to_material_variant(&glass)));
+}
+
+// 閉じた集合に含まれないマテリアルは変換できないことを確認
+TEST(MaterialVariantTest, UnknownMaterial)
+{
+    Emissive emissive;
+    EXPECT_FALSE(to_material_variant(&emissive).has_value());
+
+    MaterializedSphere sphere(Vec3(0), 1.0, std::make_shared<Emissive>());
+    EXPECT_EQ(sphere.get_material_variant(), nullptr);
+}
+
+// 球が保持するマテリアルの確認
+TEST(MaterialVariantTest, SphereMaterialVariant)
+{
+    MaterializedSphere mirror_sphere(Vec3(0), 1.0, std::make_shared<Mirror>(Color(0.7)));
+    ASSERT_NE(mirror_sphere.get_material_variant(), nullptr);
+    EXPECT_TRUE(std::holds_alternative<Mirror>(*mirror_sphere.get_material_variant()));
+    EXPECT_EQ(get_brdf(*mirror_sphere.get_material_variant()), Color(0.7));
+
+    // マテリアルを持たない球は値を持たず，get_material（黒の Lambertian）で呼び出す
+    Sphere sphere(Vec3(0), 1.0);
+    EXPECT_EQ(sphere.get_material_variant(), nullptr);
+    EXPECT_EQ(sphere.get_material()->get_brdf(), Color(0));
+}
+
+// 集合内の型をさらに派生させたマテリアルは変換しない（変換すると派生クラスの上書きが失われる）
+TEST(MaterialVariantTest, DerivedFromKnownMaterial)
+{
+    TintedLambertian tinted(Color(0.5));
+    EXPECT_FALSE(to_material_variant(&tinted).has_value());
+
+    MaterializedSphere sphere(Vec3(0), 1.0, std::make_shared<TintedLambertian>(Color(0.5)));
+    EXPECT_EQ(sphere.get_material_variant(), nullptr);
+    EXPECT_EQ(sphere.get_material()->get_brdf(), Color(0.25));
+}
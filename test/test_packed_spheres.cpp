@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+#include "../header/material.h"
+#include "../header/packed_spheres.h"
+#include "../header/random.h"
+#include "../header/sphere.h"
+#include "../header/util.h"
+
+namespace
+{
+    // 総当たりで最も手前の衝突を求める
+    std::optional<Hit> intersect_linear(const std::vector<std::shared_ptr<Sphere>> &spheres, const Ray &ray)
+    {
+        std::optional<Hit> closest_hit = std::nullopt;
+        for (const std::shared_ptr<Sphere> &sphere : spheres)
+        {
+            std::optional<Hit> candidate = sphere->intersect(ray);
+            if (candidate && (!closest_hit || closest_hit->get_distance() > candidate->get_distance()))
+                closest_hit = candidate;
+        }
+        return closest_hit;
+    }
+}
+
+/**
+ * PackedSpheres クラスのテスト
+ */
+// 物体の追加とマテリアル番号の割り当て
+TEST(PackedSpheresTest, AddAndMaterialIndex)
+{
+    std::shared_ptr<Material> red = std::make_shared<Lambertian>(Color(1, 0, 0));
+    std::shared_ptr<Material> mirror = std::make_shared<Mirror>(Color(0.8));
+    MaterializedSphere s1(Vec3(0), 1.0, red);
+    MaterializedSphere s2(Vec3(2, 0, 0), 0.5, mirror);
+    MaterializedSphere s3(Vec3(4, 0, 0), 0.5, red);
+
+    PackedSpheres packed({&s1, &s2, &s3});
+    EXPECT_EQ(packed.size(), 3);
+    EXPECT_EQ(packed.get_sphere(1), &s2);
+    EXPECT_EQ(packed.get_num_materials(), 2);
+    EXPECT_EQ(packed.get_material_index(0), packed.get_material_index(2));
+    EXPECT_NE(packed.get_material_index(0), packed.get_material_index(1));
+    EXPECT_EQ(packed.get_material(packed.get_material_index(1)), mirror.get());
+
+    packed.clear();
+    EXPECT_EQ(packed.size(), 0);
+}
+
+// 単純な配置での衝突
+TEST(PackedSpheresTest, IntersectRay)
+{
+    Sphere s1(Vec3(0.0, 0.0, 0.0), 2);
+    Sphere s2(Vec3(0.0, 0.0, 6.0), 3);
+    PackedSpheres packed({&s2, &s1});
+
+    std::optional<Hit> result = packed.intersect(Ray(Vec3(0, 0, -5), Vec3(0, 0, 1)));
+    ASSERT_TRUE(result) << "Intersection test failed: Expected a valid Hit, but got nullopt.";
+    EXPECT_EQ(result->get_sphere(), &s1);
+    EXPECT_EQ(result->get_distance(), 3);
+    EXPECT_EQ(result->get_hit_normal(), Vec3(0, 0, -1));
+
+    // 内部から
+    result = packed.intersect(Ray(Vec3(0, 0, 0.5), Vec3(0, 0, 1)));
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result->get_sphere(), &s1);
+    EXPECT_FALSE(result->check_ray_outside_sphere());
+
+    // 外れる
+    EXPECT_FALSE(packed.intersect(Ray(Vec3(0, 0, -5), Vec3(0, 1, 0))).has_value());
+}
+
+// 範囲を指定した探索では範囲外の球を無視することを確認
+TEST(PackedSpheresTest, FindClosestInRange)
+{
+    std::vector<std::unique_ptr<Sphere>> spheres;
+    std::vector<const Sphere *> pointers;
+    for (int i = 0; i < 11; i++)
+    {
+        spheres.push_back(std::make_unique<Sphere>(Vec3(0, 0, 2.0 * i), 0.5));
+        pointers.push_back(spheres.back().get());
+    }
+    PackedSpheres packed(pointers);
+    Ray ray(Vec3(0, 0, -5), Vec3(0, 0, 1));
+
+    int closest_index = -1;
+    Real closest_distance = 0;
+    ASSERT_TRUE(packed.find_closest(ray, 3, 8, Hit::MAX_DISTANCE, closest_index, closest_distance));
+    EXPECT_EQ(closest_index, 3);
+    EXPECT_DOUBLE_EQ(closest_distance, 5.0 + 6.0 - 0.5);
+
+    // 上限距離より遠い球は無視する
+    EXPECT_FALSE(packed.find_closest(ray, 3, 8, 10.0, closest_index, closest_distance));
+    // 空の範囲
+    EXPECT_FALSE(packed.find_closest(ray, 4, 4, Hit::MAX_DISTANCE, closest_index, closest_distance));
+}
+
+// 多数のランダムなレイで Sphere::intersect による総当たりと同じ結果となることを確認
+TEST(PackedSpheresTest, IntersectMatchesSphereIntersect)
+{
+    Pcg32 random(7);
+    std::vector<std::shared_ptr<Sphere>> spheres;
+    std::vector<const Sphere *> pointers;
+    for (int i = 0; i < 37; i++)
+    {
+        Vec3 center(generate_random_in_range(random, -5.0, 5.0), generate_random_in_range(random, -5.0, 5.0), generate_random_in_range(random, -5.0, 5.0));
+        spheres.push_back(std::make_shared<Sphere>(center, generate_random_in_range(random, 0.1, 2.0)));
+        pointers.push_back(spheres.back().get());
+    }
+    PackedSpheres packed(pointers);
+
+    int hit_count = 0;
+    for (int i = 0; i < 5000; i++)
+    {
+        Vec3 origin(generate_random_in_range(random, -8.0, 8.0), generate_random_in_range(random, -8.0, 8.0), generate_random_in_range(random, -8.0, 8.0));
+        Ray ray(origin, spherical_to_cartesian(generate_random_in_range(random, 0.0, M_PI), generate_random_in_range(random, 0.0, 2 * M_PI)));
+        std::optional<Hit> expected = intersect_linear(spheres, ray);
+        std::optional<Hit> actual = packed.intersect(ray);
+        ASSERT_EQ(expected.has_value(), actual.has_value());
+        if (expected)
+        {
+            hit_count++;
+            EXPECT_EQ(expected->get_sphere(), actual->get_sphere());
+            EXPECT_EQ(expected->get_distance(), actual->get_distance());
+            EXPECT_EQ(expected->get_hit_position(), actual->get_hit_position());
+            EXPECT_EQ(expected->get_hit_normal(), actual->get_hit_normal());
+            EXPECT_EQ(expected->check_ray_outside_sphere(), actual->check_ray_outside_sphere());
+        }
+    }
+    EXPECT_GT(hit_count, 0);
+}
+
+// 手前の球をかすめるレイについて，カーネルのみが交差と判定した場合でも奥の球との衝突を返すことを確認
+// 単精度でビルドした場合，カーネルと Sphere::intersect とで接すると判定する範囲の境界がずれる
+TEST(PackedSpheresTest, GrazingRayFallsThroughToFartherSphere)
+{
+    std::vector<std::shared_ptr<Sphere>> spheres = {std::make_shared<Sphere>(Vec3(0), 1.0), std::make_shared<Sphere>(Vec3(0, 0, 5), 2.0)};
+    PackedSpheres packed({spheres[0].get(), spheres[1].get()});
+
+    // 接すると判定される境界（x = 1 + 5e-5 付近）を単精度の 1 ulp 程度の刻みで横切る
+    for (int i = 0; i < 200; i++)
+    {
+        const Ray ray(Vec3(Real(1 + 4e-5 + i * 1e-7), 0, -5), Vec3(0, 0, 1));
+        std::optional<Hit> expected = intersect_linear(spheres, ray);
+        std::optional<Hit> actual = packed.intersect(ray);
+        ASSERT_TRUE(expected.has_value());
+        ASSERT_TRUE(actual.has_value()) << "i = " << i;
+        EXPECT_EQ(expected->get_sphere(), actual->get_sphere());
+        EXPECT_EQ(expected->get_distance(), actual->get_distance());
+    }
+}
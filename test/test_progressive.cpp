@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "../header/accumulation_buffer.h"
+#include "../header/camera.h"
+#include "../header/progressive.h"
+#include "../header/renderer.h"
+
+namespace
+{
+    Color noisy_color(const Ray &r, SampleStream &random)
+    {
+        return Color(r.get_direction().x < 0 ? 0.5 : random.next_double());
+    }
+}
+
+/**
+ * ProgressiveRenderer クラスのテスト
+ */
+// コンストラクタの動作確認
+TEST(ProgressiveRendererTest, Constructor)
+{
+    ProgressiveRenderer progressive(100, 0.5, 0.01, 8);
+    EXPECT_EQ(progressive.get_max_samples(), 100);
+    EXPECT_DOUBLE_EQ(progressive.get_time_budget(), 0.5);
+    EXPECT_DOUBLE_EQ(progressive.get_noise_target(), 0.01);
+    EXPECT_EQ(progressive.get_max_samples_per_pass(), 8);
+
+    ProgressiveRenderer default_progressive(10);
+    EXPECT_EQ(default_progressive.get_max_samples_per_pass(), ProgressiveRenderer::DEFAULT_MAX_SAMPLES_PER_PASS);
+}
+
+// 無効なサンプル数で例外スローを確認
+TEST(ProgressiveRendererTest, InvalidSampleCountThrowsException)
+{
+    EXPECT_THROW(ProgressiveRenderer(0), ProgressiveRenderer::sample_count_exception);
+    EXPECT_THROW(ProgressiveRenderer(10, 0, 0, 0), ProgressiveRenderer::sample_count_exception);
+}
+
+// パスごとのサンプル数が 1, 2, 4, ... と増え，最大サンプル数に達すると固定サンプル数の描画と同じ画像になることを確認
+TEST(ProgressiveRendererTest, PassesReachMaxSamples)
+{
+    PinholeCamera fixed_camera(20, 12);
+    Renderer renderer(2, 6);
+    renderer.render(fixed_camera, 13, noisy_color);
+
+    PinholeCamera camera(20, 12);
+    AccumulationBuffer accumulation(20, 12);
+    std::vector<int> samples;
+    ProgressivePass last = ProgressiveRenderer(13, 0, 0, 4).render(renderer, camera, accumulation, noisy_color, [&](const ProgressivePass &pass)
+                                                                 {
+                                                                     EXPECT_EQ(pass.pass, static_cast<int>(samples.size()));
+                                                                     // 各パスの後にはカメラの画像が現在の推定値となっている
+                                                                     EXPECT_EQ(camera.get_image().get_pixel(19, 11), accumulation.get_pixel(19, 11).get_mean());
+                                                                     samples.push_back(pass.samples_per_pixel);
+                                                                 });
+    EXPECT_EQ(samples, (std::vector<int>{1, 3, 7, 11, 13}));
+    EXPECT_EQ(last.samples_per_pixel, 13);
+    EXPECT_EQ(accumulation.get_total_samples(), 13 * 20 * 12);
+
+    for (int y = 0; y < 12; y++)
+        for (int x = 0; x < 20; x++)
+            EXPECT_EQ(camera.get_image().get_pixel(x, y), fixed_camera.get_image().get_pixel(x, y));
+}
+
+// ノイズの目標を満たした時点で終えることを確認
+TEST(ProgressiveRendererTest, StopsAtNoiseTarget)
+{
+    PinholeCamera camera(20, 12);
+    AccumulationBuffer accumulation(20, 12);
+    Renderer renderer(1);
+    std::vector<double> errors;
+    ProgressivePass last = ProgressiveRenderer(1000, 0, 0.1).render(renderer, camera, accumulation, noisy_color, [&](const ProgressivePass &pass)
+                                                                   { errors.push_back(pass.relative_error); });
+    EXPECT_LE(last.relative_error, 0.1);
+    EXPECT_LT(last.samples_per_pixel, 1000);
+    // 目標を満たす前のパス（分散を求められない最初のパスを除く）では誤差が目標より大きい
+    for (size_t i = 1; i + 1 < errors.size(); i++)
+        EXPECT_GT(errors[i], 0.1);
+}
+
+// 時間の予算を超えると見込まれる場合も，最初のパスは必ず描画することを確認
+TEST(ProgressiveRendererTest, TimeBudget)
+{
+    PinholeCamera camera(20, 12);
+    AccumulationBuffer accumulation(20, 12);
+    Renderer renderer(1);
+    int passes = 0;
+    ProgressivePass last = ProgressiveRenderer(1000, 1e-9).render(renderer, camera, accumulation, noisy_color, [&](const ProgressivePass &)
+                                                                 { passes++; });
+    EXPECT_EQ(passes, 1);
+    EXPECT_EQ(last.samples_per_pixel, 1);
+    EXPECT_GT(last.elapsed_seconds, 0);
+}
+
+// 1 サンプルでは分散が 0 となるため，ノイズの目標を満たしたとみなさないことを確認
+TEST(ProgressiveRendererTest, NoiseTargetNeedsTwoSamples)
+{
+    PinholeCamera camera(8, 4);
+    AccumulationBuffer accumulation(8, 4);
+    Renderer renderer(1);
+    ProgressivePass last = ProgressiveRenderer(10, 0, 1.0).render(renderer, camera, accumulation, noisy_color);
+    EXPECT_GE(last.samples_per_pixel, 2);
+}
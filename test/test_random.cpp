@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include <set>
+#include <thread>
+#include <vector>
+#include "../header/random.h"
+
+/**
+ * Pcg32 クラスのテスト
+ */
+// PCG32 の参照実装と同じ乱数列が得られることを確認
+TEST(Pcg32Test, MatchesReferenceSequence)
+{
+    Pcg32 random(42u, 54u);
+    const uint32_t expected[] = {0xa15c02b7, 0x7b47f409, 0xba1d3330, 0x83d2f293, 0xbfa4784b, 0xcbed606e};
+    for (uint32_t value : expected)
+    {
+        EXPECT_EQ(random.next_uint(), value);
+    }
+}
+
+// 同じ初期状態からは同じ乱数列が得られることを確認
+TEST(Pcg32Test, SameSeedSameSequence)
+{
+    Pcg32 random1(123);
+    Pcg32 random2(123);
+    Pcg32 random3(124);
+    bool differs = false;
+    for (int i = 0; i < 100; i++)
+    {
+        uint32_t value = random1.next_uint();
+        EXPECT_EQ(value, random2.next_uint());
+        differs |= value != random3.next_uint();
+    }
+    EXPECT_TRUE(differs);
+}
+
+// next_double が [0, 1) の値を返すことを確認
+TEST(Pcg32Test, NextDoubleRange)
+{
+    Pcg32 random;
+    double sum = 0.0;
+    const int test_iterations = 10000;
+    for (int i = 0; i < test_iterations; i++)
+    {
+        double value = random.next_double();
+        EXPECT_GE(value, 0.0);
+        EXPECT_LT(value, 1.0);
+        sum += value;
+    }
+    EXPECT_NEAR(sum / test_iterations, 0.5, 0.02);
+}
+
+// (pixel, sample, frame) が異なれば異なる乱数列が得られることを確認
+TEST(Pcg32Test, MakeSampleRandom)
+{
+    EXPECT_EQ(make_sample_random(1, 2, 3, 4).next_uint(), make_sample_random(1, 2, 3, 4).next_uint());
+
+    std::set<uint32_t> first_values;
+    for (int y = 0; y < 4; y++)
+        for (int x = 0; x < 4; x++)
+            for (int s = 0; s < 4; s++)
+                for (int frame = 0; frame < 2; frame++)
+                    first_values.insert(make_sample_random(x, y, s, frame).next_uint());
+    EXPECT_EQ(first_values.size(), 4 * 4 * 4 * 2);
+}
+
+// スレッドごとに独立した乱数生成器が用いられることを確認
+TEST(Pcg32Test, ThreadLocalRandom)
+{
+    Pcg32 *main_random = &thread_local_random();
+    Pcg32 *other_random = nullptr;
+    std::thread t([&]()
+                  { other_random = &thread_local_random(); });
+    t.join();
+    EXPECT_NE(main_random, other_random);
+    EXPECT_EQ(main_random, &thread_local_random());
+}
+
+// スレッドごとの乱数生成器が異なる乱数列を生成することを確認
+TEST(Pcg32Test, ThreadLocalRandomStreamsDiffer)
+{
+    std::vector<std::vector<uint32_t>> sequences(4);
+    std::vector<std::thread> threads;
+    for (auto &sequence : sequences)
+    {
+        threads.emplace_back([&sequence]()
+                             {
+                                 for (int i = 0; i < 8; i++)
+                                     sequence.push_back(thread_local_random().next_uint()); });
+    }
+    for (std::thread &t : threads)
+        t.join();
+    for (size_t i = 0; i < sequences.size(); i++)
+        for (size_t j = i + 1; j < sequences.size(); j++)
+            EXPECT_NE(sequences[i], sequences[j]);
+}
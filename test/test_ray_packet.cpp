@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "../header/aabb.h"
+#include "../header/aggregate.h"
+#include "../header/bvh.h"
+#include "../header/random.h"
+#include "../header/ray_packet.h"
+#include "../header/sphere.h"
+#include "../header/util.h"
+
+namespace
+{
+    Aggregate make_random_world(const int count, Pcg32 &random, const bool build)
+    {
+        Aggregate world;
+        for (int i = 0; i < count; i++)
+        {
+            Vec3 center(generate_random_in_range(random, -20.0, 20.0), generate_random_in_range(random, -20.0, 20.0), generate_random_in_range(random, -20.0, 20.0));
+            world.add(std::make_shared<Sphere>(center, generate_random_in_range(random, 0.5, 3.0)));
+        }
+        if (build)
+            world.build();
+        return world;
+    }
+
+    // 同じ点から少しずつ異なる方向に向かうレイ（カメラからのレイを模したもの）
+    Ray make_coherent_ray(Pcg32 &random)
+    {
+        Vec3 target(generate_random_in_range(random, -20.0, 20.0), generate_random_in_range(random, -20.0, 20.0), generate_random_in_range(random, -20.0, 20.0));
+        return Ray(Vec3(0, 0, 40), target - Vec3(0, 0, 40));
+    }
+
+    void expect_same_hit(const std::optional<Hit> &actual, const std::optional<Hit> &expected)
+    {
+        ASSERT_EQ(actual.has_value(), expected.has_value());
+        if (expected)
+        {
+            EXPECT_EQ(actual->get_sphere(), expected->get_sphere());
+            EXPECT_EQ(actual->get_distance(), expected->get_distance());
+        }
+    }
+
+    // パケット単位の判定結果が 1 本ずつの判定結果と一致することを確認する（ray_count < N の場合は端数のパケット）
+    template <int N>
+    void check_packet_intersection(const bool build, const int ray_count)
+    {
+        Pcg32 random(N);
+        Aggregate world = make_random_world(200, random, build);
+        for (int trial = 0; trial < 50; trial++)
+        {
+            RayPacket<N> packet;
+            std::vector<Ray> rays;
+            for (int i = 0; i < ray_count; i++)
+            {
+                rays.push_back(make_coherent_ray(random));
+                packet.add(rays.back());
+            }
+            std::optional<Hit> hits[N];
+            world.intersect(packet, hits);
+            for (int i = 0; i < ray_count; i++)
+                expect_same_hit(hits[i], world.intersect(rays[i]));
+        }
+    }
+}
+
+/**
+ * RayPacket 構造体のテスト
+ */
+// レイの追加とアクティブなレーンのマスク
+TEST(RayPacketTest, Add)
+{
+    RayPacket<8> packet;
+    EXPECT_EQ(packet.size, 0);
+    EXPECT_EQ(packet.get_active_mask(), 0);
+
+    Ray ray(Vec3(1, 2, 3), Vec3(1, 1, 0));
+    packet.add(ray);
+    packet.add(ray);
+    packet.add(ray);
+    EXPECT_EQ(packet.size, 3);
+    EXPECT_FALSE(packet.is_full());
+    EXPECT_EQ(packet.get_active_mask(), 0b111);
+    EXPECT_EQ(packet.get_ray(2).get_origin(), ray.get_origin());
+    EXPECT_EQ(packet.get_ray(2).get_direction(), ray.get_direction());
+    EXPECT_EQ(packet.get_closest_index(0), -1);
+
+    packet.clear();
+    EXPECT_EQ(packet.size, 0);
+}
+
+// ノードとの交差判定が AABB::intersect と一致し，非アクティブなレーンは交差しないことを確認
+TEST(RayPacketTest, IntersectBounds)
+{
+    Pcg32 random(3);
+    const AABB box(Vec3(-5, -5, -5), Vec3(5, 5, 5));
+    for (int trial = 0; trial < 100; trial++)
+    {
+        RayPacket<16> packet;
+        std::vector<Ray> rays;
+        for (int i = 0; i < 11; i++)
+        {
+            rays.push_back(make_coherent_ray(random));
+            packet.add(rays.back());
+        }
+        const int mask = packet.intersect(box);
+        for (int i = 0; i < 16; i++)
+        {
+            bool expected = false;
+            if (i < 11)
+            {
+                const Vec3 d = rays[i].get_direction();
+                Real t_entry;
+                expected = box.intersect(rays[i].get_origin(), Vec3(1.0 / d.x, 1.0 / d.y, 1.0 / d.z), .0, Hit::MAX_DISTANCE, t_entry);
+            }
+            EXPECT_EQ(((mask >> i) & 1) == 1, expected);
+            EXPECT_EQ(packet.node_hit[i], expected ? 1.0 : .0);
+        }
+    }
+}
+
+// 軸に平行なレイ（方向の逆数が無限大）でも判定できることを確認
+TEST(RayPacketTest, AxisAlignedRays)
+{
+    BVH bvh({std::make_shared<Sphere>(Vec3(0, 0, -5), 1.0), std::make_shared<Sphere>(Vec3(3, 0, -5), 1.0)});
+    RayPacket<4> packet;
+    packet.add(Ray(Vec3(0), Vec3(0, 0, -1)));
+    packet.add(Ray(Vec3(3, 0, 0), Vec3(0, 0, -1)));
+    packet.add(Ray(Vec3(0), Vec3(0, 1, 0)));
+    std::optional<Hit> hits[4];
+    bvh.intersect(packet, hits);
+    ASSERT_TRUE(hits[0].has_value());
+    EXPECT_DOUBLE_EQ(hits[0]->get_distance(), 4.0);
+    ASSERT_TRUE(hits[1].has_value());
+    EXPECT_DOUBLE_EQ(hits[1]->get_hit_position().x, 3.0);
+    EXPECT_FALSE(hits[2].has_value());
+}
+
+// 手前の球をかすめるレイについて，カーネルのみが交差と判定した場合でも奥の球との衝突を返すことを確認（単精度でのビルド向け）
+TEST(RayPacketTest, GrazingRayFallsThroughToFartherSphere)
+{
+    std::shared_ptr<Sphere> front = std::make_shared<Sphere>(Vec3(0), 1.0);
+    std::shared_ptr<Sphere> back = std::make_shared<Sphere>(Vec3(0, 0, 5), 2.0);
+    BVH bvh({front, back});
+
+    for (int i = 0; i < 200; i += 4)
+    {
+        RayPacket<4> packet;
+        std::vector<Ray> rays;
+        for (int j = 0; j < 4; j++)
+        {
+            rays.push_back(Ray(Vec3(Real(1 + 4e-5 + (i + j) * 1e-7), 0, -5), Vec3(0, 0, 1)));
+            packet.add(rays.back());
+        }
+        std::optional<Hit> hits[4];
+        bvh.intersect(packet, hits);
+        for (int j = 0; j < 4; j++)
+        {
+            std::optional<Hit> expected = front->intersect(rays[j]);
+            if (!expected)
+                expected = back->intersect(rays[j]);
+            expect_same_hit(bvh.intersect(rays[j]), expected);
+            expect_same_hit(hits[j], expected);
+        }
+    }
+}
+
+// パケット単位で BVH を辿った結果が，1 本ずつ辿った結果と一致することを確認
+TEST(RayPacketTest, MatchesSingleRayWithBVH)
+{
+    check_packet_intersection<4>(true, 4);
+    check_packet_intersection<8>(true, 8);
+    check_packet_intersection<16>(true, 16);
+    check_packet_intersection<16>(true, 5);
+}
+
+// BVH を構築していない場合も同じ結果となることを確認
+TEST(RayPacketTest, MatchesSingleRayWithoutBVH)
+{
+    check_packet_intersection<4>(false, 4);
+    check_packet_intersection<8>(false, 3);
+}
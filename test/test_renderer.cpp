@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "../header/camera.h"
+#include "../header/image.h"
+#include "../header/renderer.h"
+
+/**
+ * Renderer クラスのテスト
+ */
+// コンストラクタの動作確認
+TEST(RendererTest, Constructor)
+{
+    Renderer renderer(4, 32);
+    EXPECT_EQ(renderer.get_num_threads(), 4);
+    EXPECT_EQ(renderer.get_tile_size(), 32);
+
+    // スレッド数を省略した場合はハードウェアの並列数（最低 1）を用いる
+    Renderer default_renderer;
+    EXPECT_GE(default_renderer.get_num_threads(), 1);
+    EXPECT_EQ(default_renderer.get_tile_size(), Renderer::DEFAULT_TILE_SIZE);
+}
+
+// 無効なタイルサイズで例外スローを確認
+TEST(RendererTest, InvalidTileSizeThrowsException)
+{
+    EXPECT_THROW(Renderer invalid_renderer(1, 0), Renderer::tile_size_exception);
+    EXPECT_THROW(Renderer invalid_renderer(1, -16), Renderer::tile_size_exception);
+}
+
+// タイル分割が画像全体を重複なく覆うことを確認
+TEST(RendererTest, SplitIntoTilesCoversImage)
+{
+    const int width = 37;
+    const int height = 21;
+    Renderer renderer(1, 8);
+    std::vector<Tile> tiles = renderer.split_into_tiles(width, height);
+    EXPECT_EQ(tiles.size(), 5 * 3);
+
+    std::vector<int> coverage(width * height, 0);
+    for (const Tile &tile : tiles)
+    {
+        EXPECT_LE(tile.x_end - tile.x_begin, 8);
+        EXPECT_LE(tile.y_end - tile.y_begin, 8);
+        for (int y = tile.y_begin; y < tile.y_end; y++)
+            for (int x = tile.x_begin; x < tile.x_end; x++)
+                coverage[y * width + x]++;
+    }
+    for (int count : coverage)
+        EXPECT_EQ(count, 1);
+}
+
+// 全ピクセルに pixel_color(x, y) の結果が書き込まれることを確認
+TEST(RendererTest, RenderWritesEveryPixel)
+{
+    const int width = 50;
+    const int height = 30;
+    for (int num_threads : {1, 3, 8})
+    {
+        Image image(width, height);
+        Renderer renderer(num_threads, 7);
+        renderer.render(image, [](const int x, const int y)
+                        { return Color(x, y, x * y); });
+
+        for (int y = 0; y < height; y++)
+            for (int x = 0; x < width; x++)
+                EXPECT_EQ(image.get_pixel(x, y), Color(x, y, x * y));
+    }
+}
+
+// カメラの画像にサンプルの平均が書き込まれることを確認
+TEST(RendererTest, RenderWithCamera)
+{
+    PinholeCamera camera(16, 12);
+    Renderer renderer(2, 4);
+    renderer.render(camera, 4, [](const Ray &, SampleStream &)
+                    { return Color(0.25); });
+
+    for (int y = 0; y < 12; y++)
+        for (int x = 0; x < 16; x++)
+            EXPECT_DOUBLE_EQ(camera.get_image().get_pixel(x, y).g, 0.25);
+}
+
+// スレッド数やタイルサイズによらず同じ画像が得られることを確認
+TEST(RendererTest, RenderIsReproducible)
+{
+    auto render = [](const int num_threads, const int tile_size, const int frame)
+    {
+        PinholeCamera camera(24, 16);
+        Renderer renderer(num_threads, tile_size);
+        renderer.set_frame(frame);
+        renderer.render(camera, 3, [](const Ray &r, SampleStream &random)
+                        { return Color(r.get_direction().x, r.get_direction().y, random.next_double()); });
+        std::vector<Color> pixels;
+        for (int y = 0; y < 16; y++)
+            for (int x = 0; x < 24; x++)
+                pixels.push_back(camera.get_image().get_pixel(x, y));
+        return pixels;
+    };
+
+    std::vector<Color> reference = render(1, 16, 0);
+    EXPECT_EQ(render(4, 5, 0), reference);
+    EXPECT_EQ(render(2, 3, 0), reference);
+    // フレーム番号が異なれば異なる乱数列を用いる
+    EXPECT_NE(render(1, 16, 1), reference);
+}
+
+// ワーカーごとの稼働統計が記録されることを確認
+TEST(RendererTest, WorkerStats)
+{
+    Image image(64, 64);
+    Renderer renderer(3, 8);
+    renderer.render(image, [](const int, const int)
+                    { return Color(0); });
+
+    const std::vector<WorkerStats> &stats = renderer.get_worker_stats();
+    ASSERT_EQ(stats.size(), 3);
+    int executed_tasks = 0;
+    for (const WorkerStats &s : stats)
+        executed_tasks += s.executed_tasks;
+    EXPECT_EQ(executed_tasks, 8 * 8);
+}
+
+// タイル単位の描画で，全てのタイルが有効なワーカー番号とともに 1 度ずつ処理されることを確認
+TEST(RendererTest, RenderTiles)
+{
+    Image image(37, 21);
+    Renderer renderer(3, 8);
+    std::vector<std::vector<int>> tile_counts(3, std::vector<int>(37 * 21, 0));
+    renderer.render_tiles(FrameBufferView(image), [&](const Tile &tile, const int worker_id)
+                          {
+                              ASSERT_GE(worker_id, 0);
+                              ASSERT_LT(worker_id, 3);
+                              for (int y = tile.y_begin; y < tile.y_end; y++)
+                                  for (int x = tile.x_begin; x < tile.x_end; x++)
+                                      tile_counts[worker_id][y * 37 + x]++;
+                          });
+    for (int i = 0; i < 37 * 21; i++)
+        EXPECT_EQ(tile_counts[0][i] + tile_counts[1][i] + tile_counts[2][i], 1);
+}
+
+// 全ピクセルが最大サンプル数に達する場合は，固定サンプル数で描画した場合と同じ画像となることを確認
+TEST(RendererTest, AdaptiveRenderMatchesFixedSamples)
+{
+    auto ray_color = [](const Ray &r, SampleStream &random)
+    { return Color(r.get_direction().x, random.next_double(), 0.5); };
+
+    PinholeCamera fixed_camera(24, 16);
+    Renderer renderer(2, 5);
+    renderer.render(fixed_camera, 6, ray_color);
+
+    // threshold = 0 の場合は常に最大サンプル数まで追跡する
+    PinholeCamera adaptive_camera(24, 16);
+    AccumulationBuffer accumulation(24, 16);
+    renderer.render(adaptive_camera, AdaptiveSampler(2, 6, 0.0), accumulation, ray_color);
+
+    for (int y = 0; y < 16; y++)
+        for (int x = 0; x < 24; x++)
+        {
+            EXPECT_EQ(adaptive_camera.get_image().get_pixel(x, y), fixed_camera.get_image().get_pixel(x, y));
+            EXPECT_EQ(accumulation.get_pixel(x, y).count, 6);
+        }
+}
+
+// 分散の小さいピクセルは最小サンプル数で，大きいピクセルはより多くのサンプルで描画されることを確認
+TEST(RendererTest, AdaptiveRenderConcentratesSamples)
+{
+    const int width = 16, height = 8;
+    PinholeCamera camera(width, height);
+    AccumulationBuffer accumulation(width, height);
+    Renderer renderer(3, 4);
+    const AdaptiveSampler sampler(8, 256, 0.05);
+    // 左半分は一定の色，右半分は乱数による色
+    renderer.render(camera, sampler, accumulation, [&](const Ray &r, SampleStream &random)
+                    { return r.get_direction().x < 0 ? Color(0.5) : Color(random.next_double()); });
+
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+        {
+            const PixelStatistics &pixel = accumulation.get_pixel(x, y);
+            if (x < width / 2)
+            {
+                EXPECT_EQ(pixel.count, 8);
+                EXPECT_DOUBLE_EQ(camera.get_image().get_pixel(x, y).r, 0.5);
+            }
+            else
+            {
+                EXPECT_GT(pixel.count, 8);
+                EXPECT_LE(pixel.count, 256);
+                EXPECT_EQ(camera.get_image().get_pixel(x, y), pixel.get_mean());
+            }
+        }
+
+    // 既に収束したピクセルには，再度描画してもサンプルを追加しない
+    const long long total_samples = accumulation.get_total_samples();
+    renderer.render(camera, sampler, accumulation, [&](const Ray &r, SampleStream &random)
+                    { return r.get_direction().x < 0 ? Color(0.5) : Color(random.next_double()); });
+    EXPECT_EQ(accumulation.get_total_samples(), total_samples);
+}
+
+// カメラの画像と大きさの異なるバッファで例外スローを確認
+TEST(RendererTest, AdaptiveRenderSizeMismatchThrowsException)
+{
+    PinholeCamera camera(8, 8);
+    AccumulationBuffer accumulation(8, 4);
+    Renderer renderer(1);
+    EXPECT_THROW(renderer.render(camera, AdaptiveSampler(1, 4, 0.1), accumulation, [](const Ray &, SampleStream &)
+                                 { return Color(0); }),
+                 AccumulationBuffer::size_mismatch_exception);
+}
@@ -0,0 +1,262 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "../header/camera.h"
+#include "../header/renderer.h"
+#include "../header/sampler.h"
+
+namespace
+{
+    // [0, 1) を num_bins 等分した各区間に，num_bins 個の値がちょうど 1 つずつ入るか
+    bool is_stratified(const std::vector<double> &values, const int num_bins)
+    {
+        std::vector<int> count(num_bins, 0);
+        for (double v : values)
+        {
+            if (v < 0.0 || v >= 1.0)
+                return false;
+            count[static_cast<int>(v * num_bins)]++;
+        }
+        return std::all_of(count.begin(), count.end(), [](int c)
+                           { return c == 1; });
+    }
+
+    // 2 次元の被積分関数 f(u, v) = u * v（積分値 1/4）を num_samples 個の標本で求めたときの二乗平均誤差（ピクセルごとに独立な試行とする）
+    double integration_rmse(const Sampler *sampler, const int num_samples)
+    {
+        const int num_trials = 256;
+        double squared_error = 0;
+        for (int trial = 0; trial < num_trials; trial++)
+        {
+            double sum = 0;
+            for (int s = 0; s < num_samples; s++)
+            {
+                SampleStream random = make_sample_stream(trial, 0, s, 0, sampler);
+                const double u = random.next_double();
+                const double v = random.next_double();
+                sum += u * v;
+            }
+            const double error = sum / num_samples - 0.25;
+            squared_error += error * error;
+        }
+        return std::sqrt(squared_error / num_trials);
+    }
+}
+
+/**
+ * SampleStream クラスのテスト
+ */
+// スレッドごとの SampleStream が異なる乱数列を生成することを確認
+TEST(SampleStreamTest, ThreadLocalStreamsDiffer)
+{
+    std::vector<std::vector<double>> sequences(2);
+    std::vector<std::thread> threads;
+    for (auto &sequence : sequences)
+    {
+        threads.emplace_back([&sequence]()
+                             {
+                                 for (int i = 0; i < 8; i++)
+                                     sequence.push_back(thread_local_sample_stream().next_double()); });
+    }
+    for (std::thread &t : threads)
+        t.join();
+    EXPECT_NE(sequences[0], sequences[1]);
+}
+
+// 標本列を指定しない場合は make_sample_random と同じ乱数列となる
+TEST(SampleStreamTest, MatchesSampleRandom)
+{
+    SampleStream stream = make_sample_stream(3, 5, 7, 2);
+    Pcg32 random = make_sample_random(3, 5, 7, 2);
+    for (int i = 0; i < 100; i++)
+        EXPECT_EQ(stream.next_double(), random.next_double());
+    EXPECT_EQ(stream.get_dimension(), 100);
+}
+
+// 標本列が与える次元までは標本列の値を，それ以降は独立な乱数を用いる
+TEST(SampleStreamTest, UsesSamplerDimensions)
+{
+    HaltonSampler sampler(1);
+    SampleStream stream = make_sample_stream(3, 5, 7, 0, &sampler);
+    Pcg32 random = make_sample_random(3, 5, 7, 0);
+    for (int d = 0; d < sampler.get_dimensions(); d++)
+        EXPECT_EQ(stream.next_double(), sampler.get(3, 5, 7, d));
+    for (int i = 0; i < 10; i++)
+        EXPECT_EQ(stream.next_double(), random.next_double());
+}
+
+/**
+ * SobolSampler クラスのテスト
+ */
+// 2 のべき乗個のサンプルで，各次元が 1 次元に層化されることを確認
+TEST(SobolSamplerTest, StratifiedInEachDimension)
+{
+    SobolSampler sampler(7);
+    for (int dimension : {0, 1, 2, 3, 4, 5, 17, 100})
+    {
+        for (int pixel : {0, 1, 12})
+        {
+            std::vector<double> values;
+            for (int s = 0; s < 16; s++)
+                values.push_back(sampler.get(pixel, 2 * pixel, s, dimension));
+            EXPECT_TRUE(is_stratified(values, 16)) << "dimension " << dimension << ", pixel " << pixel;
+        }
+    }
+}
+
+// 連続する 2 次元の組が (0, 4, 2)-ネットとなり，全ての基本区間に 1 点ずつ入ることを確認
+TEST(SobolSamplerTest, PairsAreNets)
+{
+    SobolSampler sampler(3);
+    for (int dimension : {0, 2, 4, 6})
+    {
+        for (int log_x = 0; log_x <= 4; log_x++)
+        {
+            const int nx = 1 << log_x;
+            const int ny = 16 / nx;
+            std::vector<int> count(16, 0);
+            for (int s = 0; s < 16; s++)
+            {
+                const double u = sampler.get(4, 9, s, dimension);
+                const double v = sampler.get(4, 9, s, dimension + 1);
+                count[static_cast<int>(v * ny) * nx + static_cast<int>(u * nx)]++;
+            }
+            for (int c : count)
+                EXPECT_EQ(c, 1) << "dimension " << dimension << ", " << nx << "x" << ny;
+        }
+    }
+}
+
+// Owen スクランブルは上位ビットの区間構造を保つ置換であることを確認
+TEST(SobolSamplerTest, NestedUniformScrambleIsPermutation)
+{
+    std::vector<char> seen(256, 0);
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        const uint32_t scrambled = SobolSampler::nested_uniform_scramble(i << 24, 0x1234u);
+        seen[scrambled >> 24] = 1;
+    }
+    EXPECT_TRUE(std::all_of(seen.begin(), seen.end(), [](char c)
+                            { return c != 0; }));
+}
+
+/**
+ * HaltonSampler クラスのテスト
+ */
+// 基数のべき乗個のサンプルで 1 次元に層化されることを確認
+TEST(HaltonSamplerTest, StratifiedInEachDimension)
+{
+    HaltonSampler sampler(5);
+    const struct
+    {
+        int dimension;
+        int num_samples;
+    } cases[] = {{0, 16}, {1, 9}, {2, 25}, {3, 49}};
+    for (const auto &c : cases)
+    {
+        std::vector<double> values;
+        for (int s = 0; s < c.num_samples; s++)
+            values.push_back(sampler.get(6, 1, s, c.dimension));
+        EXPECT_TRUE(is_stratified(values, c.num_samples)) << "dimension " << c.dimension;
+    }
+}
+
+// ピクセルごとにスクランブルが異なることを確認
+TEST(HaltonSamplerTest, DecorrelatesPixels)
+{
+    HaltonSampler sampler;
+    int num_equal = 0;
+    for (int x = 1; x < 64; x++)
+        num_equal += sampler.get(0, 0, 0, 0) == sampler.get(x, 0, 0, 0);
+    EXPECT_LT(num_equal, 4);
+}
+
+/**
+ * BlueNoiseSampler クラスのテスト
+ */
+// タイルは 0 ~ TILE_SIZE^2 - 1 の順位の並べ替えであることを確認
+TEST(BlueNoiseSamplerTest, TileIsPermutation)
+{
+    const std::vector<uint16_t> &tile = BlueNoiseSampler::get_tile();
+    const int n = BlueNoiseSampler::TILE_SIZE * BlueNoiseSampler::TILE_SIZE;
+    ASSERT_EQ(static_cast<int>(tile.size()), n);
+    std::vector<char> seen(n, 0);
+    for (uint16_t r : tile)
+    {
+        ASSERT_LT(r, n);
+        seen[r] = 1;
+    }
+    EXPECT_TRUE(std::all_of(seen.begin(), seen.end(), [](char c)
+                            { return c != 0; }));
+}
+
+// 隣り合うピクセルの値の差がホワイトノイズ（平均 1/3）より大きい，高周波のノイズであることを確認
+TEST(BlueNoiseSamplerTest, NeighboursDiffer)
+{
+    const int size = BlueNoiseSampler::TILE_SIZE;
+    double sum = 0;
+    for (int y = 0; y < size; y++)
+        for (int x = 0; x < size; x++)
+            sum += std::abs(BlueNoiseSampler::get_tile_value(x, y) - BlueNoiseSampler::get_tile_value(x + 1, y));
+    EXPECT_GT(sum / (size * size), 0.36);
+}
+
+/**
+ * 標本列による積分誤差の比較
+ */
+// 低食い違い量列は独立な乱数より少ないサンプル数で同じ誤差に達することを確認
+TEST(SamplerTest, LowDiscrepancyReducesIntegrationError)
+{
+    const int num_samples = 256;
+    IndependentSampler independent;
+    SobolSampler sobol;
+    HaltonSampler halton;
+    BlueNoiseSampler blue_noise;
+    const double independent_error = integration_rmse(&independent, num_samples);
+    EXPECT_NEAR(independent_error, integration_rmse(nullptr, num_samples), 1e-15);
+    // 独立な乱数の誤差は O(N^-1/2)，低食い違い量列は O(N^-1) 程度で減少する
+    for (const Sampler *sampler : {static_cast<const Sampler *>(&sobol), static_cast<const Sampler *>(&halton), static_cast<const Sampler *>(&blue_noise)})
+        EXPECT_LT(integration_rmse(sampler, num_samples), independent_error / 4);
+    // Sobol 列は 1/16 のサンプル数で独立な乱数より小さい誤差となる
+    EXPECT_LT(integration_rmse(&sobol, num_samples / 16), independent_error);
+}
+
+// Renderer に標本列を設定した場合も，スレッド数によらず同じ画像が得られることを確認
+TEST(SamplerTest, RendererIsReproducible)
+{
+    const int width = 24;
+    const int height = 16;
+    auto ray_color = [](const Ray &r, SampleStream &random)
+    {
+        return Color(0.5 * (r.get_direction().x + 1.0), random.next_double(), random.next_double());
+    };
+
+    std::vector<Image> images;
+    for (int num_threads : {1, 4})
+    {
+        PinholeCamera camera(width, height);
+        Renderer renderer(num_threads, 5);
+        renderer.set_sampler(std::make_shared<SobolSampler>(9));
+        EXPECT_NE(renderer.get_sampler(), nullptr);
+        renderer.render(camera, 4, ray_color);
+        images.push_back(camera.get_image());
+    }
+    // 標本列を指定しない場合とは異なる画像となる
+    PinholeCamera camera(width, height);
+    Renderer renderer(2, 5);
+    renderer.render(camera, 4, ray_color);
+
+    int num_different = 0;
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            EXPECT_EQ(images[0].get_pixel(x, y), images[1].get_pixel(x, y));
+            num_different += !(images[0].get_pixel(x, y) == camera.get_image().get_pixel(x, y));
+        }
+    }
+    EXPECT_GT(num_different, 0);
+}
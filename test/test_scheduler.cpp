@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "../header/scheduler.h"
+
+/**
+ * WorkStealingScheduler クラスのテスト
+ */
+// コンストラクタの動作確認
+TEST(WorkStealingSchedulerTest, Constructor)
+{
+    WorkStealingScheduler scheduler(4);
+    EXPECT_EQ(scheduler.get_num_workers(), 4);
+
+    // ワーカー数は最低 1
+    WorkStealingScheduler single_scheduler(0);
+    EXPECT_EQ(single_scheduler.get_num_workers(), 1);
+}
+
+// 全タスクがちょうど 1 回ずつ実行されることを確認
+TEST(WorkStealingSchedulerTest, RunExecutesEveryTaskOnce)
+{
+    const int task_count = 1000;
+    for (int num_workers : {1, 2, 5})
+    {
+        std::vector<std::atomic<int>> counts(task_count);
+        WorkStealingScheduler scheduler(num_workers);
+        scheduler.run(task_count, [&](const int task, const int worker_id)
+                      {
+                          EXPECT_GE(worker_id, 0);
+                          EXPECT_LT(worker_id, num_workers);
+                          counts[task]++; });
+
+        for (const std::atomic<int> &count : counts)
+            EXPECT_EQ(count.load(), 1);
+
+        int executed_tasks = 0;
+        for (const WorkerStats &stats : scheduler.get_worker_stats())
+            executed_tasks += stats.executed_tasks;
+        EXPECT_EQ(executed_tasks, task_count);
+    }
+}
+
+// タスク数が 0 の場合も正常に終了することを確認
+TEST(WorkStealingSchedulerTest, RunWithoutTasks)
+{
+    WorkStealingScheduler scheduler(3);
+    scheduler.run(0, [](const int, const int)
+                  { FAIL() << "No task should be executed."; });
+    EXPECT_EQ(scheduler.get_worker_stats().size(), 3);
+}
+
+// 重いタスクが 1 つのワーカーに偏っている場合，他のワーカーが盗んで実行することを確認
+TEST(WorkStealingSchedulerTest, UnevenTasksAreStolen)
+{
+    const int num_workers = 4;
+    const int task_count = 16;
+    WorkStealingScheduler scheduler(num_workers);
+    // 初期状態でワーカー 0 に割り当てられるタスク 0 ~ 3 だけが重い
+    scheduler.run(task_count, [](const int task, const int)
+                  {
+                      if (task < task_count / num_workers)
+                          std::this_thread::sleep_for(std::chrono::milliseconds(20)); });
+
+    int stolen_tasks = 0;
+    for (const WorkerStats &stats : scheduler.get_worker_stats())
+    {
+        stolen_tasks += stats.stolen_tasks;
+        EXPECT_GE(stats.busy_seconds, 0.0);
+        EXPECT_GE(stats.idle_seconds, 0.0);
+    }
+    EXPECT_GT(stolen_tasks, 0);
+    EXPECT_LT(scheduler.get_worker_stats()[0].executed_tasks, task_count / num_workers);
+}
+
+// タスクが例外を送出した場合，残りのタスクを破棄して run から例外を送出し直すことを確認
+TEST(WorkStealingSchedulerTest, RethrowsTaskException)
+{
+    for (int num_workers : {1, 4})
+    {
+        WorkStealingScheduler scheduler(num_workers);
+        std::atomic<int> executed(0);
+        EXPECT_THROW(scheduler.run(1000, [&](const int task, const int)
+                                   {
+                                       executed++;
+                                       if (task == 10)
+                                           throw std::runtime_error("task failed"); }),
+                     std::runtime_error);
+
+        // 失敗の後も同じスケジューラで実行できる
+        executed = 0;
+        scheduler.run(100, [&](const int, const int)
+                      { executed++; });
+        EXPECT_EQ(executed.load(), 100);
+    }
+}
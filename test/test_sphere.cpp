@@ -87,6 +87,39 @@ TEST(SphereTest, RayTangentToSphere)
     EXPECT_EQ(hit.get_hit_normal(), Vec3(-1, 0, 0));
 }
 
+// マテリアルを持たない球は共有された黒の Lambertian を返すことを確認
+TEST(SphereTest, DefaultMaterialIsShared)
+{
+    Sphere sphere1(Vec3(0), 1.0);
+    Sphere sphere2(Vec3(1), 2.0);
+    Material *material = sphere1.get_material();
+    ASSERT_NE(material, nullptr);
+    EXPECT_EQ(material->get_brdf(), Color(0));
+    EXPECT_EQ(sphere1.get_material(), material);
+    EXPECT_EQ(sphere2.get_material(), material);
+}
+
+// 単精度の球でも，大きな球（地面）との交差距離が倍精度の場合と一致することを確認
+TEST(SphereTest, SinglePrecisionLargeSphere)
+{
+    SphereT<double> ground_double(Vec3T<double>(0, -1000, 0), 1000);
+    SphereT<float> ground_float(Vec3T<float>(0, -1000, 0), 1000);
+    RayT<double> ray_double(Vec3T<double>(13, 2, 3), Vec3T<double>(-13, -2.5, -3));
+    RayT<float> ray_float(Vec3T<float>(13, 2, 3), Vec3T<float>(-13, -2.5, -3));
+
+    std::optional<HitT<double>> hit_double = ground_double.intersect(ray_double);
+    std::optional<HitT<float>> hit_float = ground_float.intersect(ray_float);
+    ASSERT_TRUE(hit_double.has_value());
+    ASSERT_TRUE(hit_float.has_value());
+    EXPECT_NEAR(hit_float->get_distance(), hit_double->get_distance(), 1e-4);
+    EXPECT_NEAR(hit_float->get_hit_position().y, hit_double->get_hit_position().y, 1e-4);
+    EXPECT_EQ(hit_float->get_sphere(), &ground_float);
+
+    // 衝突点から法線方向に出たレイは，同じ球と再び交差しない
+    RayT<float> reflected(hit_float->get_hit_position(), hit_float->get_hit_normal() + Vec3T<float>(0.3f, 0, 0));
+    EXPECT_FALSE(ground_float.intersect(reflected).has_value());
+}
+
 /**
  * MaterializedSphere クラスのテスト
  */
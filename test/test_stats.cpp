@@ -0,0 +1,199 @@
+// このテストでは計測と区間の通知を有効にしてビルドする
+#define RAYTRACING_STATS
+#define RAYTRACING_STATS_PHASES
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include "../header/aggregate.h"
+#include "../header/camera.h"
+#include "../header/integrator.h"
+#include "../header/material.h"
+#include "../header/renderer.h"
+#include "../header/scenes.h"
+#include "../header/sphere.h"
+#include "../header/stats.h"
+#include "../header/wavefront.h"
+
+namespace
+{
+    // 終了した経路の数と，度数分布・打ち切りの数の整合性
+    void expect_consistent(const RenderStats &stats)
+    {
+        long long histogram_sum = 0;
+        for (long long count : stats.bounce_histogram)
+            histogram_sum += count;
+        EXPECT_EQ(histogram_sum, stats.paths);
+        // 衝突しなかったレイの数だけ経路が空に抜けて終了する
+        EXPECT_EQ(stats.paths, (stats.rays - stats.hits) + stats.russian_roulette_terminations + stats.depth_limit_terminations);
+        // 衝突したレイごとに 1 回ずつ次のレイをサンプリングする
+        EXPECT_EQ(stats.sample_ray_timer.calls, stats.hits);
+    }
+}
+
+/**
+ * RenderStats のテスト
+ */
+// PathIntegrator で描画した場合の計測値と，trace が返すレイの本数が一致することを確認
+TEST(StatsTest, CountsPathIntegrator)
+{
+    const Aggregate world = make_three_spheres_world();
+    const PathIntegrator integrator(10, 2);
+    PinholeCamera camera(16, 12);
+    StatsRegistry::get().collect(true);
+
+    long long expected_rays = 0;
+    for (int y = 0; y < 12; y++)
+    {
+        for (int x = 0; x < 16; x++)
+        {
+            SampleStream random = make_sample_stream(x, y, 0);
+            int num_rays;
+            integrator.trace(camera.get_ray(x, y, random), world, random, num_rays);
+            expected_rays += num_rays;
+        }
+    }
+
+    const RenderStats stats = StatsRegistry::get().collect(true);
+    EXPECT_EQ(stats.rays, expected_rays);
+    EXPECT_EQ(stats.paths, 16 * 12);
+    EXPECT_EQ(stats.intersect_timer.calls, expected_rays);
+    EXPECT_GT(stats.sphere_tests, 0);
+    EXPECT_GT(stats.russian_roulette_terminations, 0);
+    EXPECT_GT(stats.get_mean_bounces(), 0.0);
+    expect_consistent(stats);
+}
+
+// 複数スレッドの計測値がまとめられ，WavefrontIntegrator と PathIntegrator で同じ経路の統計が得られることを確認
+TEST(StatsTest, MergesThreadsAndMatchesWavefront)
+{
+    const Aggregate world = make_three_spheres_world();
+    const int width = 24, height = 16, samples_per_pixel = 4;
+    std::ostringstream report;
+    std::streambuf *original = std::clog.rdbuf(report.rdbuf());
+
+    PinholeCamera camera(width, height);
+    Renderer renderer(4, 8);
+    const PathIntegrator integrator;
+    StatsRegistry::get().collect(true);
+    renderer.render(camera, samples_per_pixel, [&](const Ray &r, SampleStream &random)
+                    { return integrator.trace(r, world, random); });
+    // render の終了時に出力して 0 に戻す
+    EXPECT_NE(report.str().find("[stats] render 24x16"), std::string::npos);
+    EXPECT_TRUE(StatsRegistry::get().collect(false).is_empty());
+
+    // 出力される前の値を得るため，スレッドごとに描画してから集める
+    std::clog.rdbuf(original);
+    auto render_and_collect = [&](auto &&render)
+    {
+        std::thread worker([&]
+                           { render(); });
+        worker.join();
+        return StatsRegistry::get().collect(true);
+    };
+    const RenderStats depth_first = render_and_collect([&]
+                                                       {
+        for (int y = 0; y < height; y++)
+            for (int x = 0; x < width; x++)
+                for (int s = 0; s < samples_per_pixel; s++)
+                {
+                    SampleStream random = make_sample_stream(x, y, s);
+                    integrator.trace(camera.get_ray(x, y, random), world, random);
+                } });
+    const RenderStats wavefront = render_and_collect([&]
+                                                     {
+        WavefrontIntegrator::Workspace workspace;
+        WavefrontIntegrator().render_tile(renderer, camera, world, Tile{0, 0, width, height}, samples_per_pixel, camera.get_framebuffer(), workspace); });
+
+    EXPECT_EQ(depth_first.paths, width * height * samples_per_pixel);
+    EXPECT_EQ(wavefront.paths, depth_first.paths);
+    EXPECT_EQ(wavefront.rays, depth_first.rays);
+    EXPECT_EQ(wavefront.hits, depth_first.hits);
+    EXPECT_EQ(wavefront.russian_roulette_terminations, depth_first.russian_roulette_terminations);
+    EXPECT_EQ(wavefront.depth_limit_terminations, depth_first.depth_limit_terminations);
+    for (int i = 0; i < RenderStats::BOUNCE_BINS; i++)
+        EXPECT_EQ(wavefront.bounce_histogram[i], depth_first.bounce_histogram[i]);
+    expect_consistent(depth_first);
+    expect_consistent(wavefront);
+}
+
+// 総当たりの場合は，レイ 1 本あたり全ての球と交差判定を行う
+TEST(StatsTest, CountsSphereTestsWithoutBVH)
+{
+    Aggregate world;
+    world.add(std::make_shared<Sphere>(Vec3(0, 0, -1), 0.5));
+    world.add(std::make_shared<Sphere>(Vec3(0, -100.5, -1), 100));
+    world.add(std::make_shared<Sphere>(Vec3(3, 0, -1), 0.5));
+    StatsRegistry::get().collect(true);
+    EXPECT_TRUE(world.intersect(Ray(Vec3(0), Vec3(0, 0, -1))));
+    EXPECT_FALSE(world.intersect(Ray(Vec3(0), Vec3(0, 1, 0))));
+
+    const RenderStats stats = StatsRegistry::get().collect(true);
+    EXPECT_EQ(stats.rays, 2);
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.sphere_tests, 6);
+}
+
+// 区間の開始・終了が交差判定ごと・シェーディングごとに対になって通知され，入れ子にならないことを確認
+TEST(StatsTest, NotifiesIntersectAndShadePhases)
+{
+    static std::atomic<long long> begins[NUM_STATS_PHASES];
+    static std::atomic<long long> ends[NUM_STATS_PHASES];
+    static std::atomic<long long> nested;
+    thread_local static int open_phases = 0;
+    for (int phase = 0; phase < NUM_STATS_PHASES; phase++)
+        begins[phase] = ends[phase] = 0;
+    nested = 0;
+
+    const Aggregate world = make_three_spheres_world();
+    const PathIntegrator integrator(10, 2);
+    PinholeCamera camera(16, 12);
+    get_stats_phase_listener() = StatsPhaseListener{
+        [](const StatsPhase phase)
+        {
+            nested += open_phases++ > 0 ? 1 : 0;
+            begins[static_cast<int>(phase)]++;
+        },
+        [](const StatsPhase phase)
+        {
+            open_phases--;
+            ends[static_cast<int>(phase)]++;
+        }};
+    long long expected_rays = 0;
+    for (int y = 0; y < 12; y++)
+    {
+        for (int x = 0; x < 16; x++)
+        {
+            SampleStream random = make_sample_stream(x, y, 0);
+            int num_rays;
+            integrator.trace(camera.get_ray(x, y, random), world, random, num_rays);
+            expected_rays += num_rays;
+        }
+    }
+    get_stats_phase_listener() = StatsPhaseListener();
+
+    // 衝突しなかったレイも背景の色を求めるシェーディングの区間に入る
+    EXPECT_EQ(begins[static_cast<int>(StatsPhase::Intersect)], expected_rays);
+    EXPECT_EQ(begins[static_cast<int>(StatsPhase::Shade)], expected_rays);
+    for (int phase = 0; phase < NUM_STATS_PHASES; phase++)
+        EXPECT_EQ(begins[phase], ends[phase]);
+    EXPECT_EQ(nested, 0);
+
+    // 登録を解除した後は通知されない
+    SampleStream random = make_sample_stream(0, 0, 0);
+    integrator.trace(camera.get_ray(0, 0, random), world, random);
+    EXPECT_EQ(begins[static_cast<int>(StatsPhase::Intersect)], expected_rays);
+}
+
+// 画像の保存時間が計測されることを確認
+TEST(StatsTest, TimesSavePng)
+{
+    Image image(8, 8);
+    StatsRegistry::get().collect(true);
+    image.save_png("stats_test.png");
+    std::remove("stats_test.png");
+    const RenderStats stats = StatsRegistry::get().collect(true);
+    EXPECT_EQ(stats.save_png_timer.calls, 1);
+    EXPECT_GT(stats.save_png_timer.nanoseconds, 0);
+}
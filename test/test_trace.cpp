@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "../header/aggregate.h"
+#include "../header/image.h"
+#include "../header/renderer.h"
+#include "../header/trace.h"
+
+namespace
+{
+    int count_occurrences(const std::string &text, const std::string &pattern)
+    {
+        int count = 0;
+        for (size_t p = text.find(pattern); p != std::string::npos; p = text.find(pattern, p + 1))
+            count++;
+        return count;
+    }
+}
+
+/**
+ * TraceRecorder クラスのテスト
+ */
+// 記録が無効の場合は区間を記録しないことを確認
+TEST(TraceTest, DisabledByDefault)
+{
+    TraceRecorder &recorder = TraceRecorder::get();
+    ASSERT_FALSE(recorder.is_enabled());
+    {
+        TraceScope trace("unused", "test");
+        trace.add_arg("value", 1);
+        EXPECT_FALSE(trace.is_recording());
+    }
+    EXPECT_TRUE(recorder.get_events().empty());
+}
+
+// タイルごとの区間がワーカーの行に記録され，描画全体の区間に含まれることを確認
+TEST(TraceTest, RecordsTilesPerWorker)
+{
+    TraceRecorder &recorder = TraceRecorder::get();
+    recorder.clear();
+    recorder.enable("trace_test.json");
+
+    Image image(40, 24);
+    Renderer renderer(3, 8);
+    renderer.render(image, [](const int x, const int y)
+                    { return Color(x, y, 0); });
+    recorder.disable();
+
+    const std::vector<TraceEvent> events = recorder.get_events();
+    int num_tiles = 0;
+    const TraceEvent *render = nullptr;
+    for (const TraceEvent &e : events)
+    {
+        if (e.name == "render")
+            render = &e;
+    }
+    ASSERT_NE(render, nullptr);
+    EXPECT_EQ(render->lane, TraceRecorder::MAIN_LANE);
+    EXPECT_NE(render->args.find("\"tiles\": 15"), std::string::npos);
+    for (const TraceEvent &e : events)
+    {
+        if (e.name != "tile")
+            continue;
+        num_tiles++;
+        EXPECT_GE(e.lane, 1);
+        EXPECT_LE(e.lane, 3);
+        EXPECT_GE(e.begin_us, render->begin_us);
+        EXPECT_LE(e.begin_us + e.duration_us, render->begin_us + render->duration_us + 1e-3);
+    }
+    EXPECT_EQ(num_tiles, 5 * 3);
+    recorder.clear();
+}
+
+// 書き出したファイルに区間と行の名前が含まれ，文字列がエスケープされることを確認
+TEST(TraceTest, SavesTraceEventJson)
+{
+    TraceRecorder &recorder = TraceRecorder::get();
+    recorder.clear();
+    recorder.enable("trace_test.json");
+    {
+        Aggregate world;
+        world.add(std::make_shared<Sphere>(Vec3(0), 1.0));
+        world.build();
+        TraceScope trace("scope \"quoted\"", "test", 2);
+        trace.add_arg("path", std::string("dir\\file"));
+    }
+    recorder.disable();
+    ASSERT_TRUE(recorder.save());
+
+    std::ifstream file("trace_test.json");
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string json = buffer.str();
+    std::remove("trace_test.json");
+    recorder.clear();
+
+    EXPECT_EQ(json.rfind("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [", 0), 0u);
+    EXPECT_EQ(count_occurrences(json, "\"ph\": \"X\""), 2);
+    EXPECT_NE(json.find("\"name\": \"build_bvh\", \"cat\": \"scene\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\": \"scope \\\"quoted\\\"\""), std::string::npos);
+    EXPECT_NE(json.find("\"path\": \"dir\\\\file\""), std::string::npos);
+    EXPECT_NE(json.find("\"args\": {\"name\": \"worker 1\"}"), std::string::npos);
+    EXPECT_NE(json.find("\"args\": {\"name\": \"main\"}"), std::string::npos);
+    EXPECT_EQ(json.substr(json.size() - 4), "\n]}\n");
+}
+
+// 制御文字が \u00XX の形式でエスケープされることを確認
+TEST(TraceTest, EscapesControlCharacters)
+{
+    EXPECT_EQ(TraceRecorder::escape("a\tb\nc"), "a\\u0009b\\u000ac");
+    EXPECT_EQ(TraceRecorder::escape(std::string("\x00\x1f", 2)), "\\u0000\\u001f");
+    EXPECT_EQ(TraceRecorder::escape("\"\\ ~"), "\\\"\\\\ ~");
+}
@@ -1,4 +1,6 @@
 #include <gtest/gtest.h>
+#include <atomic>
+#include <vector>
 #include "../header/util.h"
 
 // clamp関数のテスト
@@ -41,6 +43,39 @@ TEST(UtilTest, RandomFloatingPoint) {
     }
 }
 
+// 乱数生成器を指定した場合，同じ初期状態からは同じ値が得られることを確認
+TEST(UtilTest, RandomWithGenerator)
+{
+    Pcg32 random1(42);
+    Pcg32 random2(42);
+    for (int i = 0; i < 100; ++i)
+    {
+        double value = generate_random_in_range(random1, -2.0, 3.0);
+        EXPECT_GE(value, -2.0);
+        EXPECT_LT(value, 3.0);
+        EXPECT_EQ(value, generate_random_in_range(random2, -2.0, 3.0));
+    }
+}
+
+// parallel_for が全ての添字をちょうど 1 回ずつ処理することを確認
+TEST(UtilTest, ParallelFor)
+{
+    for (int min_chunk_size : {1, 7, 1000})
+    {
+        std::vector<std::atomic<int>> counts(100);
+        parallel_for(0, 100, min_chunk_size, [&](const int begin, const int end)
+                     {
+                         for (int i = begin; i < end; i++)
+                             counts[i]++; });
+        for (const std::atomic<int> &count : counts)
+            EXPECT_EQ(count.load(), 1);
+    }
+
+    // 空の区間では呼び出されない
+    parallel_for(5, 5, 1, [](const int begin, const int end)
+                 { FAIL() << "Function should not be called for an empty range."; });
+}
+
 // メイン関数（Google Testのエントリーポイント）
 int main(int argc, char **argv)
 {
@@ -1,4 +1,7 @@
 #include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include "../header/simd3.h"
 #include "../header/vec3.h"
 
 // テストケース: 引数なしコンストラクタ
@@ -260,6 +263,15 @@ TEST(Vec3Test, CrossProduct)
     EXPECT_EQ(result.z, 5.0) << "z component of cross product should be 5.0";
 }
 
+// 添字演算子のテスト
+TEST(Vec3Test, SubscriptOperator)
+{
+    Vec3 v(1.0, 2.0, 3.0);
+    EXPECT_DOUBLE_EQ(v[0], 1.0);
+    EXPECT_DOUBLE_EQ(v[1], 2.0);
+    EXPECT_DOUBLE_EQ(v[2], 3.0);
+}
+
 // spherical_to_cartesianメソッドのテスト
 TEST(Vec3Test, SphericalToCartesianTest)
 {
@@ -282,6 +294,67 @@ TEST(Vec3Test, SphericalToCartesianTest)
     EXPECT_NEAR(result.z, 0, 1e-6);
 }
 
+// 精度の異なるベクトルへの変換
+TEST(Vec3Test, PrecisionConversion)
+{
+    Vec3T<double> v(1.0, 0.1, -2.5);
+    Vec3T<float> f(v);
+    EXPECT_FLOAT_EQ(f.x, 1.0f);
+    EXPECT_FLOAT_EQ(f.y, 0.1f);
+    EXPECT_FLOAT_EQ(f.z, -2.5f);
+    EXPECT_EQ(Vec3T<double>(f), Vec3T<double>(1.0, static_cast<double>(0.1f), -2.5));
+    EXPECT_FLOAT_EQ(Vec3T<float>(3, 4, 0).norm(), 5.0f);
+}
+
+// 正規直交基底の構築（make_orthonormal_basis）のテスト
+TEST(Vec3Test, OrthonormalBasis)
+{
+    for (const Vec3 &n : {Vec3(0, 0, 1), Vec3(0, 0, -1), Vec3(1, 0, 0), Vec3(0, -1, 0), Vec3(1, 2, -3).normalize(), Vec3(-0.3, 0.1, 1e-9).normalize()})
+    {
+        Vec3 tangent, bitangent;
+        make_orthonormal_basis(n, tangent, bitangent);
+        EXPECT_NEAR(tangent.norm(), 1.0, 1e-6) << n;
+        EXPECT_NEAR(bitangent.norm(), 1.0, 1e-6) << n;
+        EXPECT_NEAR(dot(tangent, bitangent), 0.0, 1e-6) << n;
+        EXPECT_NEAR(dot(tangent, n), 0.0, 1e-6) << n;
+        EXPECT_NEAR(dot(bitangent, n), 0.0, 1e-6) << n;
+        // 右手系（tangent × bitangent = n）
+        const Vec3 c = cross(tangent, bitangent);
+        EXPECT_NEAR(c.x, n.x, 1e-6) << n;
+        EXPECT_NEAR(c.y, n.y, 1e-6) << n;
+        EXPECT_NEAR(c.z, n.z, 1e-6) << n;
+    }
+}
+
+// SIMD 版の 1 / sqrt の近似が許容誤差に収まることを確認（対応する命令セットがない場合は何もしない）
+// 倍精度は単精度の近似値を補正するため，単精度で表せない範囲の値も確認する
+TEST(Vec3Test, SimdReciprocalSqrt)
+{
+#if defined(__AVX2__)
+    for (const double s : {1e-300, 1e-40, 1e-12, 0.01, 0.5, 1.0, 2.0, 3.0, 14.0, 12345.678, 1e12, 1e38, 1e300})
+    {
+        alignas(32) double r[4];
+        Simd3<double>::store(r, Simd3<double>::reciprocal_sqrt(s));
+        const double expected = 1.0 / std::sqrt(s);
+        for (int i = 0; i < 3; i++)
+            EXPECT_NEAR(r[i], expected, expected * 4 * std::numeric_limits<double>::epsilon()) << s;
+    }
+    alignas(32) const double a[4] = {1.5, -2.25, 3.125, 0};
+    alignas(32) const double b[4] = {-0.5, 4.0, 0.75, 0};
+    EXPECT_NEAR(Simd3<double>::dot(Simd3<double>::load(a), Simd3<double>::load(b)), 1.5 * -0.5 + -2.25 * 4.0 + 3.125 * 0.75, 1e-15);
+#endif
+#if defined(__SSE__)
+    for (const float s : {1e-30f, 0.01f, 0.5f, 1.0f, 2.0f, 3.0f, 14.0f, 12345.678f, 1e30f})
+    {
+        alignas(16) float r[4];
+        Simd3<float>::store(r, Simd3<float>::reciprocal_sqrt(s));
+        const float expected = 1.0f / std::sqrt(s);
+        for (int i = 0; i < 3; i++)
+            EXPECT_NEAR(r[i], expected, expected * 4 * std::numeric_limits<float>::epsilon()) << s;
+    }
+#endif
+}
+
 // メイン関数（Google Testのエントリーポイント）
 int main(int argc, char **argv)
 {
@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "../header/aggregate.h"
+#include "../header/camera.h"
+#include "../header/integrator.h"
+#include "../header/material.h"
+#include "../header/renderer.h"
+#include "../header/scenes.h"
+#include "../header/sphere.h"
+#include "../header/wavefront.h"
+
+namespace
+{
+    // MaterialVariant に含まれないマテリアル（仮想関数で呼び出す経路の確認用）
+    class Diffuser : public Material
+    {
+    public:
+        using Material::sample_ray;
+
+        Ray sample_ray(const Ray &, const Hit &hit, SampleStream &random) const override
+        {
+            return Ray(hit.get_hit_position(), hit.get_hit_normal() + Vec3(random.next_double() - 0.5, random.next_double(), .0));
+        }
+
+        Color get_brdf() const override
+        {
+            return Color(0.3, 0.9, 0.6);
+        }
+    };
+
+    // get_material を上書きして Diffuser を返す球
+    class DiffuserSphere : public Sphere
+    {
+    private:
+        Diffuser material;
+
+    public:
+        using Sphere::Sphere;
+
+        Material *get_material() const override
+        {
+            return const_cast<Diffuser *>(&material);
+        }
+    };
+
+    Aggregate make_world()
+    {
+        // 05-03 の配置に，仮想関数で呼び出すマテリアルの球を加える
+        Aggregate world;
+        add_three_spheres(world);
+        world.add(std::make_shared<MaterializedSphere>(Vec3(0, 0.8, -1.5), 0.3, std::make_shared<Diffuser>()));
+        world.build();
+        return world;
+    }
+
+    std::vector<Color> get_pixels(const Camera &camera)
+    {
+        const Image &image = camera.get_image();
+        return std::vector<Color>(image.get_data(), image.get_data() + image.get_width() * image.get_height());
+    }
+
+    // 深さ優先の PathIntegrator で描画した画像
+    std::vector<Color> render_depth_first(const Aggregate &world, const int samples_per_pixel, const int russian_roulette_depth)
+    {
+        PinholeCamera camera(29, 19);
+        PathIntegrator integrator(10, russian_roulette_depth);
+        Renderer renderer(1);
+        renderer.render(camera, samples_per_pixel, [&](const Ray &r, SampleStream &random)
+                        { return integrator.trace(r, world, random); });
+        return get_pixels(camera);
+    }
+
+    std::vector<Color> render_wavefront(const Aggregate &world, const int samples_per_pixel, const int russian_roulette_depth,
+                                        const int num_threads, const int tile_size, const int max_paths,
+                                        const int packet_size = WavefrontIntegrator::DEFAULT_PACKET_SIZE, const bool sort_rays = false)
+    {
+        PinholeCamera camera(29, 19);
+        WavefrontIntegrator integrator(10, russian_roulette_depth, max_paths, packet_size, sort_rays);
+        Renderer renderer(num_threads, tile_size);
+        integrator.render(renderer, camera, samples_per_pixel, world);
+        return get_pixels(camera);
+    }
+}
+
+/**
+ * WavefrontIntegrator クラスのテスト
+ */
+// コンストラクタの動作確認
+TEST(WavefrontIntegratorTest, Constructor)
+{
+    WavefrontIntegrator integrator;
+    EXPECT_EQ(integrator.get_max_depth(), PathIntegrator::DEFAULT_MAX_DEPTH);
+    EXPECT_EQ(integrator.get_russian_roulette_depth(), PathIntegrator::DEFAULT_RUSSIAN_ROULETTE_DEPTH);
+    EXPECT_EQ(integrator.get_max_paths(), WavefrontIntegrator::DEFAULT_MAX_PATHS);
+    EXPECT_EQ(integrator.get_packet_size(), WavefrontIntegrator::DEFAULT_PACKET_SIZE);
+    EXPECT_FALSE(integrator.get_sort_rays());
+
+    // 経路数の上限は最低 1
+    WavefrontIntegrator small_integrator(5, -1, 0);
+    EXPECT_EQ(small_integrator.get_max_paths(), 1);
+}
+
+// 深さ優先で追跡した場合と完全に同じ画像が得られることを確認
+TEST(WavefrontIntegratorTest, MatchesDepthFirst)
+{
+    Aggregate world = make_world();
+    for (const int russian_roulette_depth : {-1, PathIntegrator::DEFAULT_RUSSIAN_ROULETTE_DEPTH})
+    {
+        std::vector<Color> expected = render_depth_first(world, 6, russian_roulette_depth);
+        EXPECT_EQ(render_wavefront(world, 6, russian_roulette_depth, 1, 16, WavefrontIntegrator::DEFAULT_MAX_PATHS), expected);
+        EXPECT_EQ(render_wavefront(world, 6, russian_roulette_depth, 3, 7, WavefrontIntegrator::DEFAULT_MAX_PATHS), expected);
+    }
+}
+
+// Sphere を派生させて get_material を上書きした場合も，上書きしたマテリアルで描画されることを確認
+TEST(WavefrontIntegratorTest, UsesOverriddenGetMaterial)
+{
+    Aggregate world;
+    add_three_spheres(world);
+    world.add(std::make_shared<DiffuserSphere>(Vec3(0, 0.8, -1.5), 0.3));
+    world.build();
+    Aggregate black_world;
+    add_three_spheres(black_world);
+    black_world.add(std::make_shared<Sphere>(Vec3(0, 0.8, -1.5), 0.3));
+    black_world.build();
+
+    std::vector<Color> expected = render_depth_first(world, 4, PathIntegrator::DEFAULT_RUSSIAN_ROULETTE_DEPTH);
+    EXPECT_EQ(render_wavefront(world, 4, PathIntegrator::DEFAULT_RUSSIAN_ROULETTE_DEPTH, 2, 8, WavefrontIntegrator::DEFAULT_MAX_PATHS), expected);
+    EXPECT_NE(render_depth_first(black_world, 4, PathIntegrator::DEFAULT_RUSSIAN_ROULETTE_DEPTH), expected);
+}
+
+// 経路数の上限によってバッチに分割しても同じ画像が得られることを確認
+TEST(WavefrontIntegratorTest, SplitsIntoBatches)
+{
+    Aggregate world = make_world();
+    std::vector<Color> expected = render_depth_first(world, 7, PathIntegrator::DEFAULT_RUSSIAN_ROULETTE_DEPTH);
+    // 1 バッチあたり 1 サンプル，2 サンプル（端数あり）
+    EXPECT_EQ(render_wavefront(world, 7, PathIntegrator::DEFAULT_RUSSIAN_ROULETTE_DEPTH, 2, 8, 1), expected);
+    EXPECT_EQ(render_wavefront(world, 7, PathIntegrator::DEFAULT_RUSSIAN_ROULETTE_DEPTH, 2, 8, 128), expected);
+}
+
+// パケットの本数によらず同じ画像が得られることを確認
+TEST(WavefrontIntegratorTest, PacketSizes)
+{
+    Aggregate world = make_world();
+    std::vector<Color> expected = render_depth_first(world, 5, PathIntegrator::DEFAULT_RUSSIAN_ROULETTE_DEPTH);
+    for (const int packet_size : {0, 4, 8, 16})
+    {
+        EXPECT_EQ(render_wavefront(world, 5, PathIntegrator::DEFAULT_RUSSIAN_ROULETTE_DEPTH, 2, 8, WavefrontIntegrator::DEFAULT_MAX_PATHS, packet_size), expected);
+    }
+}
+
+// レイを並べ替えても同じ画像が得られることを確認
+TEST(WavefrontIntegratorTest, SortRays)
+{
+    Aggregate world = make_world();
+    std::vector<Color> expected = render_depth_first(world, 5, PathIntegrator::DEFAULT_RUSSIAN_ROULETTE_DEPTH);
+    for (const int packet_size : {0, 4})
+    {
+        EXPECT_EQ(render_wavefront(world, 5, PathIntegrator::DEFAULT_RUSSIAN_ROULETTE_DEPTH, 2, 8, WavefrontIntegrator::DEFAULT_MAX_PATHS, packet_size, true), expected);
+    }
+}
+
+// 追跡したレイの本数が深さ優先で追跡した場合と同じであることを確認
+TEST(WavefrontIntegratorTest, CountsRays)
+{
+    Aggregate world = make_world();
+    PinholeCamera depth_first_camera(29, 19);
+    PathIntegrator path_integrator(10, PathIntegrator::DEFAULT_RUSSIAN_ROULETTE_DEPTH);
+    std::atomic<long long> expected(0);
+    Renderer(2, 8).render(depth_first_camera, 4, [&](const Ray &r, SampleStream &random)
+                          {
+                              int n;
+                              const Color color = path_integrator.trace(r, world, random, n);
+                              expected += n;
+                              return color; });
+
+    PinholeCamera camera(29, 19);
+    Renderer renderer(3, 7);
+    WavefrontIntegrator integrator(10, PathIntegrator::DEFAULT_RUSSIAN_ROULETTE_DEPTH, 64);
+    EXPECT_EQ(integrator.render(renderer, camera, 4, world), expected.load());
+}
+
+// 無効なパケットの本数で例外スローを確認
+TEST(WavefrontIntegratorTest, InvalidPacketSizeThrowsException)
+{
+    EXPECT_THROW(WavefrontIntegrator(10, 3, 1024, 3), WavefrontIntegrator::packet_size_exception);
+    EXPECT_THROW(WavefrontIntegrator(10, 3, 1024, 32), WavefrontIntegrator::packet_size_exception);
+}
+
+// 物体が存在しない場合は空の色となる
+TEST(WavefrontIntegratorTest, EmptyWorld)
+{
+    Aggregate world;
+    PinholeCamera camera(8, 8);
+    WavefrontIntegrator integrator;
+    Renderer renderer(2, 4);
+    integrator.render(renderer, camera, 1, world);
+
+    const Image &image = camera.get_image();
+    for (int y = 0; y < 8; y++)
+    {
+        for (int x = 0; x < 8; x++)
+        {
+            SampleStream random = make_sample_stream(x, y, 0);
+            EXPECT_EQ(image.get_pixel(x, y), PathIntegrator::background(camera.get_ray(x, y, random)));
+        }
+    }
+}